@@ -1,9 +1,12 @@
 import 'dart:async';
 import 'dart:ffi' as ffi;
-import 'package:ffi/ffi.dart' as ffi;
+import 'dart:isolate';
+import 'dart:typed_data';
+import 'dart:ui' show FrameTiming;
 
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
+import 'package:flutter/scheduler.dart';
 import 'package:texture_interface/texture_interface.dart';
 
 // global textureInterface instance
@@ -28,6 +31,28 @@ Future<bool> initTextures() async {
   return success;
 }
 
+// Renders frames as fast as the display takes them on a background isolate
+// until the texture is unregistered.
+Future<void> produceFrames((TextureProducer, int, int) args) async {
+  final (producer, width, height) = args;
+  for (int tick = 0;; tick++) {
+    if (!producer.isReadyForFrame) {
+      await Future<void>.delayed(const Duration(milliseconds: 1));
+      continue;
+    }
+    final buffer = producer.acquireBuffer(width, height);
+    if (buffer.address == 0) return;
+
+    // one RGBA pixel per element, a color per row moving down each frame
+    Uint32List pixels = buffer.cast<ffi.Uint32>().asTypedList(width * height);
+    for (int y = 0; y < height; y++) {
+      int shade = (y + tick) & 0xFF;
+      pixels.fillRange(y * width, (y + 1) * width, 0xFF000000 | (shade << 16) | ((255 - shade) << 8) | tick & 0xFF);
+    }
+    if (producer.submitBuffer(buffer, width, height) != TextureStatus.ok) return;
+  }
+}
+
 void main() {
   runApp(const Main());
 }
@@ -41,7 +66,19 @@ class Main extends StatefulWidget {
 
 class _MainState extends State<Main> {
   bool texturesInitialized = false;
-  Timer? timer;
+  final List<Isolate> producers = [];
+
+  // slowest UI thread frame of the last second, stays flat while the
+  // producers run
+  Duration worstBuild = Duration.zero;
+  Duration _worstBuildSoFar = Duration.zero;
+  Timer? frameTimeReport;
+
+  void _onTimings(List<FrameTiming> timings) {
+    for (FrameTiming timing in timings) {
+      if (timing.buildDuration > _worstBuildSoFar) _worstBuildSoFar = timing.buildDuration;
+    }
+  }
   @override
   void initState() {
     super.initState();
@@ -51,27 +88,29 @@ class _MainState extends State<Main> {
       setState(() {});
       if (!texturesInitialized) return;
 
-      timer = Timer.periodic(const Duration(milliseconds: 50), (timer) {
-        int width = 1000;
-        int height = 500;
-        ffi.Pointer<ffi.Uint8> pFirstBuffer = ffi.malloc.call<ffi.Uint8>(width * height * 4);
-
-        for (int i = 0; i < width * height; i++) {
-          int byte = i * 4;
-          pFirstBuffer.elementAt(byte).value = timer.tick;
-          pFirstBuffer.elementAt(byte + 1).value = timer.tick + 50;
-          pFirstBuffer.elementAt(byte + 2).value = timer.tick + 100;
-          pFirstBuffer.elementAt(byte + 3).value = 255;
-        }
-
-        textureInterface.update(textureIDs["first"]!, pFirstBuffer, width, height);
+      SchedulerBinding.instance.addTimingsCallback(_onTimings);
+      frameTimeReport = Timer.periodic(const Duration(seconds: 1), (_) {
+        setState(() => worstBuild = _worstBuildSoFar);
+        _worstBuildSoFar = Duration.zero;
       });
+
+      // the producers publish straight into the native textures, the UI
+      // isolate only lays them out
+      for ((int, int, int) texture in [(textureIDs["first"]!, 1000, 500), (textureIDs["second"]!, 1920, 1080)]) {
+        final (id, width, height) = texture;
+        TextureProducer producer = textureInterface.producer(id, width: width, height: height)!;
+        producers.add(await Isolate.spawn(produceFrames, (producer, width, height)));
+      }
     });
   }
 
   @override
   void dispose() {
-    timer?.cancel();
+    for (Isolate producer in producers) {
+      producer.kill();
+    }
+    frameTimeReport?.cancel();
+    SchedulerBinding.instance.removeTimingsCallback(_onTimings);
 
     textureInterface.dispose();
 
@@ -85,11 +124,12 @@ class _MainState extends State<Main> {
     ValueListenable<TextureInfo>? textureInfo2 =
         texturesInitialized ? textureInterface.textureInfo(textureIDs["second"]!) : null;
 
-    Widget firstTexture = texturesInitialized ? textureInterface.widget(textureIDs["first"]!) : const Placeholder();
-    Widget secondTexture = texturesInitialized ? textureInterface.widget(textureIDs["second"]!) : const Placeholder();
+    Widget firstTexture = texturesInitialized ? textureInterface.widget(textureIDs["first"]!, downscale: true) : const Placeholder();
+    Widget secondTexture = texturesInitialized ? textureInterface.widget(textureIDs["second"]!, downscale: true) : const Placeholder();
 
     return MaterialApp(
       home: Scaffold(
+        bottomNavigationBar: Text("Slowest UI frame build last second: ${worstBuild.inMicroseconds} us"),
         body: Row(
           mainAxisSize: MainAxisSize.max,
           children: [
@@ -0,0 +1,183 @@
+import 'dart:ffi' as ffi;
+import 'dart:io';
+
+/// Status codes returned by the native entry points, see
+/// `src/include/texture_interface/texture_interface_ffi.h`.
+class TextureStatus {
+  static const int ok = 0;
+  static const int invalidArgument = -1;
+  static const int notFound = -2;
+  static const int foreignBuffer = -3;
+  static const int outOfMemory = -4;
+  static const int unsupported = -5;
+  static const int sharedMemory = -6;
+  static const int noFrame = -7;
+  static const int corrupt = -8;
+}
+
+/// Mirrors `ti_region`.
+class NativeRegion extends ffi.Struct {
+  @ffi.Int32()
+  external int x;
+  @ffi.Int32()
+  external int y;
+  @ffi.Int32()
+  external int width;
+  @ffi.Int32()
+  external int height;
+  external ffi.Pointer<ffi.Uint8> src;
+  @ffi.Int32()
+  external int srcStride;
+}
+
+/// Mirrors `ti_frame_update`.
+class NativeFrameUpdate extends ffi.Struct {
+  @ffi.Int64()
+  external int textureHandle;
+  external ffi.Pointer<ffi.Uint8> buffer;
+  @ffi.Int32()
+  external int width;
+  @ffi.Int32()
+  external int height;
+  @ffi.Int32()
+  external int stride;
+  @ffi.Int32()
+  external int format;
+}
+
+typedef _UpdateFrameNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Int32, ffi.Int32);
+typedef _UpdateFrameDart = int Function(int, ffi.Pointer<ffi.Uint8>, int, int, int);
+
+typedef _UpdateFrameFormatNative = ffi.Int32 Function(
+    ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Int32, ffi.Int32, ffi.Int32);
+typedef _UpdateFrameFormatDart = int Function(int, ffi.Pointer<ffi.Uint8>, int, int, int, int);
+
+typedef _UpdateFrameQueuedNative = ffi.Int32 Function(
+    ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Int32, ffi.Int32, ffi.Int32, ffi.Int64);
+typedef _UpdateFrameQueuedDart = int Function(int, ffi.Pointer<ffi.Uint8>, int, int, int, int, int);
+
+typedef _UpdateFrameEncodedNative = ffi.Int32 Function(
+    ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int64, ffi.Pointer<ffi.Int32>, ffi.Pointer<ffi.Int32>);
+typedef _UpdateFrameEncodedDart = int Function(
+    int, ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Int32>, ffi.Pointer<ffi.Int32>);
+
+typedef _CreateReleaseQueueNative = ffi.Int64 Function();
+typedef _CreateReleaseQueueDart = int Function();
+
+typedef _DestroyReleaseQueueNative = ffi.Void Function(ffi.Int64);
+typedef _DestroyReleaseQueueDart = void Function(int);
+
+typedef _PollReleasedNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Pointer<ffi.Uint8>>, ffi.Int32);
+typedef _PollReleasedDart = int Function(int, ffi.Pointer<ffi.Pointer<ffi.Uint8>>, int);
+
+typedef _UpdateFramesNative = ffi.Int32 Function(ffi.Pointer<NativeFrameUpdate>, ffi.Int32, ffi.Pointer<ffi.Int32>);
+typedef _UpdateFramesDart = int Function(ffi.Pointer<NativeFrameUpdate>, int, ffi.Pointer<ffi.Int32>);
+
+typedef _AcquireBufferNative = ffi.Pointer<ffi.Uint8> Function(ffi.Int64, ffi.Int32, ffi.Int32);
+typedef _AcquireBufferDart = ffi.Pointer<ffi.Uint8> Function(int, int, int);
+
+typedef _SubmitBufferNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Int32);
+typedef _SubmitBufferDart = int Function(int, ffi.Pointer<ffi.Uint8>, int, int);
+
+typedef _MaxFrameDeltaSizeNative = ffi.Int64 Function(ffi.Int32, ffi.Int32);
+typedef _MaxFrameDeltaSizeDart = int Function(int, int);
+
+typedef _EncodeFrameDeltaNative = ffi.Int32 Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>, ffi.Int32,
+    ffi.Int32, ffi.Int32, ffi.Pointer<ffi.Uint8>, ffi.Int64, ffi.Pointer<ffi.Int64>);
+typedef _EncodeFrameDeltaDart = int Function(
+    ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>, int, int, int, ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Int64>);
+
+typedef _UpdateFrameDeltaNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint8>, ffi.Int64);
+typedef _UpdateFrameDeltaDart = int Function(int, ffi.Pointer<ffi.Uint8>, int);
+
+typedef _UpdateRegionsNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<NativeRegion>, ffi.Int32);
+typedef _UpdateRegionsDart = int Function(int, ffi.Pointer<NativeRegion>, int);
+
+typedef _ReleaseBufferNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint8>);
+typedef _ReleaseBufferDart = int Function(int, ffi.Pointer<ffi.Uint8>);
+
+typedef _SetPacingModeNative = ffi.Int32 Function(ffi.Int64, ffi.Int32);
+typedef _SetPacingModeDart = int Function(int, int);
+
+typedef _SetDisplaySizeNative = ffi.Int32 Function(ffi.Int64, ffi.Int32, ffi.Int32);
+typedef _SetDisplaySizeDart = int Function(int, int, int);
+
+typedef _ReadyForFrameNative = ffi.Int32 Function(ffi.Int64);
+typedef _ReadyForFrameDart = int Function(int);
+
+typedef _SetDuplicateCheckNative = ffi.Int32 Function(ffi.Int64, ffi.Int32);
+typedef _SetDuplicateCheckDart = int Function(int, int);
+
+typedef _DroppedFramesNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint64>);
+typedef _DroppedFramesDart = int Function(int, ffi.Pointer<ffi.Uint64>);
+
+typedef _ResidentBytesNative = ffi.Int32 Function(ffi.Int64, ffi.Pointer<ffi.Uint64>);
+typedef _ResidentBytesDart = int Function(int, ffi.Pointer<ffi.Uint64>);
+
+/// Synchronous bindings to the plugin library. They bypass the method channel
+/// and can be used from any isolate.
+class TextureInterfaceBindings {
+  static final TextureInterfaceBindings instance = TextureInterfaceBindings._(_open());
+
+  static ffi.DynamicLibrary _open() {
+    if (Platform.isWindows) return ffi.DynamicLibrary.open('texture_interface_plugin.dll');
+    if (Platform.isLinux) return ffi.DynamicLibrary.open('libtexture_interface_plugin.so');
+    throw UnsupportedError('texture_interface is not supported on ${Platform.operatingSystem}');
+  }
+
+  TextureInterfaceBindings._(ffi.DynamicLibrary library)
+      : updateFrame = library.lookupFunction<_UpdateFrameNative, _UpdateFrameDart>('ti_update_frame'),
+        updateFrameFormat =
+            library.lookupFunction<_UpdateFrameFormatNative, _UpdateFrameFormatDart>('ti_update_frame_format'),
+        updateFrameQueued =
+            library.lookupFunction<_UpdateFrameQueuedNative, _UpdateFrameQueuedDart>('ti_update_frame_queued'),
+        updateFrameEncoded =
+            library.lookupFunction<_UpdateFrameEncodedNative, _UpdateFrameEncodedDart>('ti_update_frame_encoded'),
+        createReleaseQueue =
+            library.lookupFunction<_CreateReleaseQueueNative, _CreateReleaseQueueDart>('ti_create_release_queue'),
+        destroyReleaseQueue =
+            library.lookupFunction<_DestroyReleaseQueueNative, _DestroyReleaseQueueDart>('ti_destroy_release_queue'),
+        pollReleased = library.lookupFunction<_PollReleasedNative, _PollReleasedDart>('ti_poll_released'),
+        updateFrames = library.lookupFunction<_UpdateFramesNative, _UpdateFramesDart>('ti_update_frames'),
+        acquireBuffer = library.lookupFunction<_AcquireBufferNative, _AcquireBufferDart>('ti_acquire_buffer'),
+        submitBuffer = library.lookupFunction<_SubmitBufferNative, _SubmitBufferDart>('ti_submit_buffer'),
+        releaseBuffer = library.lookupFunction<_ReleaseBufferNative, _ReleaseBufferDart>('ti_release_buffer'),
+        updateRegions = library.lookupFunction<_UpdateRegionsNative, _UpdateRegionsDart>('ti_update_regions'),
+        maxFrameDeltaSize =
+            library.lookupFunction<_MaxFrameDeltaSizeNative, _MaxFrameDeltaSizeDart>('ti_max_frame_delta_size'),
+        encodeFrameDelta =
+            library.lookupFunction<_EncodeFrameDeltaNative, _EncodeFrameDeltaDart>('ti_encode_frame_delta'),
+        updateFrameDelta =
+            library.lookupFunction<_UpdateFrameDeltaNative, _UpdateFrameDeltaDart>('ti_update_frame_delta'),
+        setPacingMode = library.lookupFunction<_SetPacingModeNative, _SetPacingModeDart>('ti_set_pacing_mode'),
+        setDisplaySize = library.lookupFunction<_SetDisplaySizeNative, _SetDisplaySizeDart>('ti_set_display_size'),
+        readyForFrame = library.lookupFunction<_ReadyForFrameNative, _ReadyForFrameDart>('ti_ready_for_frame'),
+        setDuplicateCheck =
+            library.lookupFunction<_SetDuplicateCheckNative, _SetDuplicateCheckDart>('ti_set_duplicate_check'),
+        droppedFrames = library.lookupFunction<_DroppedFramesNative, _DroppedFramesDart>('ti_dropped_frames'),
+        skippedFrames = library.lookupFunction<_DroppedFramesNative, _DroppedFramesDart>('ti_skipped_frames'),
+        residentBytes = library.lookupFunction<_ResidentBytesNative, _ResidentBytesDart>('ti_resident_bytes');
+
+  final _UpdateFrameDart updateFrame;
+  final _UpdateFrameFormatDart updateFrameFormat;
+  final _UpdateFrameQueuedDart updateFrameQueued;
+  final _UpdateFrameEncodedDart updateFrameEncoded;
+  final _CreateReleaseQueueDart createReleaseQueue;
+  final _DestroyReleaseQueueDart destroyReleaseQueue;
+  final _PollReleasedDart pollReleased;
+  final _UpdateFramesDart updateFrames;
+  final _AcquireBufferDart acquireBuffer;
+  final _SubmitBufferDart submitBuffer;
+  final _ReleaseBufferDart releaseBuffer;
+  final _UpdateRegionsDart updateRegions;
+  final _MaxFrameDeltaSizeDart maxFrameDeltaSize;
+  final _EncodeFrameDeltaDart encodeFrameDelta;
+  final _UpdateFrameDeltaDart updateFrameDelta;
+  final _SetPacingModeDart setPacingMode;
+  final _SetDisplaySizeDart setDisplaySize;
+  final _ReadyForFrameDart readyForFrame;
+  final _SetDuplicateCheckDart setDuplicateCheck;
+  final _DroppedFramesDart droppedFrames;
+  final _DroppedFramesDart skippedFrames;
+  final _ResidentBytesDart residentBytes;
+}
@@ -1,56 +1,69 @@
 import 'dart:async';
+import 'dart:typed_data';
 
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
+import 'package:flutter/rendering.dart';
 import 'package:flutter/services.dart';
 import 'package:ffi/ffi.dart' as ffi;
 import 'dart:ffi' as ffi;
 
+import 'src/texture_interface_bindings.dart';
+
+export 'src/texture_interface_bindings.dart' show TextureStatus;
+
 class TextureInterface {
   static const MethodChannel _channel = MethodChannel('texture_interface');
+  static final TextureInterfaceBindings _bindings = TextureInterfaceBindings.instance;
   final Map<int, ValueNotifier<TextureInfo>> _ids = {};
+  // above every id registered so far
+  int _nextId = 0;
 
-  Set<int> get ids => _ids.keys.toSet();
+  // reused native array for updateRegions
+  ffi.Pointer<NativeRegion> _regions = ffi.nullptr;
+  int _regionCapacity = 0;
 
-  int getUniqueId() {
-    if (_ids.isEmpty) return 0;
-    return _ids.keys.reduce((a, b) => a > b ? a : b) + 1;
-  }
+  // reused native arrays for updateFrames
+  ffi.Pointer<NativeFrameUpdate> _frameUpdates = ffi.nullptr;
+  ffi.Pointer<ffi.Int32> _frameStatuses = ffi.nullptr;
+  int _frameUpdateCapacity = 0;
 
-  /*
-  Texture_interface() {
-    WidgetsFlutterBinding.ensureInitialized();
+  // reused native memory for updateEncoded and updateDelta, the image size
+  // is written back into _encodedSize
+  ffi.Pointer<ffi.Uint8> _encoded = ffi.nullptr;
+  int _encodedCapacity = 0;
+  ffi.Pointer<ffi.Int32> _encodedSize = ffi.nullptr;
 
-    _channel.setMethodCallHandler((call) async {
-      // if method is FreeBuffer
-      if (call.method.compareTo("FreeBuffer") == 0) {
-        // if the arguments is a single int
+  // buffers lent with updateBorrowed by address, with their release
+  // callback, polled for while any are outstanding
+  static const int _releasedCapacity = 64;
+  static const Duration _releasePollInterval = Duration(milliseconds: 8);
+  int _releaseQueue = 0;
+  final Map<int, void Function(ffi.Pointer<ffi.Uint8> buffer)?> _borrowed = {};
+  final StreamController<ffi.Pointer<ffi.Uint8>> _released = StreamController.broadcast();
+  ffi.Pointer<ffi.Pointer<ffi.Uint8>> _releasedBuffers = ffi.nullptr;
+  Timer? _releasePoll;
+  // unregistered textures are torn down natively once the raster thread let
+  // go of them, which is when their lent buffers come back
+  static const Duration _retireTimeout = Duration(seconds: 1);
 
-        if (call.arguments is int) {
-          int ptra = call.arguments;
-          ffi.Pointer<ffi.Uint8> buffer = ffi.Pointer.fromAddress(ptra);
-          if (buffer != ffi.nullptr) {
-            ffi.calloc.free(buffer);
-            // frees 10/20GB but there should also just be 10GB to free
-          }
-        }
-      }
-      return true;
-    });
+  Set<int> get ids => _ids.keys.toSet();
 
-  }*/
+  int getUniqueId() => _nextId;
 
   Future<bool> register(int id) async {
     if (_ids.containsKey(id)) {
       return false;
     }
 
-    int texId = await _registerTexture(id);
+    if (id >= _nextId) _nextId = id + 1;
+    Map<Object?, Object?> texture = await _registerTexture(id);
     _ids.addAll(
       {
         id: ValueNotifier<TextureInfo>(
           TextureInfo(
-            handle: texId,
+            handle: texture["textureId"] as int,
+            nativeHandle: texture["handle"] as int,
             width: 0,
             height: 0,
           ),
@@ -64,16 +77,46 @@ class TextureInterface {
     if (!_ids.containsKey(id)) {
       return false;
     }
-    await _unregisterTexture(id);
+    int retiring = await _unregisterTexture(id);
     _ids.remove(id);
+    if (_borrowed.isNotEmpty) unawaited(_collectRetired(retiring));
     return true;
   }
 
+  /// Unregisters all textures of this instance in one call, without waiting
+  /// for the raster thread.
   Future<void> dispose() async {
-    for (int id in _ids.keys) {
-      await _unregisterTexture(id);
-    }
+    int retiring = await _channel.invokeMethod<int>(
+          "UnregisterAll",
+          {
+            "ids": _ids.keys.toList(),
+          },
+        ) ??
+        0;
     _ids.clear();
+    if (_releaseQueue != 0) {
+      await _collectRetired(retiring);
+      _pollReleased();
+      _bindings.destroyReleaseQueue(_releaseQueue);
+      _releaseQueue = 0;
+    }
+    _releasePoll?.cancel();
+    _releasePoll = null;
+    if (_releasedBuffers != ffi.nullptr) ffi.calloc.free(_releasedBuffers);
+    _releasedBuffers = ffi.nullptr;
+    if (_regions != ffi.nullptr) ffi.calloc.free(_regions);
+    _regions = ffi.nullptr;
+    _regionCapacity = 0;
+    if (_frameUpdates != ffi.nullptr) ffi.calloc.free(_frameUpdates);
+    if (_frameStatuses != ffi.nullptr) ffi.calloc.free(_frameStatuses);
+    _frameUpdates = ffi.nullptr;
+    _frameStatuses = ffi.nullptr;
+    _frameUpdateCapacity = 0;
+    if (_encoded != ffi.nullptr) ffi.calloc.free(_encoded);
+    if (_encodedSize != ffi.nullptr) ffi.calloc.free(_encodedSize);
+    _encoded = ffi.nullptr;
+    _encodedSize = ffi.nullptr;
+    _encodedCapacity = 0;
   }
 
   static Future<String?> get platformVersion async {
@@ -86,54 +129,547 @@ class TextureInterface {
     return null;
   }
 
-  Future<int> _registerTexture(int id) async {
-    int texId = await _channel.invokeMethod(
+  Future<Map<Object?, Object?>> _registerTexture(int id) async {
+    Map<Object?, Object?> texture = await _channel.invokeMethod(
       "RegisterTexture",
       {
         "id": id,
       },
     );
-    return texId;
+    return texture;
   }
 
-  Future<void> update(int id, ffi.Pointer<ffi.Uint8> buffer, int width, int height) async {
+  /// Displays [buffer] and takes ownership of it. Rows may be padded to
+  /// [stride] bytes, 0 meaning tightly packed; padded buffers are compacted
+  /// natively so there is no need to repack them in Dart. Buffers in another
+  /// [format] are converted to RGBA natively.
+  Future<void> update(
+    int id,
+    ffi.Pointer<ffi.Uint8> buffer,
+    int width,
+    int height, {
+    int stride = 0,
+    TexturePixelFormat format = TexturePixelFormat.rgba,
+  }) async {
     if (!_ids.containsKey(id)) {
       ffi.calloc.free(buffer);
       return;
     }
     _ids[id]!.value = _ids[id]!.value.copyWith(width: width, height: height);
 
-    await _channel.invokeMethod('UpdateFrame', {
-      "id": id,
-      "width": width,
-      "height": height,
-      "buffer": buffer.address,
-    });
-    /*ffi.Pointer<ffi.Uint8> prev = _ids[id]!.value._previousBuffer;
-    Future.delayed(const Duration(milliseconds: 20), () {
-      if (prev != ffi.nullptr) ffi.malloc.free(prev);
-    });
-    _ids[id]!.value = _ids[id]!.value.copyWith(previousBuffer: buffer);*/
+    int status = _bindings.updateFrameFormat(_ids[id]!.value.nativeHandle!, buffer, width, height, stride, format.index);
+    // the buffer is only adopted on success
+    if (status != TextureStatus.ok) ffi.calloc.free(buffer);
+  }
+
+  /// Decodes a QOI or baseline JPEG image natively, straight into a pooled
+  /// buffer, and displays it. [bytes] are copied into reused native memory
+  /// first, [updateEncodedNative] takes data that already is native. Returns
+  /// a [TextureStatus], [TextureStatus.unsupported] for other formats.
+  int updateEncoded(int id, Uint8List bytes) {
+    return updateEncodedNative(id, _copyEncoded(bytes), bytes.length);
+  }
+
+  ffi.Pointer<ffi.Uint8> _copyEncoded(Uint8List bytes) {
+    if (bytes.length > _encodedCapacity) {
+      if (_encoded != ffi.nullptr) ffi.calloc.free(_encoded);
+      _encoded = ffi.calloc<ffi.Uint8>(bytes.length);
+      _encodedCapacity = bytes.length;
+    }
+    _encoded.asTypedList(bytes.length).setAll(0, bytes);
+    return _encoded;
+  }
+
+  /// Like [updateEncoded] for [size] bytes at [data], which stay owned by the
+  /// caller.
+  int updateEncodedNative(int id, ffi.Pointer<ffi.Uint8> data, int size) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    if (_encodedSize == ffi.nullptr) _encodedSize = ffi.calloc<ffi.Int32>(2);
+    int status = _bindings.updateFrameEncoded(_ids[id]!.value.nativeHandle!, data, size, _encodedSize, _encodedSize + 1);
+    if (status == TextureStatus.ok) {
+      _ids[id]!.value = _ids[id]!.value.copyWith(width: _encodedSize[0], height: _encodedSize[1]);
+    }
+    return status;
+  }
+
+  /// Applies a delta encoded with [TextureDeltaEncoder] to the last frame, so
+  /// only the pixels that changed are read and written. Deltas apply to
+  /// whatever the texture shows, the producer has to encode them against the
+  /// frame it submitted last. [bytes] are copied into reused native memory
+  /// first, [updateDeltaNative] takes a delta that already is native. Returns
+  /// a [TextureStatus], [TextureStatus.noFrame] without a last frame of the
+  /// size the delta was encoded for.
+  int updateDelta(int id, Uint8List bytes) {
+    return updateDeltaNative(id, _copyEncoded(bytes), bytes.length);
+  }
+
+  /// Like [updateDelta] for [size] bytes at [data], which stay owned by the
+  /// caller.
+  int updateDeltaNative(int id, ffi.Pointer<ffi.Uint8> data, int size) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    return _bindings.updateFrameDelta(_ids[id]!.value.nativeHandle!, data, size);
+  }
+
+  /// Displays [buffer] without taking ownership of it, so that memory from a
+  /// decoder or another allocator is shown without a copy. Once the plugin no
+  /// longer needs it, usually a frame or two later, the buffer is passed to
+  /// [onRelease] and added to [releasedBuffers]; until then it has to stay
+  /// valid and must not be submitted again. Returns a [TextureStatus], the
+  /// buffer is not used if it is an error.
+  int updateBorrowed(
+    int id,
+    ffi.Pointer<ffi.Uint8> buffer,
+    int width,
+    int height, {
+    int stride = 0,
+    TexturePixelFormat format = TexturePixelFormat.rgba,
+    void Function(ffi.Pointer<ffi.Uint8> buffer)? onRelease,
+  }) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    if (_releaseQueue == 0) _releaseQueue = _bindings.createReleaseQueue();
+    _borrowed[buffer.address] = onRelease;
+    int status = _bindings.updateFrameQueued(
+        _ids[id]!.value.nativeHandle!, buffer, width, height, stride, format.index, _releaseQueue);
+    if (status != TextureStatus.ok) {
+      _borrowed.remove(buffer.address);
+      return status;
+    }
+    _ids[id]!.value = _ids[id]!.value.copyWith(width: width, height: height);
+    _releasePoll ??= Timer.periodic(_releasePollInterval, (_) => _pollReleased());
+    return status;
+  }
+
+  /// Buffers lent with [updateBorrowed] that the plugin no longer needs.
+  Stream<ffi.Pointer<ffi.Uint8>> get releasedBuffers => _released.stream;
+
+  void _pollReleased() {
+    if (_releasedBuffers == ffi.nullptr) _releasedBuffers = ffi.calloc<ffi.Pointer<ffi.Uint8>>(_releasedCapacity);
+    int count;
+    do {
+      count = _bindings.pollReleased(_releaseQueue, _releasedBuffers, _releasedCapacity);
+      for (int i = 0; i < count; i++) {
+        ffi.Pointer<ffi.Uint8> buffer = _releasedBuffers[i];
+        _borrowed.remove(buffer.address)?.call(buffer);
+        _released.add(buffer);
+      }
+    } while (count == _releasedCapacity);
+    if (_borrowed.isEmpty) {
+      _releasePoll?.cancel();
+      _releasePoll = null;
+    }
+  }
+
+  /// Publishes a frame for each of [updates] in a single native call, every
+  /// texture is notified once. Like [update] the buffers are owned by the
+  /// plugin afterwards and freed if they could not be displayed. Returns a
+  /// [TextureStatus] per entry.
+  List<int> updateFrames(List<TextureUpdate> updates) {
+    if (updates.length > _frameUpdateCapacity) {
+      if (_frameUpdates != ffi.nullptr) ffi.calloc.free(_frameUpdates);
+      if (_frameStatuses != ffi.nullptr) ffi.calloc.free(_frameStatuses);
+      _frameUpdateCapacity = updates.length;
+      _frameUpdates = ffi.calloc<NativeFrameUpdate>(_frameUpdateCapacity);
+      _frameStatuses = ffi.calloc<ffi.Int32>(_frameUpdateCapacity);
+    }
+    for (int i = 0; i < updates.length; i++) {
+      TextureUpdate update = updates[i];
+      NativeFrameUpdate native = _frameUpdates[i];
+      // unknown ids get a handle the registry never hands out
+      native.textureHandle = _ids[update.id]?.value.nativeHandle ?? 0;
+      native.buffer = update.buffer;
+      native.width = update.width;
+      native.height = update.height;
+      native.stride = update.stride;
+      native.format = update.format.index;
+    }
+    _bindings.updateFrames(_frameUpdates, updates.length, _frameStatuses);
+
+    List<int> statuses = List<int>.filled(updates.length, TextureStatus.ok);
+    for (int i = 0; i < updates.length; i++) {
+      TextureUpdate update = updates[i];
+      statuses[i] = _frameStatuses[i];
+      if (statuses[i] == TextureStatus.ok) {
+        _ids[update.id]!.value = _ids[update.id]!.value.copyWith(width: update.width, height: update.height);
+      } else {
+        ffi.calloc.free(update.buffer);
+      }
+    }
+    return statuses;
+  }
+
+  /// A [TextureProducer] for [id] that can be sent to another isolate, null
+  /// for unknown ids. Frames it publishes do not pass through this instance,
+  /// so [width] and [height] set the size [widget] lays the texture out at.
+  TextureProducer? producer(int id, {int? width, int? height}) {
+    if (!_ids.containsKey(id)) return null;
+    _ids[id]!.value = _ids[id]!.value.copyWith(width: width, height: height);
+    return TextureProducer(_ids[id]!.value.nativeHandle!);
+  }
+
+  /// Selects how frames that arrive faster than the display refreshes are
+  /// handled, see [TexturePacing].
+  void setPacing(int id, TexturePacing pacing) {
+    if (!_ids.containsKey(id)) return;
+    _bindings.setPacingMode(_ids[id]!.value.nativeHandle!, pacing.index);
+  }
+
+  /// Tells the plugin that [id] is displayed at [width] x [height] physical
+  /// pixels, 0 x 0 if unknown. Larger frames are then downscaled natively to
+  /// the smallest size that still covers it. [widget] does this by itself
+  /// with `downscale: true`.
+  void setDisplaySize(int id, int width, int height) {
+    if (!_ids.containsKey(id)) return;
+    _bindings.setDisplaySize(_ids[id]!.value.nativeHandle!, width, height);
+  }
+
+  /// Lets [id] recognize frames that are resent unchanged and skip
+  /// publishing them, which saves the texture upload and compositing. Frames
+  /// are hashed natively, [TextureDuplicateCheck.sampled] reads only part of
+  /// each frame. Skipped frames are counted in [skippedFrames].
+  void setDuplicateCheck(int id, TextureDuplicateCheck check) {
+    if (!_ids.containsKey(id)) return;
+    _bindings.setDuplicateCheck(_ids[id]!.value.nativeHandle!, check.index);
+  }
+
+  /// Backpressure signal: false while the last frame of [id] has not been
+  /// picked up by the engine yet. Producers that check it before rendering
+  /// never produce frames that are dropped.
+  bool isReadyForFrame(int id) {
+    if (!_ids.containsKey(id)) return false;
+    return _bindings.readyForFrame(_ids[id]!.value.nativeHandle!) == 1;
+  }
+
+  /// Number of frames of [id] that were replaced before they were shown.
+  int droppedFrames(int id) {
+    if (!_ids.containsKey(id)) return 0;
+    ffi.Pointer<ffi.Uint64> dropped = ffi.calloc<ffi.Uint64>();
+    _bindings.droppedFrames(_ids[id]!.value.nativeHandle!, dropped);
+    int count = dropped.value;
+    ffi.calloc.free(dropped);
+    return count;
+  }
+
+  /// Number of frames of [id] that were skipped as duplicates.
+  int skippedFrames(int id) {
+    if (!_ids.containsKey(id)) return 0;
+    ffi.Pointer<ffi.Uint64> skipped = ffi.calloc<ffi.Uint64>();
+    _bindings.skippedFrames(_ids[id]!.value.nativeHandle!, skipped);
+    int count = skipped.value;
+    ffi.calloc.free(skipped);
+    return count;
+  }
+
+  /// Bytes of pixel memory the texture [id] holds right now, its pooled
+  /// buffers and the frames it took ownership of.
+  int residentBytes(int id) {
+    if (!_ids.containsKey(id)) return 0;
+    ffi.Pointer<ffi.Uint64> bytes = ffi.calloc<ffi.Uint64>();
+    _bindings.residentBytes(_ids[id]!.value.nativeHandle!, bytes);
+    int count = bytes.value;
+    ffi.calloc.free(bytes);
+    return count;
+  }
+
+  /// Latency and throughput of [id] since the last call with [reset] set, or
+  /// since it was registered. Returns null for unknown ids.
+  Future<TextureStats?> getStats(int id, {bool reset = false}) async {
+    if (!_ids.containsKey(id)) return null;
+    Map<Object?, Object?> stats = await _channel.invokeMethod(
+      "GetStats",
+      {
+        "id": id,
+        "reset": reset,
+      },
+    );
+    return TextureStats.fromMap(stats);
+  }
+
+  /// Copies the changed rectangle at [x], [y] of the last frame from [src],
+  /// whose rows are [srcStride] bytes apart. [src] stays owned by the caller.
+  /// Returns a [TextureStatus], [TextureStatus.noFrame] if no full frame was
+  /// submitted yet.
+  int updateRegion(int id, int x, int y, int width, int height, ffi.Pointer<ffi.Uint8> src, int srcStride) {
+    return updateRegions(id, [TextureRegion(x: x, y: y, width: width, height: height, src: src, srcStride: srcStride)]);
+  }
+
+  /// Like [updateRegion] for several rectangles that are published together.
+  int updateRegions(int id, List<TextureRegion> regions) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    if (regions.length > _regionCapacity) {
+      if (_regions != ffi.nullptr) ffi.calloc.free(_regions);
+      _regionCapacity = regions.length;
+      _regions = ffi.calloc<NativeRegion>(_regionCapacity);
+    }
+    for (int i = 0; i < regions.length; i++) {
+      NativeRegion native = _regions[i];
+      native.x = regions[i].x;
+      native.y = regions[i].y;
+      native.width = regions[i].width;
+      native.height = regions[i].height;
+      native.src = regions[i].src;
+      native.srcStride = regions[i].srcStride;
+    }
+    return _bindings.updateRegions(_ids[id]!.value.nativeHandle!, _regions, regions.length);
+  }
+
+  /// Returns a recycled buffer owned by the texture [id] that is large enough
+  /// for a [width] x [height] RGBA frame. Fill it and hand it back with
+  /// [submitBuffer], or return it unused with [releaseBuffer].
+  ffi.Pointer<ffi.Uint8> acquireBuffer(int id, int width, int height) {
+    if (!_ids.containsKey(id)) return ffi.nullptr;
+    return _bindings.acquireBuffer(_ids[id]!.value.nativeHandle!, width, height);
+  }
+
+  /// Displays a buffer obtained from [acquireBuffer]. The buffer goes back to
+  /// the pool once it has been replaced, do not touch it after submitting.
+  /// Returns a [TextureStatus]: [TextureStatus.foreignBuffer] if the buffer is
+  /// not currently acquired, [TextureStatus.invalidArgument] if the frame is
+  /// larger than the buffer was acquired for.
+  int submitBuffer(int id, ffi.Pointer<ffi.Uint8> buffer, int width, int height) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    int status = _bindings.submitBuffer(_ids[id]!.value.nativeHandle!, buffer, width, height);
+    if (status == TextureStatus.ok) {
+      _ids[id]!.value = _ids[id]!.value.copyWith(width: width, height: height);
+    }
+    return status;
+  }
+
+  /// Returns an unused buffer obtained from [acquireBuffer] to the pool.
+  /// Submitted buffers are rejected with [TextureStatus.foreignBuffer].
+  int releaseBuffer(int id, ffi.Pointer<ffi.Uint8> buffer) {
+    if (!_ids.containsKey(id)) return TextureStatus.notFound;
+    return _bindings.releaseBuffer(_ids[id]!.value.nativeHandle!, buffer);
+  }
+
+  /// Displays the frames another process publishes into the shared frame
+  /// ring [name] (see `shared_frame_ring.h`) on the texture [id], without
+  /// copying them through Dart. Returns false if the ring could not be opened.
+  Future<bool> bindSharedRing(int id, String name) async {
+    if (!_ids.containsKey(id)) return false;
+    try {
+      Map<Object?, Object?> size = await _channel.invokeMethod(
+        "BindSharedRing",
+        {
+          "id": id,
+          "name": name,
+        },
+      );
+      _ids[id]!.value = _ids[id]!.value.copyWith(width: size["width"] as int, height: size["height"] as int);
+      return true;
+    } on PlatformException {
+      return false;
+    }
   }
 
-  Future<void> _unregisterTexture(int id) async {
+  /// Goes back to displaying the frames submitted through [update].
+  Future<void> unbindSharedRing(int id) async {
+    if (!_ids.containsKey(id)) return;
     await _channel.invokeMethod(
-      "UnregisterTexture",
+      "UnbindSharedRing",
       {
         "id": id,
       },
     );
   }
 
-  Widget widget(int id) {
+  /// Feeds [id] with natively rendered [pattern] frames of [width] x [height]
+  /// at [fps], 0 meaning whenever the last one was shown, until
+  /// [stopTestPattern]. [color] is used by [TexturePattern.solid]. Meant for
+  /// load tests, where generating the pixels in Dart would measure Dart;
+  /// [getStats] then reports the plugin's own latency and throughput. Returns
+  /// false for unknown ids or an invalid configuration.
+  Future<bool> startTestPattern(
+    int id,
+    TexturePattern pattern, {
+    required int width,
+    required int height,
+    double fps = 60,
+    int color = 0xFF000000,
+  }) async {
+    if (!_ids.containsKey(id)) return false;
+    try {
+      await _channel.invokeMethod(
+        "StartTestPattern",
+        {
+          "id": id,
+          "pattern": pattern.index,
+          "width": width,
+          "height": height,
+          "fps": fps.toDouble(),
+          "color": color,
+        },
+      );
+      _ids[id]!.value = _ids[id]!.value.copyWith(width: width, height: height);
+      return true;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Stops the frames started with [startTestPattern], the last one stays.
+  Future<void> stopTestPattern(int id) async {
+    if (!_ids.containsKey(id)) return;
+    await _channel.invokeMethod(
+      "StopTestPattern",
+      {
+        "id": id,
+      },
+    );
+  }
+
+  /// Records every frame submitted to [id] from now on, with its timestamp
+  /// and size, into a capture file at [path] to reproduce glitches later.
+  /// Rows that did not change since the previous frame take no space. Returns
+  /// false if the file could not be created.
+  Future<bool> startRecording(int id, String path) async {
+    if (!_ids.containsKey(id)) return false;
+    try {
+      await _channel.invokeMethod(
+        "StartRecording",
+        {
+          "id": id,
+          "path": path,
+        },
+      );
+      return true;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Finishes the capture file of [id] and returns the number of frames in it.
+  Future<int> stopRecording(int id) async {
+    if (!_ids.containsKey(id)) return 0;
+    return await _channel.invokeMethod(
+      "StopRecording",
+      {
+        "id": id,
+      },
+    ) as int;
+  }
+
+  /// Feeds the frames recorded at [path] back into [id] natively, [speed]
+  /// times as fast as they were submitted or as fast as possible with 0, and
+  /// from the start again with [loop]. Returns false if the file could not
+  /// be read.
+  Future<bool> startReplay(int id, String path, {double speed = 1, bool loop = false}) async {
+    if (!_ids.containsKey(id)) return false;
+    try {
+      Map<Object?, Object?> size = await _channel.invokeMethod(
+        "StartReplay",
+        {
+          "id": id,
+          "path": path,
+          "speed": speed.toDouble(),
+          "loop": loop,
+        },
+      );
+      _ids[id]!.value = _ids[id]!.value.copyWith(width: size["width"] as int, height: size["height"] as int);
+      return true;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Stops a replay started with [startReplay], the last frame stays.
+  Future<void> stopReplay(int id) async {
+    if (!_ids.containsKey(id)) return;
+    await _channel.invokeMethod(
+      "StopReplay",
+      {
+        "id": id,
+      },
+    );
+  }
+
+  /// Sets how many native threads split the conversion and copy of large
+  /// frames, 0 keeping everything on the calling thread. Frames with less
+  /// than [parallelThreshold] bytes of RGBA output are never split.
+  static Future<void> configureWorkers({required int threads, int parallelThreshold = 1 << 20}) async {
+    await _channel.invokeMethod(
+      "ConfigureWorkers",
+      {
+        "threads": threads,
+        "parallelThreshold": parallelThreshold,
+      },
+    );
+  }
+
+  /// Lets the pooled buffers allocated from now on, by any texture, use huge
+  /// pages ([hugePages], for buffers of 16 MB and up) and pages on the NUMA
+  /// node of the thread that produces into them ([numaLocal]). This cuts
+  /// TLB misses and cross-socket traffic for 4K and 8K frames. Where the OS
+  /// does not grant them the plugin falls back to regular pages. On Windows,
+  /// large pages need the "Lock pages in memory" privilege.
+  static Future<void> configureAllocator({bool hugePages = false, bool numaLocal = false}) async {
+    await _channel.invokeMethod(
+      "ConfigureAllocator",
+      {
+        "hugePages": hugePages,
+        "numaLocal": numaLocal,
+      },
+    );
+  }
+
+  /// Caps the pixel memory of all textures at [bytes], 0 removing the cap.
+  /// Above it unused pooled buffers are freed first, then the textures that
+  /// were neither updated nor drawn for [idleAfter] are evicted, least
+  /// recently used first. Evicted textures are transparent until their next
+  /// full frame.
+  static Future<void> setMemoryBudget(int bytes, {Duration idleAfter = const Duration(seconds: 2)}) async {
+    await _channel.invokeMethod(
+      "SetMemoryBudget",
+      {
+        "bytes": bytes,
+        "idleMs": idleAfter.inMilliseconds,
+      },
+    );
+  }
+
+  /// Bytes of pixel memory all textures hold right now.
+  static Future<int> totalResidentBytes() async {
+    return await _channel.invokeMethod("GetResidentBytes") as int;
+  }
+
+  // returns how many unregistered textures still wait for the raster thread
+  Future<int> _unregisterTexture(int id) async {
+    return await _channel.invokeMethod<int>(
+          "UnregisterTexture",
+          {
+            "id": id,
+          },
+        ) ??
+        0;
+  }
+
+  Future<void> _collectRetired(int retiring) async {
+    Stopwatch elapsed = Stopwatch()..start();
+    while (retiring > 0 && elapsed.elapsed < _retireTimeout) {
+      await Future.delayed(_releasePollInterval);
+      retiring = await _channel.invokeMethod<int>("CollectRetired") ?? 0;
+    }
+  }
+
+  /// The texture [id] at the size of its frames. With [downscale] the size
+  /// it ends up on screen at, after a `FittedBox` for example, is reported
+  /// with [setDisplaySize] so that large frames are shrunk before they are
+  /// uploaded. Region updates fail while frames are downscaled.
+  Widget widget(int id, {bool downscale = false}) {
     return ValueListenableBuilder<TextureInfo>(
       valueListenable: _ids[id]!,
       builder: (context, tex, _) {
         if (tex.handle != null) {
+          Widget texture = Texture(textureId: tex.handle!);
+          if (downscale) {
+            texture = _DisplaySizeReporter(
+              onSize: (size) => setDisplaySize(id, size?.width.ceil() ?? 0, size?.height.ceil() ?? 0),
+              child: texture,
+            );
+          }
           return SizedBox(
             width: tex.width.toDouble(),
             height: tex.height.toDouble(),
-            child: Texture(textureId: tex.handle!),
+            child: texture,
           );
         }
         return Container();
@@ -144,23 +680,293 @@ class TextureInterface {
   ValueListenable<TextureInfo>? textureInfo(int id) => _ids[id];
 }
 
+/// Publishes frames to one texture from any isolate. It only holds the native
+/// handle, so it can be sent to a background isolate that renders and submits
+/// frames without a hop through the UI isolate. Obtained from
+/// [TextureInterface.producer]; once the texture is unregistered every call
+/// fails with [TextureStatus.notFound].
+class TextureProducer {
+  /// Addresses the texture in the native entry points.
+  final int nativeHandle;
+
+  const TextureProducer(this.nativeHandle);
+
+  // looked up once per isolate
+  static TextureInterfaceBindings get _bindings => TextureInterfaceBindings.instance;
+
+  /// Displays [buffer] and takes ownership of it, see
+  /// [TextureInterface.update]. Returns a [TextureStatus], the buffer is freed
+  /// if it is an error.
+  int update(
+    ffi.Pointer<ffi.Uint8> buffer,
+    int width,
+    int height, {
+    int stride = 0,
+    TexturePixelFormat format = TexturePixelFormat.rgba,
+  }) {
+    int status = _bindings.updateFrameFormat(nativeHandle, buffer, width, height, stride, format.index);
+    // the buffer is only adopted on success
+    if (status != TextureStatus.ok) ffi.calloc.free(buffer);
+    return status;
+  }
+
+  /// Decodes a QOI or baseline JPEG image of [size] bytes natively and
+  /// displays it, see [TextureInterface.updateEncoded]. [data] stays owned by
+  /// the caller. Returns a [TextureStatus].
+  int updateEncoded(ffi.Pointer<ffi.Uint8> data, int size) {
+    return _bindings.updateFrameEncoded(nativeHandle, data, size, ffi.nullptr, ffi.nullptr);
+  }
+
+  /// Applies a delta of [size] bytes at [data] to the last frame, see
+  /// [TextureInterface.updateDelta]. [data] stays owned by the caller.
+  /// Returns a [TextureStatus].
+  int updateDelta(ffi.Pointer<ffi.Uint8> data, int size) {
+    return _bindings.updateFrameDelta(nativeHandle, data, size);
+  }
+
+  /// Returns a recycled buffer for a [width] x [height] RGBA frame, or a null
+  /// pointer if the texture is gone. Hand it back with [submitBuffer] or
+  /// [releaseBuffer].
+  ffi.Pointer<ffi.Uint8> acquireBuffer(int width, int height) {
+    return _bindings.acquireBuffer(nativeHandle, width, height);
+  }
+
+  /// Displays a buffer obtained from [acquireBuffer]. Returns a
+  /// [TextureStatus], see [TextureInterface.submitBuffer].
+  int submitBuffer(ffi.Pointer<ffi.Uint8> buffer, int width, int height) {
+    return _bindings.submitBuffer(nativeHandle, buffer, width, height);
+  }
+
+  /// Returns an unused buffer obtained from [acquireBuffer] to the pool.
+  int releaseBuffer(ffi.Pointer<ffi.Uint8> buffer) {
+    return _bindings.releaseBuffer(nativeHandle, buffer);
+  }
+
+  /// False while the last frame has not been picked up by the engine yet, or
+  /// once the texture is gone.
+  bool get isReadyForFrame => _bindings.readyForFrame(nativeHandle) == 1;
+}
+
+/// Encodes the difference between two RGBA frames of [width] x [height]
+/// pixels into reused native memory, for [TextureInterface.updateDelta] or
+/// [TextureProducer.updateDelta]. Unchanged pixels take next to no space, so
+/// mostly static content costs a fraction of a full frame to submit. It can
+/// be used on any isolate and has to be disposed.
+class TextureDeltaEncoder {
+  final int width;
+  final int height;
+  final int _capacity;
+  ffi.Pointer<ffi.Uint8> _delta;
+  final ffi.Pointer<ffi.Int64> _size = ffi.calloc<ffi.Int64>();
+
+  TextureDeltaEncoder(this.width, this.height)
+      : _capacity = TextureInterfaceBindings.instance.maxFrameDeltaSize(width, height),
+        _delta = ffi.nullptr {
+    if (_capacity <= 0) throw ArgumentError('invalid frame size $width x $height');
+    _delta = ffi.calloc<ffi.Uint8>(_capacity);
+  }
+
+  /// The last encoded delta, valid until the next [encode].
+  ffi.Pointer<ffi.Uint8> get delta => _delta;
+  int get size => _size.value;
+
+  /// Encodes the delta that turns [previous] into [current], whose rows are
+  /// [stride] bytes apart, 0 meaning tightly packed. Returns a
+  /// [TextureStatus].
+  int encode(ffi.Pointer<ffi.Uint8> previous, ffi.Pointer<ffi.Uint8> current, {int stride = 0}) {
+    return TextureInterfaceBindings.instance
+        .encodeFrameDelta(previous, current, width, height, stride, _delta, _capacity, _size);
+  }
+
+  void dispose() {
+    if (_delta == ffi.nullptr) return;
+    ffi.calloc.free(_delta);
+    ffi.calloc.free(_size);
+    _delta = ffi.nullptr;
+  }
+}
+
+/// Pixel layouts accepted by [TextureInterface.update]. Planar formats are
+/// expected in one buffer: NV12 as a luma plane followed by the interleaved
+/// UV plane, I420 as a luma plane followed by the U and V planes at half the
+/// pitch. YUV is BT.601 limited range.
+enum TexturePixelFormat { rgba, bgra, rgb24, rgb565, nv12, i420 }
+
+/// Natively rendered frames for [TextureInterface.startTestPattern].
+enum TexturePattern {
+  /// One color everywhere.
+  solid,
+
+  /// Red and green ramps that scroll every frame.
+  gradient,
+
+  /// Eight color bars that scroll every frame.
+  bars,
+
+  /// New random pixels every frame.
+  noise,
+
+  /// The gradient below a band of 64 black and white cells encoding the time
+  /// the frame was rendered, readable from a screen capture with
+  /// `ti_read_pattern_timestamp`.
+  timestamp,
+}
+
+/// Snapshot returned by [TextureInterface.getStats]. Latencies are in
+/// microseconds: [takeP50Us] is submit until the frame is handed to the
+/// raster thread, queue until the engine fetches it, upload until the engine
+/// is done with it and total is submit until then.
+class TextureStats {
+  final int framesSubmitted, framesDisplayed, framesDropped, framesSkipped, bytesSubmitted;
+  final double intervalSeconds, fps, bytesPerSecond;
+  final double takeP50Us, takeP99Us;
+  final double queueP50Us, queueP99Us;
+  final double uploadP50Us, uploadP99Us;
+  final double totalP50Us, totalP99Us;
+
+  TextureStats.fromMap(Map<Object?, Object?> map)
+      : framesSubmitted = map["framesSubmitted"] as int,
+        framesDisplayed = map["framesDisplayed"] as int,
+        framesDropped = map["framesDropped"] as int,
+        framesSkipped = map["framesSkipped"] as int,
+        bytesSubmitted = map["bytesSubmitted"] as int,
+        intervalSeconds = map["intervalSeconds"] as double,
+        fps = map["fps"] as double,
+        bytesPerSecond = map["bytesPerSecond"] as double,
+        takeP50Us = map["takeP50Us"] as double,
+        takeP99Us = map["takeP99Us"] as double,
+        queueP50Us = map["queueP50Us"] as double,
+        queueP99Us = map["queueP99Us"] as double,
+        uploadP50Us = map["uploadP50Us"] as double,
+        uploadP99Us = map["uploadP99Us"] as double,
+        totalP50Us = map["totalP50Us"] as double,
+        totalP99Us = map["totalP99Us"] as double;
+}
+
+/// Duplicate frame checks for [TextureInterface.setDuplicateCheck].
+enum TextureDuplicateCheck {
+  /// Every frame is published.
+  off,
+
+  /// Every byte of a frame is hashed.
+  full,
+
+  /// An eighth of every frame is hashed, changes elsewhere go unnoticed.
+  sampled,
+}
+
+/// Frame pacing modes for [TextureInterface.setPacing].
+enum TexturePacing {
+  /// Every frame is converted and shown as soon as possible.
+  immediate,
+
+  /// A frame is converted on a native thread once the engine fetched the
+  /// previous one, frames replaced before that are dropped without any
+  /// conversion work.
+  coalesce,
+}
+
+/// One frame for [TextureInterface.updateFrames], see [TextureInterface.update]
+/// for the arguments.
+class TextureUpdate {
+  final int id;
+  final ffi.Pointer<ffi.Uint8> buffer;
+  final int width, height;
+  final int stride;
+  final TexturePixelFormat format;
+
+  const TextureUpdate({
+    required this.id,
+    required this.buffer,
+    required this.width,
+    required this.height,
+    this.stride = 0,
+    this.format = TexturePixelFormat.rgba,
+  });
+}
+
+/// A changed rectangle for [TextureInterface.updateRegions]. [src] points at
+/// its top left RGBA pixel, rows are [srcStride] bytes apart.
+class TextureRegion {
+  final int x, y, width, height;
+  final ffi.Pointer<ffi.Uint8> src;
+  final int srcStride;
+
+  const TextureRegion({
+    required this.x,
+    required this.y,
+    required this.width,
+    required this.height,
+    required this.src,
+    required this.srcStride,
+  });
+}
+
 class TextureInfo {
   int? handle;
+
+  /// Addresses the texture in the native entry points.
+  int? nativeHandle;
   int width, height;
 
   TextureInfo({
     required this.handle,
+    this.nativeHandle,
     required this.width,
     required this.height,
   });
 
   Size get size => Size(width.toDouble(), height.toDouble());
 
-  TextureInfo copyWith({int? handle, int? width, int? height}) {
+  TextureInfo copyWith({int? handle, int? nativeHandle, int? width, int? height}) {
     return TextureInfo(
       handle: handle ?? this.handle,
+      nativeHandle: nativeHandle ?? this.nativeHandle,
       width: width ?? this.width,
       height: height ?? this.height,
     );
   }
 }
+
+/// Reports the size its child is painted at in physical pixels, null once it
+/// is no longer painted.
+class _DisplaySizeReporter extends SingleChildRenderObjectWidget {
+  final ValueChanged<Size?> onSize;
+
+  const _DisplaySizeReporter({required this.onSize, required Widget child}) : super(child: child);
+
+  @override
+  RenderObject createRenderObject(BuildContext context) => _RenderDisplaySizeReporter(onSize);
+
+  @override
+  void updateRenderObject(BuildContext context, _RenderDisplaySizeReporter renderObject) {
+    renderObject.onSize = onSize;
+  }
+}
+
+class _RenderDisplaySizeReporter extends RenderProxyBox {
+  ValueChanged<Size?> onSize;
+  Size? _reported;
+
+  _RenderDisplaySizeReporter(this.onSize);
+
+  @override
+  void paint(PaintingContext context, Offset offset) {
+    super.paint(context, offset);
+    // the transform to the root includes the device pixel ratio
+    Size displayed = MatrixUtils.transformRect(getTransformTo(null), Offset.zero & size).size;
+    if (displayed != _reported) {
+      _reported = displayed;
+      onSize(displayed);
+    }
+  }
+
+  @override
+  void detach() {
+    if (_reported != null) {
+      _reported = null;
+      onSize(null);
+    }
+    super.detach();
+  }
+}
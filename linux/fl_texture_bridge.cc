@@ -0,0 +1,157 @@
+#include "include/texture_interface/fl_texture_bridge.h"
+
+#include <cstdlib>
+
+// FlPixelBufferTexture that pulls its pixels from a Frame.
+G_DECLARE_FINAL_TYPE(FrameTexture, frame_texture, TEXTURE_INTERFACE, FRAME_TEXTURE, FlPixelBufferTexture)
+
+// The registrar and the engine hold a reference to the texture for as long
+// as they might call copy_pixels or upload what it returned, so the frame is
+// only let go once the texture is disposed.
+struct _FrameTexture
+{
+    FlPixelBufferTexture parent_instance;
+    TextureBridge::FetchCallback *fetch;
+    // the engine uploads the pixels right after copy_pixels returns without
+    // telling us, so the last fetch is released on the next one and when
+    // the texture is disposed
+    const PixelBuffer *fetched;
+    // set once the texture was unregistered, called when it is disposed
+    std::function<void()> *unregistered;
+};
+
+G_DEFINE_TYPE(FrameTexture, frame_texture, fl_pixel_buffer_texture_get_type())
+
+namespace
+{
+    // shown until the first frame arrives, copy_pixels cannot return nothing
+    const uint8_t kTransparentPixel[4] = {0, 0, 0, 0};
+
+    void ReleaseFetched(FrameTexture *self)
+    {
+        const PixelBuffer *fetched = self->fetched;
+        self->fetched = nullptr;
+        if (fetched != nullptr && fetched->release_callback != nullptr)
+            fetched->release_callback(fetched->release_context);
+    }
+}
+
+static gboolean frame_texture_copy_pixels(FlPixelBufferTexture *texture, const uint8_t **out_buffer,
+                                          uint32_t *width, uint32_t *height, GError **error)
+{
+    FrameTexture *self = TEXTURE_INTERFACE_FRAME_TEXTURE(texture);
+    ReleaseFetched(self);
+
+    // the Linux embedder does not pass the size the texture is drawn at
+    const PixelBuffer *pixels = self->fetch != nullptr ? (*self->fetch)(0, 0) : nullptr;
+    self->fetched = pixels;
+    if (pixels == nullptr)
+    {
+        *out_buffer = kTransparentPixel;
+        *width = 1;
+        *height = 1;
+        return TRUE;
+    }
+    *out_buffer = pixels->buffer;
+    *width = static_cast<uint32_t>(pixels->width);
+    *height = static_cast<uint32_t>(pixels->height);
+    return TRUE;
+}
+
+// Runs once nothing can call copy_pixels anymore, possibly on the raster
+// thread if the engine let go of the texture last.
+static void frame_texture_dispose(GObject *object)
+{
+    FrameTexture *self = TEXTURE_INTERFACE_FRAME_TEXTURE(object);
+    ReleaseFetched(self);
+    delete self->fetch;
+    self->fetch = nullptr;
+    std::function<void()> *unregistered = self->unregistered;
+    self->unregistered = nullptr;
+    if (unregistered != nullptr)
+    {
+        (*unregistered)();
+        delete unregistered;
+    }
+    G_OBJECT_CLASS(frame_texture_parent_class)->dispose(object);
+}
+
+static void frame_texture_class_init(FrameTextureClass *klass)
+{
+    FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels = frame_texture_copy_pixels;
+    G_OBJECT_CLASS(klass)->dispose = frame_texture_dispose;
+}
+
+static void frame_texture_init(FrameTexture *self) {}
+
+FlTextureBridge::FlTextureBridge(FlTextureRegistrar *texture_registrar)
+    : texture_registrar_(FL_TEXTURE_REGISTRAR(g_object_ref(texture_registrar))) {}
+
+FlTextureBridge::~FlTextureBridge()
+{
+    {
+        const std::lock_guard<std::mutex> lock(lifetime_->mutex);
+        lifetime_->closed = true;
+    }
+    for (const auto &[id, texture] : textures_)
+    {
+        fl_texture_registrar_unregister_texture(texture_registrar_, texture);
+        g_object_unref(texture);
+    }
+    g_object_unref(texture_registrar_);
+}
+
+int64_t FlTextureBridge::RegisterTexture(FetchCallback fetch)
+{
+    FrameTexture *texture = TEXTURE_INTERFACE_FRAME_TEXTURE(g_object_new(frame_texture_get_type(), nullptr));
+    texture->fetch = new FetchCallback(std::move(fetch));
+    fl_texture_registrar_register_texture(texture_registrar_, FL_TEXTURE(texture));
+
+    int64_t texture_id = fl_texture_get_texture_id(FL_TEXTURE(texture));
+    const std::lock_guard<std::mutex> lock(mutex_);
+    textures_[texture_id] = FL_TEXTURE(texture);
+    return texture_id;
+}
+
+void FlTextureBridge::UnregisterTexture(int64_t texture_id, std::function<void()> unregistered)
+{
+    FlTexture *texture = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(texture_id);
+        if (it == textures_.end())
+        {
+            if (unregistered)
+                unregistered();
+            return;
+        }
+        texture = it->second;
+        textures_.erase(it);
+    }
+
+    // reported once the texture is disposed, after the registrar and a
+    // raster thread still uploading it dropped their references, unless
+    // the bridge is gone by then
+    TEXTURE_INTERFACE_FRAME_TEXTURE(texture)->unregistered = new std::function<void()>(
+        [lifetime = lifetime_, unregistered = std::move(unregistered)]
+        {
+            const std::lock_guard<std::mutex> lock(lifetime->mutex);
+            if (!lifetime->closed && unregistered)
+                unregistered();
+        });
+    fl_texture_registrar_unregister_texture(texture_registrar_, texture);
+    g_object_unref(texture);
+}
+
+void FlTextureBridge::MarkTextureFrameAvailable(int64_t texture_id)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto it = textures_.find(texture_id);
+    if (it != textures_.end())
+        fl_texture_registrar_mark_texture_frame_available(texture_registrar_, it->second);
+}
+
+void FlTextureBridge::FreeBuffer(uint8_t *buffer)
+{
+    free(buffer);
+}
@@ -0,0 +1,42 @@
+#ifndef FL_TEXTURE_BRIDGE_H
+#define FL_TEXTURE_BRIDGE_H
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <texture_interface/texture_bridge.h>
+
+// TextureBridge over the Linux embedder's texture registrar. Buffers handed
+// over by Dart were allocated with calloc by package:ffi.
+class FlTextureBridge : public TextureBridge
+{
+public:
+    explicit FlTextureBridge(FlTextureRegistrar *texture_registrar);
+    ~FlTextureBridge();
+
+    int64_t RegisterTexture(FetchCallback fetch) override;
+    void UnregisterTexture(int64_t texture_id, std::function<void()> unregistered) override;
+    void MarkTextureFrameAvailable(int64_t texture_id) override;
+    void FreeBuffer(uint8_t *buffer) override;
+
+private:
+    // unregister callbacks can come after the bridge is gone, they are
+    // dropped then
+    struct Lifetime
+    {
+        std::mutex mutex;
+        bool closed = false;
+    };
+
+    FlTextureRegistrar *texture_registrar_;
+    std::mutex mutex_;
+    // holds a reference to every registered texture
+    std::unordered_map<int64_t, FlTexture *> textures_;
+    std::shared_ptr<Lifetime> lifetime_ = std::make_shared<Lifetime>();
+};
+
+#endif
@@ -0,0 +1,292 @@
+#include "include/texture_interface/texture_interface_plugin.h"
+
+#include <flutter_linux/flutter_linux.h>
+#include <gtk/gtk.h>
+#include <sys/utsname.h>
+
+#include <cstring>
+#include <vector>
+
+#include <texture_interface/frame_host.h>
+#include <texture_interface/page_allocator.h>
+
+#include "include/texture_interface/fl_texture_bridge.h"
+
+#define TEXTURE_INTERFACE_PLUGIN(obj)                                     \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), texture_interface_plugin_get_type(), \
+                              TextureInterfacePlugin))
+
+struct _TextureInterfacePlugin {
+  GObject parent_instance;
+  FlTextureBridge* bridge;
+  // frames of this plugin instance, destroyed before the bridge
+  FrameHost* host;
+};
+
+G_DEFINE_TYPE(TextureInterfacePlugin, texture_interface_plugin, g_object_get_type())
+
+namespace {
+
+int64_t ArgInt(FlValue* args, const char* key) {
+  return fl_value_get_int(fl_value_lookup_string(args, key));
+}
+
+FlMethodResponse* NotFound() {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new("-2", "Texture was not found.", nullptr));
+}
+
+FlValue* StatsToMap(const FrameStatsSnapshot& stats) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "framesSubmitted", fl_value_new_int(stats.frames_submitted));
+  fl_value_set_string_take(map, "framesDisplayed", fl_value_new_int(stats.frames_displayed));
+  fl_value_set_string_take(map, "framesDropped", fl_value_new_int(stats.frames_dropped));
+  fl_value_set_string_take(map, "framesSkipped", fl_value_new_int(stats.frames_skipped));
+  fl_value_set_string_take(map, "bytesSubmitted", fl_value_new_int(stats.bytes_submitted));
+  fl_value_set_string_take(map, "intervalSeconds", fl_value_new_float(stats.interval_seconds));
+  fl_value_set_string_take(map, "fps", fl_value_new_float(stats.fps));
+  fl_value_set_string_take(map, "bytesPerSecond", fl_value_new_float(stats.bytes_per_second));
+  fl_value_set_string_take(map, "takeP50Us", fl_value_new_float(stats.take_p50_us));
+  fl_value_set_string_take(map, "takeP99Us", fl_value_new_float(stats.take_p99_us));
+  fl_value_set_string_take(map, "queueP50Us", fl_value_new_float(stats.queue_p50_us));
+  fl_value_set_string_take(map, "queueP99Us", fl_value_new_float(stats.queue_p99_us));
+  fl_value_set_string_take(map, "uploadP50Us", fl_value_new_float(stats.upload_p50_us));
+  fl_value_set_string_take(map, "uploadP99Us", fl_value_new_float(stats.upload_p99_us));
+  fl_value_set_string_take(map, "totalP50Us", fl_value_new_float(stats.total_p50_us));
+  fl_value_set_string_take(map, "totalP99Us", fl_value_new_float(stats.total_p99_us));
+  return map;
+}
+
+}  // namespace
+
+// Called when a method call is received from Flutter.
+static void texture_interface_plugin_handle_method_call(
+    TextureInterfacePlugin* self,
+    FlMethodCall* method_call) {
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  // frames retired by earlier calls are destroyed on the platform thread
+  self->host->Collect();
+
+  if (strcmp(method, "getPlatformVersion") == 0) {
+    struct utsname uname_data = {};
+    uname(&uname_data);
+    g_autofree gchar* version = g_strdup_printf("Linux %s", uname_data.version);
+    g_autoptr(FlValue) result = fl_value_new_string(version);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "RegisterTexture") == 0) {
+    int id = static_cast<int>(ArgInt(args, "id"));
+    Frame* frame = self->host->Register(id);
+
+    // frames are updated through the native entry points in
+    // texture_interface_ffi.h, the handle addresses them there
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "textureId", fl_value_new_int(frame->texture_id()));
+    fl_value_set_string_take(result, "handle", fl_value_new_int(self->host->Handle(id)));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "BindSharedRing") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    const gchar* name = fl_value_get_string(fl_value_lookup_string(args, "name"));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else if (!frame->BindSharedRing(name)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-6", "Shared frame ring could not be opened.", nullptr));
+    } else {
+      g_autoptr(FlValue) result = fl_value_new_map();
+      fl_value_set_string_take(result, "width", fl_value_new_int(frame->shared_ring_width()));
+      fl_value_set_string_take(result, "height", fl_value_new_int(frame->shared_ring_height()));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "UnbindSharedRing") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else {
+      frame->UnbindSharedRing();
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "GetStats") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    bool reset = fl_value_get_bool(fl_value_lookup_string(args, "reset"));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else {
+      g_autoptr(FlValue) result = StatsToMap(frame->Stats(reset));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "ConfigureWorkers") == 0) {
+    int64_t threads = ArgInt(args, "threads");
+    int64_t threshold = ArgInt(args, "parallelThreshold");
+    if (threads < 0 || threads > 64 || threshold < 0) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-1", "Invalid worker configuration.", nullptr));
+    } else {
+      self->host->workers().Configure(static_cast<size_t>(threads),
+                                      static_cast<size_t>(threshold));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "SetMemoryBudget") == 0) {
+    int64_t bytes = ArgInt(args, "bytes");
+    int64_t idle_ms = ArgInt(args, "idleMs");
+    if (bytes < 0 || idle_ms < 0) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-1", "Invalid memory budget.", nullptr));
+    } else {
+      self->host->budget().Configure(static_cast<size_t>(bytes),
+                                     idle_ms * 1000000);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "ConfigureAllocator") == 0) {
+    PagePolicy policy;
+    policy.huge_pages =
+        fl_value_get_bool(fl_value_lookup_string(args, "hugePages"));
+    policy.numa_local =
+        fl_value_get_bool(fl_value_lookup_string(args, "numaLocal"));
+    // process wide, buffers allocated before keep their pages
+    SetPagePolicy(policy);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "GetResidentBytes") == 0) {
+    g_autoptr(FlValue) result = fl_value_new_int(
+        static_cast<int64_t>(self->host->budget().ResidentBytes()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "StartTestPattern") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    PatternConfig config = {
+        static_cast<TestPattern>(ArgInt(args, "pattern")),
+        static_cast<int32_t>(ArgInt(args, "width")),
+        static_cast<int32_t>(ArgInt(args, "height")),
+        fl_value_get_float(fl_value_lookup_string(args, "fps")),
+        static_cast<uint32_t>(ArgInt(args, "color")),
+    };
+    if (frame == nullptr) {
+      response = NotFound();
+    } else if (!self->host->patterns().Start(frame, config)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-1", "Invalid test pattern.", nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "StopTestPattern") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else {
+      self->host->patterns().Stop(frame);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "StartRecording") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    const gchar* path = fl_value_get_string(fl_value_lookup_string(args, "path"));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else if (!frame->StartRecording(path)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-1", "Capture file could not be created.", nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "StopRecording") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else {
+      g_autoptr(FlValue) result = fl_value_new_int(static_cast<int64_t>(frame->StopRecording()));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "StartReplay") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    const gchar* path = fl_value_get_string(fl_value_lookup_string(args, "path"));
+    double speed = fl_value_get_float(fl_value_lookup_string(args, "speed"));
+    bool loop = fl_value_get_bool(fl_value_lookup_string(args, "loop"));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else if (!frame->StartReplay(path, speed, loop)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "-1", "Capture file could not be read.", nullptr));
+    } else {
+      g_autoptr(FlValue) result = fl_value_new_map();
+      fl_value_set_string_take(result, "width", fl_value_new_int(frame->replay_width()));
+      fl_value_set_string_take(result, "height", fl_value_new_int(frame->replay_height()));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "StopReplay") == 0) {
+    Frame* frame = self->host->Find(static_cast<int>(ArgInt(args, "id")));
+    if (frame == nullptr) {
+      response = NotFound();
+    } else {
+      frame->StopReplay();
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "UnregisterTexture") == 0) {
+    if (!self->host->Unregister(static_cast<int>(ArgInt(args, "id")))) {
+      response = NotFound();
+    } else {
+      g_autoptr(FlValue) result =
+          fl_value_new_int(static_cast<int64_t>(self->host->retired_count()));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "UnregisterAll") == 0) {
+    FlValue* list = fl_value_lookup_string(args, "ids");
+    std::vector<int> ids;
+    for (size_t i = 0; i < fl_value_get_length(list); i++) {
+      ids.push_back(static_cast<int>(fl_value_get_int(fl_value_get_list_value(list, i))));
+    }
+    self->host->UnregisterAll(ids);
+    g_autoptr(FlValue) result =
+        fl_value_new_int(static_cast<int64_t>(self->host->retired_count()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "CollectRetired") == 0) {
+    // retired frames were collected before dispatching
+    g_autoptr(FlValue) result =
+        fl_value_new_int(static_cast<int64_t>(self->host->retired_count()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
+static void texture_interface_plugin_dispose(GObject* object) {
+  TextureInterfacePlugin* self = TEXTURE_INTERFACE_PLUGIN(object);
+  delete self->host;
+  self->host = nullptr;
+  delete self->bridge;
+  self->bridge = nullptr;
+
+  G_OBJECT_CLASS(texture_interface_plugin_parent_class)->dispose(object);
+}
+
+static void texture_interface_plugin_class_init(TextureInterfacePluginClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = texture_interface_plugin_dispose;
+}
+
+static void texture_interface_plugin_init(TextureInterfacePlugin* self) {}
+
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  TextureInterfacePlugin* plugin = TEXTURE_INTERFACE_PLUGIN(user_data);
+  texture_interface_plugin_handle_method_call(plugin, method_call);
+}
+
+void texture_interface_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  TextureInterfacePlugin* plugin = TEXTURE_INTERFACE_PLUGIN(
+      g_object_new(texture_interface_plugin_get_type(), nullptr));
+  plugin->bridge = new FlTextureBridge(fl_plugin_registrar_get_texture_registrar(registrar));
+  plugin->host = new FrameHost(plugin->bridge);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_autoptr(FlMethodChannel) channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            "texture_interface",
+                            FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel, method_call_cb,
+                                            g_object_ref(plugin),
+                                            g_object_unref);
+
+  g_object_unref(plugin);
+}
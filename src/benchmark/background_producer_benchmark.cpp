@@ -0,0 +1,93 @@
+#include "texture_interface/frame_host.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/texture_interface_ffi.h"
+
+namespace
+{
+    constexpr int32_t kWidth = 1920;
+    constexpr int32_t kHeight = 1080;
+
+    // Stands in for the UI isolate's build, layout and paint of one frame:
+    // a fixed amount of work that touches memory but no pixels.
+    uint64_t UiFrame(std::vector<uint32_t> &state)
+    {
+        for (size_t i = 1; i < state.size(); i++)
+            state[i] = state[i] * 1664525u + state[i - 1] + 1013904223u;
+        return std::accumulate(state.begin(), state.end(), uint64_t{0});
+    }
+
+    // Times UI frames while |state.range(0)| background threads each push
+    // 1080p frames into their own texture as fast as they can through the
+    // C ABI handles, the way TextureProducer does from a background isolate,
+    // and a raster thread shows them at 60 Hz. The UI frame time should not
+    // depend on the number of producers while there are cores to spare.
+    void BM_UiFrameWithBackgroundProducers(benchmark::State &state)
+    {
+        auto producers = static_cast<int>(state.range(0));
+        FakeTextureBridge bridge;
+        std::atomic<bool> running{true};
+        std::atomic<uint64_t> produced{0};
+        {
+            FrameHost host(&bridge);
+            std::vector<int64_t> handles;
+            std::vector<int64_t> texture_ids;
+            for (int id = 0; id < producers; id++)
+            {
+                texture_ids.push_back(host.Register(id)->texture_id());
+                handles.push_back(host.Handle(id));
+            }
+
+            std::vector<std::thread> threads;
+            for (int64_t handle : handles)
+            {
+                threads.emplace_back([&, handle]
+                                     {
+                                         for (uint8_t value = 0; running.load(std::memory_order_relaxed); value++)
+                                         {
+                                             uint8_t *buffer = ti_acquire_buffer(handle, kWidth, kHeight);
+                                             if (buffer == nullptr)
+                                                 continue;
+                                             std::memset(buffer, value, static_cast<size_t>(kWidth) * kHeight * 4);
+                                             ti_submit_buffer(handle, buffer, kWidth, kHeight);
+                                             produced.fetch_add(1, std::memory_order_relaxed);
+                                         }
+                                     });
+            }
+            threads.emplace_back([&]
+                                 {
+                                     auto next = std::chrono::steady_clock::now();
+                                     while (running.load(std::memory_order_relaxed))
+                                     {
+                                         for (int64_t texture_id : texture_ids)
+                                             bridge.Fetch(texture_id);
+                                         next += std::chrono::microseconds(16667);
+                                         std::this_thread::sleep_until(next);
+                                     }
+                                 });
+
+            std::vector<uint32_t> ui_state(1 << 16, 1);
+            auto started = std::chrono::steady_clock::now();
+            for (auto _ : state)
+                benchmark::DoNotOptimize(UiFrame(ui_state));
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+            running.store(false);
+            for (std::thread &thread : threads)
+                thread.join();
+            state.counters["producer_fps"] = static_cast<double>(produced.load()) / seconds;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_UiFrameWithBackgroundProducers)->ArgName("producers")->DenseRange(0, 4)->UseRealTime();
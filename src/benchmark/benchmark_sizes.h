@@ -0,0 +1,15 @@
+#ifndef BENCHMARK_SIZES_H
+#define BENCHMARK_SIZES_H
+
+#include <benchmark/benchmark.h>
+
+// 720p, 1080p and 4K as width and height arguments.
+inline void FrameSizes(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"width", "height"});
+    benchmark->Args({1280, 720});
+    benchmark->Args({1920, 1080});
+    benchmark->Args({3840, 2160});
+}
+
+#endif
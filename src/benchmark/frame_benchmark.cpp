@@ -0,0 +1,191 @@
+#include "texture_interface/frame.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "benchmark_sizes.h"
+#include "fake_texture_bridge.h"
+
+namespace
+{
+    void KeepBuffer(void *, uint8_t *) {}
+
+    // caller owned frames handed to Update, enough of them that none is
+    // reused while the frame still shows it
+    struct SourceFrames
+    {
+        SourceFrames(PixelFormat format, int32_t width, int32_t height)
+            : format(format), width(width), height(height)
+        {
+            size_t size = SourceBytes(format, PackedStride(format, width), height);
+            for (std::vector<uint8_t> &buffer : buffers)
+                buffer.assign(size, 0x80);
+        }
+
+        bool Update(Frame &frame, size_t index)
+        {
+            return frame.Update(buffers[index % buffers.size()].data(), width, height, 0, format, true,
+                                {&KeepBuffer, nullptr});
+        }
+
+        PixelFormat format;
+        int32_t width;
+        int32_t height;
+        std::array<std::vector<uint8_t>, 4> buffers;
+    };
+
+    int64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since)
+            .count();
+    }
+
+    // enough frames to fill the frame's pool before timing starts
+    constexpr size_t kWarmupFrames = 4;
+
+    // Update and fetch of one frame per iteration, items are frames.
+    void UpdateAndFetch(benchmark::State &state, PixelFormat format)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        FakeTextureBridge bridge;
+        WorkerPool workers;
+        {
+            Frame frame(&bridge, &workers);
+            SourceFrames sources(format, width, height);
+            size_t index = 0;
+            for (; index < kWarmupFrames; index++)
+            {
+                sources.Update(frame, index);
+                bridge.Fetch(frame.texture_id());
+            }
+            for (auto _ : state)
+            {
+                if (!sources.Update(frame, index++))
+                    state.SkipWithError("update failed");
+                benchmark::DoNotOptimize(bridge.Fetch(frame.texture_id()));
+            }
+            frame.Retire({});
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_UpdateRgba(benchmark::State &state)
+    {
+        UpdateAndFetch(state, PixelFormat::kRGBA);
+    }
+
+    void BM_UpdateBgra(benchmark::State &state)
+    {
+        UpdateAndFetch(state, PixelFormat::kBGRA);
+    }
+
+    void BM_UpdateNv12(benchmark::State &state)
+    {
+        UpdateAndFetch(state, PixelFormat::kNV12);
+    }
+
+    // A producer filling pooled buffers, without any conversion.
+    void BM_SubmitBuffer(benchmark::State &state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        FakeTextureBridge bridge;
+        {
+            Frame frame(&bridge);
+            for (size_t index = 0; index < kWarmupFrames; index++)
+            {
+                uint8_t *buffer = frame.AcquireBuffer(width, height);
+                frame.SubmitBuffer(buffer, width, height);
+                bridge.Fetch(frame.texture_id());
+            }
+            for (auto _ : state)
+            {
+                uint8_t *buffer = frame.AcquireBuffer(width, height);
+                if (buffer == nullptr || !frame.SubmitBuffer(buffer, width, height))
+                    state.SkipWithError("submit failed");
+                benchmark::DoNotOptimize(bridge.Fetch(frame.texture_id()));
+            }
+            frame.Retire({});
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Raster thread fetches while a producer converts BGRA frames as fast as
+    // it can. The fetch should not wait for the producer.
+    void BM_FetchWhileProducing(benchmark::State &state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        FakeTextureBridge bridge;
+        WorkerPool workers;
+        {
+            Frame frame(&bridge, &workers);
+            SourceFrames sources(PixelFormat::kBGRA, width, height);
+            sources.Update(frame, 0);
+            std::atomic<bool> producing{true};
+            std::thread producer([&]
+                                 {
+                                     for (size_t index = 1; producing.load(std::memory_order_relaxed); index++)
+                                         sources.Update(frame, index);
+                                 });
+            int64_t max_fetch = 0;
+            for (auto _ : state)
+            {
+                auto started = std::chrono::steady_clock::now();
+                benchmark::DoNotOptimize(bridge.Fetch(frame.texture_id()));
+                max_fetch = std::max(max_fetch, ElapsedNanoseconds(started));
+            }
+            producing.store(false);
+            producer.join();
+            state.counters["max_fetch_ns"] = static_cast<double>(max_fetch);
+            frame.Retire({});
+        }
+    }
+
+    // Producer converts BGRA frames while the raster thread fetches as fast
+    // as it can. The update should not wait for the raster thread.
+    void BM_UpdateWhileFetching(benchmark::State &state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        FakeTextureBridge bridge;
+        WorkerPool workers;
+        {
+            Frame frame(&bridge, &workers);
+            SourceFrames sources(PixelFormat::kBGRA, width, height);
+            std::atomic<bool> fetching{true};
+            std::thread raster([&]
+                               {
+                                   while (fetching.load(std::memory_order_relaxed))
+                                       benchmark::DoNotOptimize(bridge.Fetch(frame.texture_id()));
+                               });
+            int64_t max_update = 0;
+            size_t index = 0;
+            for (auto _ : state)
+            {
+                auto started = std::chrono::steady_clock::now();
+                sources.Update(frame, index++);
+                max_update = std::max(max_update, ElapsedNanoseconds(started));
+            }
+            fetching.store(false);
+            raster.join();
+            state.counters["max_update_ns"] = static_cast<double>(max_update);
+            frame.Retire({});
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_UpdateRgba)->Apply(FrameSizes);
+BENCHMARK(BM_UpdateBgra)->Apply(FrameSizes);
+BENCHMARK(BM_UpdateNv12)->Apply(FrameSizes);
+BENCHMARK(BM_SubmitBuffer)->Apply(FrameSizes);
+BENCHMARK(BM_FetchWhileProducing)->Apply(FrameSizes)->UseRealTime();
+BENCHMARK(BM_UpdateWhileFetching)->Apply(FrameSizes)->UseRealTime();
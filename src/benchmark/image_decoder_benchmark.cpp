@@ -0,0 +1,196 @@
+#include "texture_interface/image_decoder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "benchmark_sizes.h"
+#include "texture_interface/test_pattern.h"
+
+#ifdef TEXTURE_INTERFACE_HAVE_LIBJPEG
+#include <jpeglib.h>
+#endif
+
+namespace
+{
+    // A camera-like frame: the gradient pattern with some sensor noise, so
+    // that neither codec sees long runs of identical pixels.
+    std::vector<uint8_t> SourceImage(int32_t width, int32_t height)
+    {
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+        RenderTestPatternRows(TestPattern::kGradient, 0, 0, 0, rgba.data(), width, height, 0, height);
+        uint32_t random = 1;
+        for (size_t i = 0; i < rgba.size(); i++)
+        {
+            if (i % 4 == 3)
+                continue;
+            random = random * 1664525u + 1013904223u;
+            rgba[i] = static_cast<uint8_t>(rgba[i] + (random >> 29));
+        }
+        return rgba;
+    }
+
+    // Straightforward QOI encoder following the specification.
+    std::vector<uint8_t> EncodeQoi(const std::vector<uint8_t> &rgba, int32_t width, int32_t height)
+    {
+        std::vector<uint8_t> out = {'q', 'o', 'i', 'f'};
+        for (uint32_t value : {static_cast<uint32_t>(width), static_cast<uint32_t>(height)})
+        {
+            for (int shift = 24; shift >= 0; shift -= 8)
+                out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+        out.push_back(4);
+        out.push_back(0);
+
+        uint8_t index[64][4] = {};
+        uint8_t previous[4] = {0, 0, 0, 255};
+        int run = 0;
+        size_t pixels = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < pixels; i++)
+        {
+            const uint8_t *pixel = &rgba[i * 4];
+            if (std::memcmp(pixel, previous, 4) == 0)
+            {
+                if (++run == 62 || i == pixels - 1)
+                {
+                    out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0)
+            {
+                out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                run = 0;
+            }
+
+            int hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+            if (std::memcmp(index[hash], pixel, 4) == 0)
+            {
+                out.push_back(static_cast<uint8_t>(hash));
+            }
+            else if (pixel[3] != previous[3])
+            {
+                out.push_back(0xFF);
+                out.insert(out.end(), pixel, pixel + 4);
+            }
+            else
+            {
+                auto dr = static_cast<int8_t>(pixel[0] - previous[0]);
+                auto dg = static_cast<int8_t>(pixel[1] - previous[1]);
+                auto db = static_cast<int8_t>(pixel[2] - previous[2]);
+                auto dr_dg = static_cast<int8_t>(dr - dg);
+                auto db_dg = static_cast<int8_t>(db - dg);
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                {
+                    out.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                }
+                else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+                {
+                    out.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                    out.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+                }
+                else
+                {
+                    out.push_back(0xFE);
+                    out.insert(out.end(), pixel, pixel + 3);
+                }
+            }
+            std::memcpy(index[hash], pixel, 4);
+            std::memcpy(previous, pixel, 4);
+        }
+        out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+        return out;
+    }
+
+#ifdef TEXTURE_INTERFACE_HAVE_LIBJPEG
+    // Baseline 4:2:0 JPEG at quality 85, what MJPEG cameras typically send.
+    std::vector<uint8_t> EncodeJpeg(const std::vector<uint8_t> &rgba, int32_t width, int32_t height)
+    {
+        jpeg_compress_struct compress;
+        jpeg_error_mgr error;
+        compress.err = jpeg_std_error(&error);
+        jpeg_create_compress(&compress);
+        unsigned char *data = nullptr;
+        unsigned long size = 0;
+        jpeg_mem_dest(&compress, &data, &size);
+        compress.image_width = width;
+        compress.image_height = height;
+        compress.input_components = 3;
+        compress.in_color_space = JCS_RGB;
+        jpeg_set_defaults(&compress);
+        jpeg_set_quality(&compress, 85, TRUE);
+        jpeg_start_compress(&compress, TRUE);
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+        while (compress.next_scanline < compress.image_height)
+        {
+            const uint8_t *pixels = &rgba[static_cast<size_t>(compress.next_scanline) * width * 4];
+            for (int32_t x = 0; x < width; x++)
+                std::memcpy(&row[x * 3], &pixels[x * 4], 3);
+            JSAMPROW rows[] = {row.data()};
+            jpeg_write_scanlines(&compress, rows, 1);
+        }
+        jpeg_finish_compress(&compress);
+        jpeg_destroy_compress(&compress);
+        std::vector<uint8_t> jpeg(data, data + size);
+        std::free(data);
+        return jpeg;
+    }
+#endif
+
+    // Decodes |encoded| into RGBA per iteration, with the frame engine's
+    // worker pool for the stages that can be split.
+    void Decode(benchmark::State &state, const std::vector<uint8_t> &encoded, int32_t width, int32_t height)
+    {
+        ImageInfo info;
+        if (!ReadImageInfo(encoded.data(), encoded.size(), &info) || info.width != width || info.height != height)
+        {
+            state.SkipWithError("unreadable image");
+            return;
+        }
+        WorkerPool workers;
+        std::vector<uint8_t> dst(static_cast<size_t>(width) * height * 4);
+        for (auto _ : state)
+        {
+            if (!DecodeImage(info, encoded.data(), encoded.size(), dst.data(), &workers))
+                state.SkipWithError("decoding failed");
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dst.size()));
+        state.SetItemsProcessed(state.iterations());
+        state.counters["encoded_bytes"] = static_cast<double>(encoded.size());
+    }
+
+    void BM_DecodeQoi(benchmark::State &state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        std::vector<uint8_t> source = SourceImage(width, height);
+        std::vector<uint8_t> encoded = EncodeQoi(source, width, height);
+
+        // QOI is lossless, the encoder is checked against the decoder
+        std::vector<uint8_t> decoded(source.size());
+        if (!DecodeQoi(encoded.data(), encoded.size(), decoded.data(), width, height) || decoded != source)
+        {
+            state.SkipWithError("QOI round trip failed");
+            return;
+        }
+        Decode(state, encoded, width, height);
+    }
+
+#ifdef TEXTURE_INTERFACE_HAVE_LIBJPEG
+    void BM_DecodeJpeg(benchmark::State &state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        Decode(state, EncodeJpeg(SourceImage(width, height), width, height), width, height);
+    }
+#endif
+}
+
+BENCHMARK(BM_DecodeQoi)->Apply(FrameSizes)->UseRealTime();
+#ifdef TEXTURE_INTERFACE_HAVE_LIBJPEG
+BENCHMARK(BM_DecodeJpeg)->Apply(FrameSizes)->UseRealTime();
+#endif
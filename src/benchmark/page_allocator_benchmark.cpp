@@ -0,0 +1,95 @@
+#include "texture_interface/page_allocator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "texture_interface/pixel_convert.h"
+
+namespace
+{
+    // sets the page policy for the lifetime of a benchmark
+    class ScopedPagePolicy
+    {
+    public:
+        explicit ScopedPagePolicy(const PagePolicy &policy) : previous_(GetPagePolicy()) { SetPagePolicy(policy); }
+        ~ScopedPagePolicy() { SetPagePolicy(previous_); }
+
+    private:
+        PagePolicy previous_;
+    };
+
+    // 4K and 8K as width and height arguments.
+    void LargeFrameSizes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgNames({"width", "height"});
+        benchmark->Args({3840, 2160});
+        benchmark->Args({7680, 4320});
+    }
+
+    // What a frame pool pays for a new buffer: allocating it, touching every
+    // page once and freeing it.
+    void BM_AllocatePages(benchmark::State &state, PagePolicy policy)
+    {
+        ScopedPagePolicy scoped(policy);
+        size_t size = static_cast<size_t>(state.range(0)) * state.range(1) * 4;
+        bool huge = false;
+        for (auto _ : state)
+        {
+            PageAllocation allocation = AllocatePages(size);
+            if (allocation.data == nullptr)
+            {
+                state.SkipWithError("out of memory");
+                break;
+            }
+            std::memset(allocation.data, 0, size);
+            huge = allocation.huge;
+            FreePages(allocation);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+        state.counters["huge"] = huge;
+    }
+
+    // What the copy path pays on every frame once the buffers exist:
+    // converting BGRA between two buffers allocated under |policy|.
+    void BM_ConvertBetweenPages(benchmark::State &state, PagePolicy policy)
+    {
+        ScopedPagePolicy scoped(policy);
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        size_t size = static_cast<size_t>(width) * height * 4;
+        PageAllocation src = AllocatePages(size);
+        PageAllocation dst = AllocatePages(size);
+        if (src.data == nullptr || dst.data == nullptr)
+        {
+            state.SkipWithError("out of memory");
+        }
+        else
+        {
+            std::memset(src.data, 0x80, size);
+            std::memset(dst.data, 0, size);
+            for (auto _ : state)
+            {
+                ConvertRows(PixelFormat::kBGRA, src.data, width * 4, width, height, dst.data, 0, height);
+                benchmark::ClobberMemory();
+            }
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+            state.counters["huge"] = src.huge && dst.huge;
+            state.counters["node"] = dst.node;
+        }
+        if (src.data != nullptr)
+            FreePages(src);
+        if (dst.data != nullptr)
+            FreePages(dst);
+    }
+}
+
+BENCHMARK_CAPTURE(BM_AllocatePages, default, PagePolicy{false, false})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_AllocatePages, huge_pages, PagePolicy{true, false})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_AllocatePages, numa_local, PagePolicy{false, true})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_AllocatePages, huge_pages_numa_local, PagePolicy{true, true})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertBetweenPages, default, PagePolicy{false, false})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertBetweenPages, huge_pages, PagePolicy{true, false})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertBetweenPages, numa_local, PagePolicy{false, true})->Apply(LargeFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertBetweenPages, huge_pages_numa_local, PagePolicy{true, true})
+    ->Apply(LargeFrameSizes);
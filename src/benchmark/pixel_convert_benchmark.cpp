@@ -0,0 +1,71 @@
+#include "texture_interface/pixel_convert.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "benchmark_sizes.h"
+
+namespace
+{
+    // Converts a whole frame on one thread with the kernels of the running
+    // CPU.
+    void BM_ConvertFrame(benchmark::State &state, PixelFormat format)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        int32_t stride = PackedStride(format, width);
+        std::vector<uint8_t> src(SourceBytes(format, stride, height), 0x80);
+        std::vector<uint8_t> dst(static_cast<size_t>(width) * height * 4);
+        for (auto _ : state)
+        {
+            ConvertRows(format, src.data(), stride, width, height, dst.data(), 0, height);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dst.size()));
+    }
+
+    // The row kernels of one SIMD tier on a 1080p frame, to compare the
+    // tiers against each other.
+    void BM_ConvertKernels(benchmark::State &state, PixelFormat format)
+    {
+        auto tier = static_cast<SimdTier>(state.range(0));
+        if (DetectSimdTier() < tier)
+        {
+            state.SkipWithError("not supported by this CPU");
+            return;
+        }
+        const ConvertKernels &kernels = ConvertKernelsFor(tier);
+        constexpr int32_t kWidth = 1920;
+        constexpr int32_t kHeight = 1080;
+        int32_t stride = PackedStride(format, kWidth);
+        std::vector<uint8_t> src(SourceBytes(format, stride, kHeight), 0x80);
+        std::vector<uint8_t> dst(static_cast<size_t>(kWidth) * kHeight * 4);
+        for (auto _ : state)
+        {
+            ConvertRows(format, src.data(), stride, kWidth, kHeight, dst.data(), 0, kHeight, kernels);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dst.size()));
+    }
+
+    // scalar, SSE2 and AVX2
+    void SimdTiers(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgName("tier");
+        for (SimdTier tier : {SimdTier::kScalar, SimdTier::kSse2, SimdTier::kAvx2})
+            benchmark->Arg(static_cast<int64_t>(tier));
+    }
+}
+
+BENCHMARK_CAPTURE(BM_ConvertFrame, bgra, PixelFormat::kBGRA)->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertFrame, rgb24, PixelFormat::kRGB24)->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertFrame, rgb565, PixelFormat::kRGB565)->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertFrame, nv12, PixelFormat::kNV12)->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertFrame, i420, PixelFormat::kI420)->Apply(FrameSizes);
+
+BENCHMARK_CAPTURE(BM_ConvertKernels, bgra, PixelFormat::kBGRA)->Apply(SimdTiers);
+BENCHMARK_CAPTURE(BM_ConvertKernels, rgb24, PixelFormat::kRGB24)->Apply(SimdTiers);
+BENCHMARK_CAPTURE(BM_ConvertKernels, rgb565, PixelFormat::kRGB565)->Apply(SimdTiers);
+BENCHMARK_CAPTURE(BM_ConvertKernels, nv12, PixelFormat::kNV12)->Apply(SimdTiers);
+BENCHMARK_CAPTURE(BM_ConvertKernels, i420, PixelFormat::kI420)->Apply(SimdTiers);
@@ -0,0 +1,43 @@
+#include "texture_interface/worker_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "texture_interface/pixel_convert.h"
+
+namespace
+{
+    // Converts a 4K BGRA frame in bands on a pool of |threads| workers
+    // besides the calling thread, to show how conversion scales with cores.
+    void BM_ParallelConvert(benchmark::State &state)
+    {
+        constexpr int32_t kWidth = 3840;
+        constexpr int32_t kHeight = 2160;
+        WorkerPool workers(static_cast<size_t>(state.range(0)));
+        workers.Configure(static_cast<size_t>(state.range(0)), 0);
+        std::vector<uint8_t> src(static_cast<size_t>(kWidth) * kHeight * 4, 0x80);
+        std::vector<uint8_t> dst(src.size());
+        for (auto _ : state)
+        {
+            workers.ParallelFor(kHeight, dst.size(), [&](int32_t begin, int32_t end)
+                                { ConvertRows(PixelFormat::kBGRA, src.data(), kWidth * 4, kWidth, kHeight,
+                                              dst.data(), begin, end); });
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(dst.size()));
+    }
+
+    // from the calling thread alone up to one worker per other core
+    void WorkerCounts(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgName("workers");
+        int64_t cores = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+        for (int64_t workers = 0; workers < cores; workers++)
+            benchmark->Arg(workers);
+    }
+}
+
+BENCHMARK(BM_ParallelConvert)->Apply(WorkerCounts)->UseRealTime();
@@ -0,0 +1,197 @@
+#include "include/texture_interface/buffer_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t kPageSize = 4096;
+
+    size_t RoundUpToPage(size_t size)
+    {
+        return (size + kPageSize - 1) & ~(kPageSize - 1);
+    }
+}
+
+BufferPool::BufferPool(size_t max_free_buffers, std::atomic<size_t> *resident_total)
+    : max_free_buffers_(max_free_buffers), resident_total_(resident_total)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    for (const Entry &entry : entries_)
+        Deallocate(entry);
+}
+
+uint8_t *BufferPool::Acquire(size_t size)
+{
+    return Take(size, false);
+}
+
+uint8_t *BufferPool::Lend(size_t size)
+{
+    return Take(size, true);
+}
+
+uint8_t *BufferPool::Take(size_t size, bool lent)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    // best fit, so that a pool shared by differently sized frames does not
+    // hand out a 4K buffer for a thumbnail, and local memory before that
+    int32_t node = CurrentNumaNode();
+    Entry *best = nullptr;
+    for (Entry &entry : entries_)
+    {
+        if (entry.in_use || entry.capacity < size)
+            continue;
+        bool local = entry.allocation.node == node;
+        bool best_local = best != nullptr && best->allocation.node == node;
+        if (best == nullptr || local > best_local || (local == best_local && entry.capacity < best->capacity))
+            best = &entry;
+    }
+    if (best != nullptr)
+    {
+        best->in_use = true;
+        best->lent = lent;
+        return best->data;
+    }
+
+    PageAllocation allocation = AllocatePages(RoundUpToPage(size));
+    if (allocation.data == nullptr)
+        return nullptr;
+    // touch every page now instead of page faulting on the producer's first
+    // write, which also places them on its node
+    std::memset(allocation.data, 0, allocation.size);
+    entries_.push_back({allocation.data, allocation.size, true, lent, allocation});
+    allocation_count_++;
+    if (resident_total_ != nullptr)
+        resident_total_->fetch_add(allocation.size);
+    return allocation.data;
+}
+
+size_t BufferPool::LentCapacity(const uint8_t *buffer) const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry &entry : entries_)
+    {
+        if (entry.data == buffer)
+            return entry.lent ? entry.capacity : 0;
+    }
+    return 0;
+}
+
+bool BufferPool::Reclaim(uint8_t *buffer, size_t size)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = Find(buffer);
+    if (entry == entries_.end() || !entry->lent || entry->capacity < size)
+        return false;
+    entry->lent = false;
+    return true;
+}
+
+bool BufferPool::Return(uint8_t *buffer)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = Find(buffer);
+    if (entry == entries_.end() || !entry->lent)
+        return false;
+    Free(entry);
+    return true;
+}
+
+bool BufferPool::Release(uint8_t *buffer)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = Find(buffer);
+    if (entry == entries_.end() || !entry->in_use || entry->lent)
+        return false;
+    Free(entry);
+    return true;
+}
+
+std::vector<BufferPool::Entry>::iterator BufferPool::Find(const uint8_t *buffer)
+{
+    return std::find_if(entries_.begin(), entries_.end(),
+                        [buffer](const Entry &entry)
+                        { return entry.data == buffer; });
+}
+
+void BufferPool::Deallocate(const Entry &entry)
+{
+    FreePages(entry.allocation);
+    if (resident_total_ != nullptr)
+        resident_total_->fetch_sub(entry.capacity);
+}
+
+void BufferPool::Free(std::vector<Entry>::iterator entry)
+{
+    entry->in_use = false;
+    entry->lent = false;
+
+    size_t free_buffers = std::count_if(entries_.begin(), entries_.end(),
+                                        [](const Entry &entry)
+                                        { return !entry.in_use; });
+    if (free_buffers > max_free_buffers_)
+    {
+        // drop the smallest free buffer, it is the most likely to be stale
+        // after a resolution change
+        auto smallest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it)
+        {
+            if (!it->in_use && (smallest == entries_.end() || it->capacity < smallest->capacity))
+                smallest = it;
+        }
+        Deallocate(*smallest);
+        entries_.erase(smallest);
+    }
+}
+
+void BufferPool::Trim()
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::remove_if(entries_.begin(), entries_.end(),
+                             [this](const Entry &entry)
+                             {
+                                 if (entry.in_use)
+                                     return false;
+                                 Deallocate(entry);
+                                 return true;
+                             });
+    entries_.erase(it, entries_.end());
+}
+
+void BufferPool::DetachResidentTotal()
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (resident_total_ == nullptr)
+        return;
+    for (const Entry &entry : entries_)
+        resident_total_->fetch_sub(entry.capacity);
+    resident_total_ = nullptr;
+}
+
+size_t BufferPool::allocation_count() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return allocation_count_;
+}
+
+size_t BufferPool::free_count() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return std::count_if(entries_.begin(), entries_.end(),
+                         [](const Entry &entry)
+                         { return !entry.in_use; });
+}
+
+size_t BufferPool::resident_bytes() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const Entry &entry : entries_)
+        bytes += entry.capacity;
+    return bytes;
+}
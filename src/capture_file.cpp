@@ -0,0 +1,265 @@
+#include "include/texture_interface/capture_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // initial size of a capture file, it doubles whenever it is full
+    constexpr size_t kInitialCaptureSize = 16 << 20;
+    // larger frames are treated as corrupt records
+    constexpr int32_t kMaxCaptureDimension = 1 << 15;
+
+    struct Plane
+    {
+        size_t offset;
+        size_t pitch;
+        size_t length;
+        int32_t rows;
+    };
+
+    // Planes of a buffer in |format| with rows |stride| bytes apart, the
+    // lines of a frame in the order they are recorded.
+    int32_t Planes(PixelFormat format, int32_t width, int32_t height, int32_t stride, Plane *planes)
+    {
+        size_t packed = static_cast<size_t>(PackedStride(format, width));
+        size_t luma = static_cast<size_t>(stride) * height;
+        int32_t chroma_rows = (height + 1) / 2;
+        planes[0] = {0, static_cast<size_t>(stride), packed, height};
+        switch (format)
+        {
+        case PixelFormat::kNV12:
+            planes[1] = {luma, static_cast<size_t>(stride), packed, chroma_rows};
+            return 2;
+        case PixelFormat::kI420:
+        {
+            size_t chroma_pitch = (static_cast<size_t>(stride) + 1) / 2;
+            size_t chroma_length = (packed + 1) / 2;
+            planes[1] = {luma, chroma_pitch, chroma_length, chroma_rows};
+            planes[2] = {luma + chroma_pitch * chroma_rows, chroma_pitch, chroma_length, chroma_rows};
+            return 3;
+        }
+        default:
+            return 1;
+        }
+    }
+
+    inline size_t AlignRecord(size_t size)
+    {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    inline void WriteOp(uint8_t *at, uint32_t lines, bool unchanged)
+    {
+        uint32_t op = lines | (unchanged ? kCaptureUnchangedLines : 0);
+        std::memcpy(at, &op, sizeof(op));
+    }
+}
+
+// static
+std::unique_ptr<CaptureRecorder> CaptureRecorder::Create(const std::string &path)
+{
+    std::unique_ptr<MappedFile> file = MappedFile::Create(path, kInitialCaptureSize);
+    if (file == nullptr)
+        return nullptr;
+    std::unique_ptr<CaptureRecorder> recorder(new CaptureRecorder());
+    recorder->file_ = std::move(file);
+    recorder->end_ = sizeof(CaptureFileHeader);
+    CaptureFileHeader *header = recorder->header();
+    std::memcpy(header->magic, kCaptureMagic, sizeof(kCaptureMagic));
+    header->version = kCaptureVersion;
+    header->header_size = sizeof(CaptureFileHeader);
+    header->frame_count = 0;
+    header->data_end = recorder->end_;
+    return recorder;
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+    file_->Resize(end_);
+}
+
+bool CaptureRecorder::Reserve(size_t bytes)
+{
+    if (end_ + bytes <= file_->size())
+        return true;
+    return file_->Resize(std::max(end_ + bytes, file_->size() * 2));
+}
+
+bool CaptureRecorder::Record(const uint8_t *buffer, int32_t width, int32_t height, int32_t stride,
+                             PixelFormat format, int64_t timestamp)
+{
+    if (failed_)
+        return false;
+    if (stride == 0)
+        stride = PackedStride(format, width);
+    Plane planes[3];
+    int32_t plane_count = Planes(format, width, height, stride, planes);
+    size_t packed_size = SourceBytes(format, PackedStride(format, width), height);
+    size_t lines = 0;
+    for (int32_t i = 0; i < plane_count; i++)
+        lines += planes[i].rows;
+    // worst case every other line changed
+    if (!Reserve(sizeof(CaptureRecordHeader) + lines * sizeof(uint32_t) + packed_size + 8))
+    {
+        failed_ = true;
+        return false;
+    }
+
+    bool key = frame_count_ == 0 || width != previous_width_ || height != previous_height_ ||
+               format != previous_format_;
+    if (key)
+        previous_.resize(packed_size);
+    if (frame_count_ == 0)
+        first_timestamp_ = timestamp;
+
+    uint8_t *record = file_->data() + end_;
+    uint8_t *body = record + sizeof(CaptureRecordHeader);
+    uint8_t *out = body;
+    uint8_t *op = nullptr;
+    uint32_t op_lines = 0;
+    bool op_unchanged = false;
+    uint8_t *previous = previous_.data();
+    for (int32_t i = 0; i < plane_count; i++)
+    {
+        const Plane &plane = planes[i];
+        for (int32_t row = 0; row < plane.rows; row++, previous += plane.length)
+        {
+            const uint8_t *line = buffer + plane.offset + static_cast<size_t>(row) * plane.pitch;
+            bool unchanged = !key && std::memcmp(line, previous, plane.length) == 0;
+            if (op == nullptr || unchanged != op_unchanged)
+            {
+                if (op != nullptr)
+                    WriteOp(op, op_lines, op_unchanged);
+                op = out;
+                out += sizeof(uint32_t);
+                op_lines = 0;
+                op_unchanged = unchanged;
+            }
+            op_lines++;
+            if (!unchanged)
+            {
+                std::memcpy(out, line, plane.length);
+                std::memcpy(previous, line, plane.length);
+                out += plane.length;
+            }
+        }
+    }
+    if (op != nullptr)
+        WriteOp(op, op_lines, op_unchanged);
+
+    CaptureRecordHeader record_header{};
+    record_header.body_size = static_cast<uint64_t>(out - body);
+    record_header.timestamp = timestamp - first_timestamp_;
+    record_header.width = width;
+    record_header.height = height;
+    record_header.format = static_cast<int32_t>(format);
+    record_header.flags = key ? kCaptureKeyFrame : 0;
+    std::memcpy(record, &record_header, sizeof(record_header));
+
+    end_ += AlignRecord(sizeof(CaptureRecordHeader) + record_header.body_size);
+    frame_count_++;
+    previous_width_ = width;
+    previous_height_ = height;
+    previous_format_ = format;
+    header()->frame_count = frame_count_;
+    header()->data_end = end_;
+    return true;
+}
+
+// static
+std::unique_ptr<CaptureReader> CaptureReader::Open(const std::string &path)
+{
+    std::unique_ptr<MappedFile> file = MappedFile::Open(path);
+    if (file == nullptr || file->size() < sizeof(CaptureFileHeader))
+        return nullptr;
+    CaptureFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, kCaptureMagic, sizeof(kCaptureMagic)) != 0 || header.version != kCaptureVersion ||
+        header.header_size < sizeof(CaptureFileHeader) || header.header_size > file->size())
+        return nullptr;
+
+    std::unique_ptr<CaptureReader> reader(new CaptureReader());
+    reader->data_end_ = static_cast<size_t>(std::min<uint64_t>(header.data_end, file->size()));
+    reader->frame_count_ = header.frame_count;
+    reader->file_ = std::move(file);
+    reader->Rewind();
+    return reader;
+}
+
+void CaptureReader::Rewind()
+{
+    offset_ = reinterpret_cast<const CaptureFileHeader *>(file_->data())->header_size;
+    pixels_.clear();
+    width_ = 0;
+    height_ = 0;
+}
+
+bool CaptureReader::Next(CaptureFrame *frame)
+{
+    if (offset_ >= data_end_ || data_end_ - offset_ < sizeof(CaptureRecordHeader))
+        return false;
+    CaptureRecordHeader header;
+    std::memcpy(&header, file_->data() + offset_, sizeof(header));
+    size_t available = data_end_ - offset_ - sizeof(header);
+    if (!IsValidPixelFormat(header.format) || header.width <= 0 || header.height <= 0 ||
+        header.width > kMaxCaptureDimension || header.height > kMaxCaptureDimension ||
+        header.body_size > available)
+        return false;
+    PixelFormat format = static_cast<PixelFormat>(header.format);
+    bool key = (header.flags & kCaptureKeyFrame) != 0;
+    if (!key && (pixels_.empty() || header.width != width_ || header.height != height_ || format != format_))
+        return false;
+
+    int32_t stride = PackedStride(format, header.width);
+    Plane planes[3];
+    int32_t plane_count = Planes(format, header.width, header.height, stride, planes);
+    if (key)
+        pixels_.resize(SourceBytes(format, stride, header.height));
+
+    const uint8_t *body = file_->data() + offset_ + sizeof(header);
+    const uint8_t *end = body + header.body_size;
+    uint8_t *dst = pixels_.data();
+    uint32_t run = 0;
+    bool unchanged = false;
+    for (int32_t i = 0; i < plane_count; i++)
+    {
+        const Plane &plane = planes[i];
+        for (int32_t row = 0; row < plane.rows; row++, dst += plane.length)
+        {
+            if (run == 0)
+            {
+                uint32_t op;
+                if (end - body < static_cast<ptrdiff_t>(sizeof(op)))
+                    return false;
+                std::memcpy(&op, body, sizeof(op));
+                body += sizeof(op);
+                run = op & ~kCaptureUnchangedLines;
+                unchanged = (op & kCaptureUnchangedLines) != 0;
+                if (run == 0 || (unchanged && key))
+                    return false;
+            }
+            run--;
+            if (unchanged)
+                continue;
+            if (static_cast<size_t>(end - body) < plane.length)
+                return false;
+            std::memcpy(dst, body, plane.length);
+            body += plane.length;
+        }
+    }
+    if (run != 0 || body != end)
+        return false;
+
+    offset_ += AlignRecord(sizeof(header) + header.body_size);
+    width_ = header.width;
+    height_ = header.height;
+    format_ = format;
+    frame->pixels = pixels_.data();
+    frame->size = pixels_.size();
+    frame->width = header.width;
+    frame->height = header.height;
+    frame->format = format;
+    frame->timestamp = header.timestamp;
+    return true;
+}
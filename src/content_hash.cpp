@@ -0,0 +1,154 @@
+#include "include/texture_interface/content_hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint64_t kPrime32_1 = 0x9E3779B1u;
+    constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+
+    struct Secret
+    {
+        uint64_t words[kHashSecretWords];
+    };
+
+    // splitmix64 of the word index, fixed at compile time
+    constexpr Secret MakeSecret()
+    {
+        Secret secret{};
+        uint64_t state = 0;
+        for (size_t i = 0; i < kHashSecretWords; i++)
+        {
+            state += 0x9E3779B97F4A7C15ull;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            secret.words[i] = z ^ (z >> 31);
+        }
+        return secret;
+    }
+
+    constexpr Secret kSecret = MakeSecret();
+
+    const HashKernels kScalarKernels = {
+        ScalarAccumulateStripes,
+        ScalarScramble,
+    };
+
+    HashKernels Merge(const HashKernels &base, const HashKernels *tier)
+    {
+        if (tier == nullptr)
+            return base;
+        return {
+            tier->accumulate != nullptr ? tier->accumulate : base.accumulate,
+            tier->scramble != nullptr ? tier->scramble : base.scramble,
+        };
+    }
+
+    inline uint64_t Avalanche(uint64_t h)
+    {
+        h ^= h >> 37;
+        h *= 0x165667919E3779F9ull;
+        return h ^ (h >> 32);
+    }
+
+    inline uint64_t RotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Mixes the |size| bytes of a block, of which only the last may be
+    // shorter than kHashBlock, into |acc| and scrambles it.
+    void HashBlock(uint64_t *acc, const uint8_t *data, size_t size, const HashKernels &kernels)
+    {
+        size_t stripes = size / kHashStripe;
+        kernels.accumulate(acc, data, stripes, kSecret.words);
+        size_t tail = size % kHashStripe;
+        if (tail > 0)
+        {
+            // zero padded, the length is mixed in at the end
+            uint8_t last[kHashStripe] = {};
+            std::memcpy(last, data + stripes * kHashStripe, tail);
+            kernels.accumulate(acc, last, 1, kSecret.words + stripes);
+        }
+        kernels.scramble(acc, kSecret.words + kHashSecretWords - 8);
+    }
+}
+
+void ScalarAccumulateStripes(uint64_t *acc, const uint8_t *data, size_t stripes, const uint64_t *secret)
+{
+    for (size_t s = 0; s < stripes; s++, data += kHashStripe)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            uint64_t value;
+            std::memcpy(&value, data + i * 8, sizeof(value));
+            uint64_t keyed = value ^ secret[s + i];
+            acc[i ^ 1] += value;
+            acc[i] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+        }
+    }
+}
+
+void ScalarScramble(uint64_t *acc, const uint64_t *secret)
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= secret[i];
+        acc[i] = value * kPrime32_1;
+    }
+}
+
+const HashKernels &HashKernelsFor(SimdTier tier)
+{
+    static const HashKernels sse2 = Merge(kScalarKernels, Sse2HashKernels());
+    static const HashKernels avx2 = Merge(sse2, Avx2HashKernels());
+    switch (tier)
+    {
+    case SimdTier::kAvx2:
+        return avx2;
+    case SimdTier::kSse2:
+        return sse2;
+    case SimdTier::kScalar:
+        break;
+    }
+    return kScalarKernels;
+}
+
+const HashKernels &ActiveHashKernels()
+{
+    static const HashKernels &kernels = HashKernelsFor(DetectSimdTier());
+    return kernels;
+}
+
+uint64_t HashContent(const uint8_t *data, size_t size, size_t sample_step, const HashKernels &kernels)
+{
+    alignas(32) uint64_t acc[8] = {kPrime32_1, kPrime64_1, kPrime64_2, kPrime64_4,
+                                   kPrime64_1 ^ kPrime64_2, kPrime64_2 ^ kPrime64_4, kPrime32_1 ^ kPrime64_1,
+                                   kPrime64_4 ^ kPrime32_1};
+    if (sample_step == 0)
+        sample_step = 1;
+    size_t blocks = (size + kHashBlock - 1) / kHashBlock;
+    size_t block = 0;
+    for (; block < blocks; block += sample_step)
+    {
+        size_t offset = block * kHashBlock;
+        HashBlock(acc, data + offset, std::min(kHashBlock, size - offset), kernels);
+    }
+    // the last block is always read, unless the stride ended on it
+    if (blocks > 0 && block - sample_step != blocks - 1)
+    {
+        size_t offset = (blocks - 1) * kHashBlock;
+        HashBlock(acc, data + offset, size - offset, kernels);
+    }
+
+    uint64_t h = static_cast<uint64_t>(size) * kPrime64_1 + sample_step;
+    for (size_t i = 0; i < 8; i++)
+        h = RotateLeft(h ^ Avalanche(acc[i] ^ kSecret.words[i]), 27) * kPrime64_1 + kPrime64_4;
+    return Avalanche(h);
+}
@@ -0,0 +1,66 @@
+#include "include/texture_interface/content_hash.h"
+
+// Built with AVX2 code generation enabled, only called after DetectSimdTier
+// reported AVX2 support.
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace
+{
+    void Avx2AccumulateStripes(uint64_t *acc, const uint8_t *data, size_t stripes, const uint64_t *secret)
+    {
+        __m256i low_sums = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc));
+        __m256i high_sums = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc) + 1);
+        for (size_t s = 0; s < stripes; s++, data += kHashStripe)
+        {
+            __m256i values[2] = {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data) + 1)};
+            __m256i *sums[2] = {&low_sums, &high_sums};
+            for (size_t i = 0; i < 2; i++)
+            {
+                __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(secret + s) + i);
+                __m256i keyed = _mm256_xor_si256(values[i], key);
+                __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+                __m256i swapped = _mm256_shuffle_epi32(values[i], _MM_SHUFFLE(1, 0, 3, 2));
+                *sums[i] = _mm256_add_epi64(*sums[i], _mm256_add_epi64(product, swapped));
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), low_sums);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc) + 1, high_sums);
+    }
+
+    void Avx2Scramble(uint64_t *acc, const uint64_t *secret)
+    {
+        const __m256i prime = _mm256_set1_epi32(static_cast<int>(0x9E3779B1u));
+        for (size_t i = 0; i < 2; i++)
+        {
+            __m256i *lanes = reinterpret_cast<__m256i *>(acc) + i;
+            __m256i value = _mm256_loadu_si256(lanes);
+            value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+            value = _mm256_xor_si256(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(secret) + i));
+            __m256i low = _mm256_mul_epu32(value, prime);
+            __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+            _mm256_storeu_si256(lanes, _mm256_add_epi64(low, _mm256_slli_epi64(high, 32)));
+        }
+    }
+
+    const HashKernels kAvx2Kernels = {
+        Avx2AccumulateStripes,
+        Avx2Scramble,
+    };
+}
+
+const HashKernels *Avx2HashKernels()
+{
+    return &kAvx2Kernels;
+}
+
+#else
+
+const HashKernels *Avx2HashKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include "include/texture_interface/content_hash.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+namespace
+{
+    void Sse2AccumulateStripes(uint64_t *acc, const uint8_t *data, size_t stripes, const uint64_t *secret)
+    {
+        __m128i sums[4];
+        for (size_t i = 0; i < 4; i++)
+            sums[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc) + i);
+        for (size_t s = 0; s < stripes; s++, data += kHashStripe)
+        {
+            for (size_t i = 0; i < 4; i++)
+            {
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data) + i);
+                __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret + s) + i);
+                __m128i keyed = _mm_xor_si128(value, key);
+                // low times high 32 bits of each lane
+                __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+                // the other lane's value, as acc[i ^ 1] += value
+                __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                sums[i] = _mm_add_epi64(sums[i], _mm_add_epi64(product, swapped));
+            }
+        }
+        for (size_t i = 0; i < 4; i++)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(acc) + i, sums[i]);
+    }
+
+    void Sse2Scramble(uint64_t *acc, const uint64_t *secret)
+    {
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(0x9E3779B1u));
+        for (size_t i = 0; i < 4; i++)
+        {
+            __m128i *lanes = reinterpret_cast<__m128i *>(acc) + i;
+            __m128i value = _mm_loadu_si128(lanes);
+            value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+            value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i));
+            // 64 by 32 bit multiply from two 32 by 32 bit ones
+            __m128i low = _mm_mul_epu32(value, prime);
+            __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+            _mm_storeu_si128(lanes, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+        }
+    }
+
+    const HashKernels kSse2Kernels = {
+        Sse2AccumulateStripes,
+        Sse2Scramble,
+    };
+}
+
+const HashKernels *Sse2HashKernels()
+{
+    return &kSse2Kernels;
+}
+
+#else
+
+const HashKernels *Sse2HashKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#include "include/texture_interface/cpu_features.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TI_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+#ifdef TI_X86
+    void Cpuid(int leaf, int subleaf, unsigned int registers[4])
+    {
+#ifdef _MSC_VER
+        int values[4];
+        __cpuidex(values, leaf, subleaf);
+        for (int i = 0; i < 4; i++)
+            registers[i] = static_cast<unsigned int>(values[i]);
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    unsigned long long Xgetbv()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+
+    SimdTier Detect()
+    {
+        unsigned int registers[4];
+        Cpuid(0, 0, registers);
+        unsigned int max_leaf = registers[0];
+
+        Cpuid(1, 0, registers);
+        bool sse2 = (registers[3] & (1u << 26)) != 0;
+        bool osxsave = (registers[2] & (1u << 27)) != 0;
+        bool avx = (registers[2] & (1u << 28)) != 0;
+        if (!sse2)
+            return SimdTier::kScalar;
+
+        // AVX2 also needs the OS to save the ymm registers
+        if (max_leaf >= 7 && osxsave && avx && (Xgetbv() & 0x6) == 0x6)
+        {
+            Cpuid(7, 0, registers);
+            if ((registers[1] & (1u << 5)) != 0)
+                return SimdTier::kAvx2;
+        }
+        return SimdTier::kSse2;
+    }
+#else
+    SimdTier Detect()
+    {
+        return SimdTier::kScalar;
+    }
+#endif
+}
+
+SimdTier DetectSimdTier()
+{
+    static const SimdTier tier = Detect();
+    return tier;
+}
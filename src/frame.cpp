@@ -0,0 +1,1036 @@
+#include "include/texture_interface/frame.h"
+
+#include "include/texture_interface/pixel_convert.h"
+#include "include/texture_interface/pixel_scale.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // how often a bound shared ring is checked for new frames
+    constexpr std::chrono::milliseconds kSharedRingPollInterval(1);
+
+    // what evicted frames show, a single transparent pixel
+    constexpr uint8_t kPlaceholderPixel[4] = {0, 0, 0, 0};
+}
+
+Frame::Frame(TextureBridge *bridge, WorkerPool *workers, MemoryBudget *budget)
+    : pool_(4, budget != nullptr ? budget->resident_total() : nullptr), bridge_(bridge), workers_(workers),
+      budget_(budget)
+{
+    last_active_.store(FrameStats::Now());
+    texture_id_ = bridge_->RegisterTexture(
+        // the size the texture is drawn at does not matter, frames are only
+        // downscaled to what Dart reports
+        [=](size_t, size_t) -> const PixelBuffer *
+        {
+            if (active_ring_.load() != nullptr)
+            {
+                if (const PixelBuffer *shared = FetchSharedRing())
+                    return shared;
+            }
+
+            handoff_.Consume();
+            // the pacer holds a newer source back until this fetch
+            if (sources_.HasPending())
+                WakePacer();
+            Slot &slot = handoff_.front();
+            if (slot.placeholder)
+                return &slot.pixel_buffer;
+            if (slot.buffer == nullptr)
+                return nullptr;
+            return TrackFetch(&slot.pixel_buffer, slot.version, slot.submitted_at, slot.published_at);
+        });
+}
+
+bool Frame::Update(uint8_t *buffer, int32_t width, int32_t height, int32_t stride, PixelFormat format,
+                   bool notify, BufferRelease release)
+{
+    int64_t submitted_at = FrameStats::Now();
+    if (stride == 0)
+        stride = PackedStride(format, width);
+    ContentKey key{false, 0, width, height, stride, format, ImageCodec::kUnknown, 0, 0};
+    if (stride >= PackedStride(format, width) && IsDuplicate(buffer, SourceBytes(format, stride, height), &key))
+    {
+        ReleaseForeign(buffer, release);
+        stats_.RecordSkip();
+        return true;
+    }
+    return PublishUpdate(buffer, width, height, stride, format, submitted_at, notify, release, key);
+}
+
+bool Frame::PublishUpdate(uint8_t *buffer, int32_t width, int32_t height, int32_t stride, PixelFormat format,
+                          int64_t submitted_at, bool notify, BufferRelease release, const ContentKey &key)
+{
+    size_t row_bytes = static_cast<size_t>(width) * 4;
+    if (stride >= PackedStride(format, width))
+        RecordFrame(buffer, width, height, stride, format, submitted_at);
+    int32_t scaled_width, scaled_height;
+    bool scaled = ScaledSize(width, height, &scaled_width, &scaled_height);
+    if (format == PixelFormat::kRGBA && static_cast<size_t>(stride) == row_bytes && !scaled)
+    {
+        stats_.RecordSubmit(row_bytes * height);
+        AddForeignBytes(row_bytes * height);
+        Publish(buffer, width, height, false, submitted_at, notify, false, release, &key);
+        EnforceBudget();
+        return true;
+    }
+    if (stride < PackedStride(format, width))
+        return false;
+    stats_.RecordSubmit(row_bytes * height);
+    if (pacing_mode_.load() == PacingMode::kCoalesce)
+    {
+        PublishSource(buffer, width, height, stride, format, submitted_at, release, key);
+        EnforceBudget();
+        return true;
+    }
+
+    if (scaled)
+    {
+        uint8_t *downscaled = pool_.Acquire(static_cast<size_t>(scaled_width) * scaled_height * 4);
+        if (downscaled == nullptr)
+            return false;
+        ScaleFrame(format, buffer, stride, width, height, downscaled, scaled_width, scaled_height);
+        ReleaseForeign(buffer, release);
+        Publish(downscaled, scaled_width, scaled_height, true, submitted_at, notify, true, {}, &key);
+        EnforceBudget();
+        return true;
+    }
+
+    // the engine only takes packed RGBA, padding and other
+    // formats are converted
+    uint8_t *converted = pool_.Acquire(row_bytes * height);
+    if (converted == nullptr)
+        return false;
+    ConvertFrame(format, buffer, stride, width, height, converted);
+    ReleaseForeign(buffer, release);
+    Publish(converted, width, height, true, submitted_at, notify, false, {}, &key);
+    EnforceBudget();
+    return true;
+}
+
+void Frame::set_display_size(int32_t width, int32_t height)
+{
+    display_width_.store(std::max(width, 0));
+    display_height_.store(std::max(height, 0));
+}
+
+bool Frame::ScaledSize(int32_t width, int32_t height, int32_t *scaled_width, int32_t *scaled_height) const
+{
+    return DownscaledSize(width, height, display_width_.load(), display_height_.load(), scaled_width,
+                          scaled_height);
+}
+
+bool Frame::ReadyForFrame() const
+{
+    return !handoff_.HasPending() && !sources_.HasPending();
+}
+
+void Frame::FlushFrameAvailable()
+{
+    if (notify_pending_.exchange(false))
+        bridge_->MarkTextureFrameAvailable(texture_id_);
+}
+
+uint8_t *Frame::AcquireBuffer(int32_t width, int32_t height)
+{
+    if (width <= 0 || height <= 0)
+        return nullptr;
+    return pool_.Lend(static_cast<size_t>(width) * height * 4);
+}
+
+bool Frame::SubmitBuffer(uint8_t *buffer, int32_t width, int32_t height)
+{
+    if (width <= 0 || height <= 0 || !pool_.Reclaim(buffer, static_cast<size_t>(width) * height * 4))
+        return false;
+    int64_t submitted_at = FrameStats::Now();
+    ContentKey key{false, 0, width, height, width * 4, PixelFormat::kRGBA, ImageCodec::kUnknown, 0, 0};
+    if (IsDuplicate(buffer, static_cast<size_t>(width) * height * 4, &key))
+    {
+        pool_.Release(buffer);
+        stats_.RecordSkip();
+        return true;
+    }
+    PublishPooled(buffer, width, height, submitted_at, true, key);
+    return true;
+}
+
+bool Frame::ReleaseBuffer(uint8_t *buffer)
+{
+    return pool_.Return(buffer);
+}
+
+bool Frame::UpdateEncoded(const uint8_t *data, size_t size, const ImageInfo &info, bool notify)
+{
+    // the decode counts towards the time until the frame is handed over
+    int64_t submitted_at = FrameStats::Now();
+    // resent images are recognized before they are decoded
+    ContentKey key{false, 0, info.width, info.height, 0, PixelFormat::kRGBA, info.codec, 0, 0};
+    if (IsDuplicate(data, size, &key))
+    {
+        stats_.RecordSkip();
+        return true;
+    }
+    uint8_t *buffer = pool_.Acquire(static_cast<size_t>(info.width) * info.height * 4);
+    if (buffer == nullptr)
+        return false;
+    if (!DecodeImage(info, data, size, buffer, workers_))
+    {
+        pool_.Release(buffer);
+        return false;
+    }
+    PublishPooled(buffer, info.width, info.height, submitted_at, notify, key);
+    return true;
+}
+
+void Frame::PublishPooled(uint8_t *buffer, int32_t width, int32_t height, int64_t submitted_at, bool notify,
+                          const ContentKey &key)
+{
+    RecordFrame(buffer, width, height, 0, PixelFormat::kRGBA, submitted_at);
+    stats_.RecordSubmit(static_cast<size_t>(width) * height * 4);
+    int32_t scaled_width, scaled_height;
+    if (ScaledSize(width, height, &scaled_width, &scaled_height))
+    {
+        uint8_t *downscaled = pool_.Acquire(static_cast<size_t>(scaled_width) * scaled_height * 4);
+        if (downscaled != nullptr)
+        {
+            ScaleFrame(PixelFormat::kRGBA, buffer, width * 4, width, height, downscaled, scaled_width,
+                       scaled_height);
+            pool_.Release(buffer);
+            Publish(downscaled, scaled_width, scaled_height, true, submitted_at, notify, true, {}, &key);
+            EnforceBudget();
+            return;
+        }
+    }
+    Publish(buffer, width, height, true, submitted_at, notify, false, {}, &key);
+    EnforceBudget();
+}
+
+bool Frame::UpdateRegion(int32_t x, int32_t y, int32_t width, int32_t height,
+                         const uint8_t *src, int32_t src_stride)
+{
+    FrameRegion region{x, y, width, height, src, src_stride};
+    return UpdateRegions(&region, 1);
+}
+
+bool Frame::UpdateRegions(const FrameRegion *regions, size_t count)
+{
+    int64_t submitted_at = FrameStats::Now();
+    size_t bytes = 0;
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        Slot &slot = handoff_.back();
+        if (latest_scaled_ || !PrepareBackingSlot(slot))
+            return false;
+
+        content_version_++;
+        for (size_t i = 0; i < count; i++)
+        {
+            const FrameRegion &region = regions[i];
+            if (region.src == nullptr)
+                continue;
+            // clip to the frame, moving the source along with the origin
+            int32_t x0 = std::max(region.x, 0);
+            int32_t y0 = std::max(region.y, 0);
+            int32_t x1 = std::min(region.x + region.width, latest_width_);
+            int32_t y1 = std::min(region.y + region.height, latest_height_);
+            if (x0 >= x1 || y0 >= y1)
+                continue;
+            const uint8_t *src = region.src +
+                                 static_cast<ptrdiff_t>(y0 - region.y) * region.src_stride +
+                                 static_cast<ptrdiff_t>(x0 - region.x) * 4;
+            CopyRect(slot.buffer, src, region.src_stride, x0, y0, x1 - x0, y1 - y0);
+            RecordDamage(x0, y0, x1 - x0, y1 - y0);
+            bytes += static_cast<size_t>(x1 - x0) * (y1 - y0) * 4;
+        }
+
+        PublishBackingSlot(slot, submitted_at, bytes);
+    }
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+    EnforceBudget();
+    return true;
+}
+
+bool Frame::UpdateDelta(const uint8_t *data, size_t size, const FrameDeltaInfo &info)
+{
+    int64_t submitted_at = FrameStats::Now();
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        if (info.width != latest_width_ || info.height != latest_height_ || latest_scaled_)
+            return false;
+        // before the back slot is brought up to date, which may copy the
+        // whole frame
+        if (info.changed_pixels == 0 && duplicate_check_.load() != DuplicateCheck::kOff)
+        {
+            stats_.RecordSkip();
+            return true;
+        }
+        Slot &slot = handoff_.back();
+        if (!PrepareBackingSlot(slot))
+            return false;
+        if (!ApplyFrameDelta(data, size, slot.buffer))
+        {
+            // partly applied, the slot is copied in full next time
+            slot.version = 0;
+            return false;
+        }
+
+        content_version_++;
+        for (size_t i = 0; i < info.band_count; i++)
+        {
+            const DeltaBand &band = info.bands[i];
+            RecordDamage(band.x, band.y, band.width, band.height);
+        }
+        PublishBackingSlot(slot, submitted_at, static_cast<size_t>(info.changed_pixels) * 4);
+    }
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+    EnforceBudget();
+    return true;
+}
+
+bool Frame::IsDuplicate(const uint8_t *data, size_t size, ContentKey *key)
+{
+    DuplicateCheck check = duplicate_check_.load();
+    if (check == DuplicateCheck::kOff)
+        return false;
+    key->checked = true;
+    key->hash = HashContent(data, size, check == DuplicateCheck::kSampled ? kDuplicateSampleStep : 1);
+    key->display_width = display_width_.load();
+    key->display_height = display_height_.load();
+
+    const std::lock_guard<std::mutex> lock(producer_mutex_);
+    // anything published since, a region update or an eviction for
+    // example, changed what is shown
+    const ContentKey &shown = shown_content_;
+    return shown.checked && shown_content_version_ == content_version_ && shown.hash == key->hash &&
+           shown.width == key->width && shown.height == key->height && shown.stride == key->stride &&
+           shown.format == key->format && shown.codec == key->codec &&
+           shown.display_width == key->display_width && shown.display_height == key->display_height;
+}
+
+// Called with producer_mutex_ held, right after content_version_ was bumped
+// for the content of |key|, so that no other publish can come in between.
+void Frame::RememberContent(const ContentKey *key)
+{
+    if (key == nullptr || !key->checked)
+        return;
+    shown_content_ = *key;
+    shown_content_version_ = content_version_;
+}
+
+// Publishes the back slot once PrepareBackingSlot brought it up to date and
+// the changes were drawn onto it, with the producer lock held.
+void Frame::PublishBackingSlot(Slot &slot, int64_t submitted_at, size_t bytes)
+{
+    // recorded as the whole frame, unchanged rows cost next to nothing
+    RecordFrame(slot.buffer, latest_width_, latest_height_, 0, PixelFormat::kRGBA, submitted_at);
+    slot.version = content_version_;
+    slot.submitted_at = submitted_at;
+    slot.published_at = FrameStats::Now();
+    stats_.RecordSubmit(bytes);
+    stats_.RecordTake(submitted_at, slot.published_at);
+    latest_buffer_ = slot.buffer;
+    latest_stride_ = latest_width_ * 4;
+    latest_format_ = PixelFormat::kRGBA;
+    last_active_.store(slot.published_at, std::memory_order_relaxed);
+    handoff_.Publish();
+}
+
+void Frame::Publish(uint8_t *buffer, int32_t width, int32_t height, bool pooled, int64_t submitted_at,
+                    bool notify, bool scaled, BufferRelease release, const ContentKey *key)
+{
+    bool superseded;
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        Slot &slot = handoff_.back();
+        // the back slot holds either a frame that was never consumed or the
+        // one the raster thread swapped out on its last fetch, both are free
+        if (slot.buffer != buffer)
+            Recycle(slot);
+        slot.buffer = buffer;
+        slot.pixel_buffer.buffer = buffer;
+        slot.pixel_buffer.width = width;
+        slot.pixel_buffer.height = height;
+        slot.pooled = pooled;
+        slot.release = release;
+        slot.placeholder = false;
+
+        // a full frame invalidates every other slot
+        content_version_++;
+        RememberContent(key);
+        slot.version = content_version_;
+        slot.submitted_at = submitted_at;
+        slot.published_at = FrameStats::Now();
+        stats_.RecordTake(submitted_at, slot.published_at);
+        damage_floor_ = content_version_;
+        damage_count_ = 0;
+        latest_buffer_ = buffer;
+        latest_width_ = width;
+        latest_height_ = height;
+        latest_stride_ = width * 4;
+        latest_format_ = PixelFormat::kRGBA;
+        latest_scaled_ = scaled;
+        last_active_.store(slot.published_at, std::memory_order_relaxed);
+        evicted_.store(false);
+        superseded = handoff_.Publish();
+    }
+    if (superseded)
+    {
+        stats_.RecordDrop();
+        // the engine was notified about the frame this one replaced and has
+        // not fetched it yet
+        if (pacing_mode_.load() == PacingMode::kCoalesce)
+            return;
+    }
+    NotifyFrameAvailable(notify);
+}
+
+void Frame::PublishSource(uint8_t *buffer, int32_t width, int32_t height, int32_t stride,
+                          PixelFormat format, int64_t submitted_at, BufferRelease release, const ContentKey &key)
+{
+    bool superseded;
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        content_version_++;
+        RememberContent(&key);
+        int64_t published_at = FrameStats::Now();
+        size_t size = SourceBytes(format, stride, height);
+        AddForeignBytes(size);
+        sources_.back() = {buffer, width, height, stride, format, size, release, content_version_, submitted_at,
+                           published_at};
+        stats_.RecordTake(submitted_at, published_at);
+        damage_floor_ = content_version_;
+        damage_count_ = 0;
+        latest_buffer_ = buffer;
+        latest_width_ = width;
+        latest_height_ = height;
+        latest_stride_ = stride;
+        latest_format_ = format;
+        latest_scaled_ = false;
+        last_active_.store(published_at, std::memory_order_relaxed);
+        evicted_.store(false);
+        superseded = sources_.Publish();
+
+        // the new back slot was either never fetched or already converted
+        FreeSource(sources_.back());
+    }
+    if (superseded)
+        stats_.RecordDrop();
+    WakePacer();
+}
+
+void Frame::NotifyFrameAvailable(bool notify)
+{
+    if (!notify)
+    {
+        notify_pending_.store(true);
+        return;
+    }
+    notify_pending_.store(false);
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+}
+
+void Frame::set_pacing_mode(PacingMode mode)
+{
+    if (mode == PacingMode::kCoalesce)
+        StartPacer();
+    pacing_mode_.store(mode);
+}
+
+void Frame::StartPacer()
+{
+    const std::lock_guard<std::mutex> lock(pacer_mutex_);
+    if (pacer_.joinable())
+        return;
+    pacer_stopping_.store(false);
+    pacer_ = std::thread(&Frame::Pace, this);
+}
+
+void Frame::StopPacer()
+{
+    const std::lock_guard<std::mutex> lock(pacer_mutex_);
+    if (!pacer_.joinable())
+        return;
+    pacer_stopping_.store(true);
+    pacer_wake_.Post();
+    pacer_.join();
+}
+
+// Takes no lock, the raster thread calls it from the fetch.
+void Frame::WakePacer()
+{
+    // one post is enough until the pacer looked at the buffers again
+    if (!pacer_woken_.exchange(true))
+        pacer_wake_.Post();
+}
+
+void Frame::Pace()
+{
+    while (true)
+    {
+        pacer_wake_.Wait();
+        // cleared before the buffers are checked, whatever changes after
+        // this posts again
+        pacer_woken_.store(false);
+        if (pacer_stopping_.load())
+            return;
+        // a converted frame the raster thread has not fetched yet is not
+        // replaced, newer sources wait for the fetch and only the newest
+        // of them is converted
+        if (sources_.HasPending() && !handoff_.HasPending())
+            ConvertSource();
+    }
+}
+
+// Pacer thread: converts the newest source into a pooled buffer and
+// publishes it, unless newer content was published meanwhile.
+void Frame::ConvertSource()
+{
+    sources_.Consume();
+    const Source &source = sources_.front();
+    if (source.buffer == nullptr)
+        return;
+
+    int32_t width = source.width;
+    int32_t height = source.height;
+    bool scaled = ScaledSize(source.width, source.height, &width, &height);
+    uint8_t *buffer = pool_.Acquire(static_cast<size_t>(width) * height * 4);
+    if (buffer == nullptr)
+        return;
+    if (scaled)
+        ScaleFrame(source.format, source.buffer, source.stride, source.width, source.height, buffer, width,
+                   height);
+    else
+        ConvertFrame(source.format, source.buffer, source.stride, source.width, source.height, buffer);
+
+    bool superseded;
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        if (source.version != content_version_)
+        {
+            pool_.Release(buffer);
+            return;
+        }
+        Slot &slot = handoff_.back();
+        Recycle(slot);
+        slot.buffer = buffer;
+        slot.pixel_buffer.buffer = buffer;
+        slot.pixel_buffer.width = width;
+        slot.pixel_buffer.height = height;
+        slot.pooled = true;
+        slot.release = {};
+        slot.placeholder = false;
+        slot.version = source.version;
+        slot.submitted_at = source.submitted_at;
+        slot.published_at = source.published_at;
+        superseded = handoff_.Publish();
+    }
+    if (superseded)
+    {
+        stats_.RecordDrop();
+        return;
+    }
+    // a batch has flushed its notifications long before the frame gets
+    // here, every converted frame is announced on its own
+    NotifyFrameAvailable(true);
+}
+
+// Makes |slot| a pooled copy of the newest content, copying only what
+// changed since it was last published where possible.
+bool Frame::PrepareBackingSlot(Slot &slot)
+{
+    if (latest_buffer_ == nullptr)
+        return false;
+
+    bool reusable = slot.buffer != nullptr && slot.pooled &&
+                    slot.pixel_buffer.width == static_cast<size_t>(latest_width_) &&
+                    slot.pixel_buffer.height == static_cast<size_t>(latest_height_);
+    if (!reusable)
+    {
+        uint8_t *buffer = pool_.Acquire(static_cast<size_t>(latest_width_) * latest_height_ * 4);
+        if (buffer == nullptr)
+            return false;
+        Recycle(slot);
+        slot.buffer = buffer;
+        slot.pixel_buffer.buffer = buffer;
+        slot.pixel_buffer.width = latest_width_;
+        slot.pixel_buffer.height = latest_height_;
+        slot.pooled = true;
+        slot.placeholder = false;
+        slot.version = 0;
+    }
+
+    if (slot.version >= damage_floor_)
+    {
+        for (size_t i = 0; i < damage_count_; i++)
+        {
+            const Damage &damage = damage_[(damage_head_ + kDamageHistory - damage_count_ + i) % kDamageHistory];
+            if (damage.version <= slot.version)
+                continue;
+            const uint8_t *src = latest_buffer_ +
+                                 (static_cast<size_t>(damage.y) * latest_width_ + damage.x) * 4;
+            CopyRect(slot.buffer, src, latest_width_ * 4, damage.x, damage.y, damage.width, damage.height);
+        }
+    }
+    else
+    {
+        ConvertFrame(latest_format_, latest_buffer_, latest_stride_, latest_width_, latest_height_,
+                     slot.buffer);
+    }
+    return true;
+}
+
+// Converts a whole frame into packed RGBA, in row bands on the worker pool
+// if there is one and the frame is large enough.
+void Frame::ConvertFrame(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                         int32_t width, int32_t height, uint8_t *dst) const
+{
+    const ConvertKernels &kernels = ActiveConvertKernels();
+    if (workers_ == nullptr)
+    {
+        ConvertRows(format, src, src_stride, width, height, dst, 0, height, kernels);
+        return;
+    }
+    workers_->ParallelFor(height, static_cast<size_t>(width) * height * 4,
+                          [&](int32_t begin, int32_t end)
+                          { ConvertRows(format, src, src_stride, width, height, dst, begin, end, kernels); });
+}
+
+// Like ConvertFrame, downscaling to |dst_width| x |dst_height| on the way.
+// Bands are split by destination rows, the threshold applies to the source.
+void Frame::ScaleFrame(PixelFormat format, const uint8_t *src, int32_t src_stride, int32_t width,
+                       int32_t height, uint8_t *dst, int32_t dst_width, int32_t dst_height) const
+{
+    if (workers_ == nullptr)
+    {
+        ScaleRows(format, src, src_stride, width, height, dst, dst_width, dst_height, 0, dst_height);
+        return;
+    }
+    workers_->ParallelFor(dst_height, static_cast<size_t>(width) * height * 4,
+                          [&](int32_t begin, int32_t end)
+                          { ScaleRows(format, src, src_stride, width, height, dst, dst_width, dst_height, begin, end); });
+}
+
+// Raster thread: stamps a fetch of |pixel_buffer| so that its release can be
+// timed. Only the first fetch of new content counts as a displayed frame.
+PixelBuffer *Frame::TrackFetch(PixelBuffer *pixel_buffer, uint64_t version,
+                                             int64_t submitted_at, int64_t published_at)
+{
+    int64_t now = FrameStats::Now();
+    bool fresh = version != fetched_version_;
+    if (fresh)
+        stats_.RecordFetch(published_at, now);
+    fetched_version_ = version;
+    fetched_at_ = now;
+    fetched_submitted_at_ = fresh ? submitted_at : 0;
+    last_active_.store(now, std::memory_order_relaxed);
+    pixel_buffer->release_callback = &Frame::OnPixelBufferRelease;
+    pixel_buffer->release_context = this;
+    return pixel_buffer;
+}
+
+// static
+void Frame::OnPixelBufferRelease(void *release_context)
+{
+    Frame *frame = static_cast<Frame *>(release_context);
+    frame->stats_.RecordRelease(frame->fetched_submitted_at_, frame->fetched_at_, FrameStats::Now());
+}
+
+void Frame::CopyRect(uint8_t *dst, const uint8_t *src, int32_t src_stride,
+                     int32_t x, int32_t y, int32_t width, int32_t height) const
+{
+    size_t dst_stride = static_cast<size_t>(latest_width_) * 4;
+    CopyRows(dst + y * dst_stride + static_cast<size_t>(x) * 4, dst_stride,
+             src, src_stride, static_cast<size_t>(width) * 4, height);
+}
+
+// static
+void Frame::CopyRows(uint8_t *dst, size_t dst_stride, const uint8_t *src, ptrdiff_t src_stride,
+                     size_t row_bytes, int32_t rows)
+{
+    if (row_bytes == dst_stride && src_stride == static_cast<ptrdiff_t>(dst_stride))
+    {
+        std::memcpy(dst, src, row_bytes * rows);
+        return;
+    }
+    for (int32_t row = 0; row < rows; row++)
+        std::memcpy(dst + row * dst_stride, src + row * src_stride, row_bytes);
+}
+
+void Frame::RecordDamage(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    if (damage_count_ == kDamageHistory)
+    {
+        // the oldest entry falls out of the history, slots older than it
+        // have to be copied in full
+        const Damage &oldest = damage_[damage_head_];
+        damage_floor_ = std::max(damage_floor_, oldest.version);
+        damage_count_--;
+    }
+    damage_[damage_head_] = {content_version_, x, y, width, height};
+    damage_head_ = (damage_head_ + 1) % kDamageHistory;
+    damage_count_++;
+}
+
+// Gives the buffer of |slot| back to the pool, or to the caller if it came
+// from there.
+void Frame::Recycle(Slot &slot)
+{
+    if (slot.buffer != nullptr && !pool_.Release(slot.buffer))
+    {
+        RemoveForeignBytes(slot.pixel_buffer.width * slot.pixel_buffer.height * 4);
+        ReleaseForeign(slot.buffer, slot.release);
+    }
+    slot.buffer = nullptr;
+}
+
+void Frame::FreeSource(Source &source)
+{
+    if (source.buffer != nullptr)
+    {
+        RemoveForeignBytes(source.size);
+        ReleaseForeign(source.buffer, source.release);
+    }
+    source.buffer = nullptr;
+}
+
+void Frame::AddForeignBytes(size_t bytes)
+{
+    foreign_bytes_.fetch_add(bytes);
+    if (budget_ != nullptr)
+        budget_->resident_total()->fetch_add(bytes);
+}
+
+void Frame::RemoveForeignBytes(size_t bytes)
+{
+    foreign_bytes_.fetch_sub(bytes);
+    if (budget_ != nullptr)
+        budget_->resident_total()->fetch_sub(bytes);
+}
+
+void Frame::ReleaseForeign(uint8_t *buffer, const BufferRelease &release)
+{
+    if (release.callback != nullptr)
+        release.callback(release.context, buffer);
+    else
+        bridge_->FreeBuffer(buffer);
+}
+
+size_t Frame::Evict()
+{
+    size_t before = resident_bytes();
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        if (evicted_.load() || latest_buffer_ == nullptr || active_ring_.load() != nullptr)
+            return 0;
+
+        content_version_++;
+        damage_floor_ = content_version_;
+        damage_count_ = 0;
+        latest_buffer_ = nullptr;
+        latest_width_ = 0;
+        latest_height_ = 0;
+        latest_stride_ = 0;
+        latest_format_ = PixelFormat::kRGBA;
+        latest_scaled_ = false;
+        PublishPlaceholder();
+        evicted_.store(true);
+        eviction_settled_ = false;
+    }
+    pool_.Trim();
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+    size_t after = resident_bytes();
+    return before > after ? before - after : 0;
+}
+
+void Frame::Trim()
+{
+    bool notify = false;
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        // once the raster thread fetched the placeholder, the slot and
+        // source it held before come back with the next publish
+        if (evicted_.load() && !eviction_settled_ && !handoff_.HasPending() && !sources_.HasPending())
+        {
+            PublishPlaceholder();
+            eviction_settled_ = true;
+            notify = true;
+        }
+    }
+    pool_.Trim();
+    if (notify)
+        bridge_->MarkTextureFrameAvailable(texture_id_);
+}
+
+// Publishes the placeholder as the newest slot and an empty source, and frees
+// whatever the producer gets back. Called with producer_mutex_ held.
+void Frame::PublishPlaceholder()
+{
+    Slot &slot = handoff_.back();
+    Recycle(slot);
+    slot.pixel_buffer = {kPlaceholderPixel, 1, 1, nullptr, nullptr};
+    slot.pooled = false;
+    slot.placeholder = true;
+    slot.version = content_version_;
+    handoff_.Publish();
+    // the new back slot is free, the raster thread swapped it out or never
+    // saw it
+    Recycle(handoff_.back());
+
+    FreeSource(sources_.back());
+    sources_.Publish();
+    FreeSource(sources_.back());
+}
+
+void Frame::EnforceBudget()
+{
+    if (budget_ != nullptr)
+        budget_->Enforce(this);
+}
+
+bool Frame::BindSharedRing(const std::string &name)
+{
+    UnbindSharedRing();
+
+    std::unique_ptr<SharedMemory> memory = SharedMemory::Open(name);
+    if (memory == nullptr)
+        return false;
+    std::unique_ptr<SharedFrameRing> ring = SharedFrameRing::Attach(memory->data(), memory->size());
+    if (ring == nullptr)
+        return false;
+
+    const std::lock_guard<std::mutex> lock(producer_mutex_);
+    ReleaseRetiredRings();
+    shared_memory_ = std::move(memory);
+    shared_ring_ = std::move(ring);
+    active_ring_.store(shared_ring_.get());
+    watching_ring_.store(true);
+    ring_watcher_ = std::thread(&Frame::WatchSharedRing, this, shared_ring_.get());
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+    return true;
+}
+
+void Frame::UnbindSharedRing()
+{
+    const std::lock_guard<std::mutex> lock(producer_mutex_);
+    if (shared_ring_ == nullptr)
+        return;
+
+    active_ring_.store(nullptr);
+    watching_ring_.store(false);
+    if (ring_watcher_.joinable())
+        ring_watcher_.join();
+    // the raster thread might still be uploading a slot, and some embedders
+    // only release it on their next fetch
+    retired_rings_.push_back({std::move(shared_memory_), std::move(shared_ring_)});
+    ReleaseRetiredRings();
+    // show the last submitted frame again
+    bridge_->MarkTextureFrameAvailable(texture_id_);
+}
+
+// Unmaps rings that were unbound once no fetch of them is outstanding.
+// Called with producer_mutex_ held.
+void Frame::ReleaseRetiredRings()
+{
+    if (ring_readers_.load() != 0)
+        return;
+    for (RetiredRing &retired : retired_rings_)
+        retired.ring->Unpin();
+    retired_rings_.clear();
+}
+
+int32_t Frame::shared_ring_width() const
+{
+    SharedFrameRing *ring = active_ring_.load();
+    return ring != nullptr ? ring->width() : 0;
+}
+
+int32_t Frame::shared_ring_height() const
+{
+    SharedFrameRing *ring = active_ring_.load();
+    return ring != nullptr ? ring->height() : 0;
+}
+
+const PixelBuffer *Frame::FetchSharedRing()
+{
+    SharedFrameRing *ring = active_ring_.load();
+    ring_readers_.fetch_add(1);
+    // UnbindSharedRing clears active_ring_ before it waits for readers, so
+    // the ring is only touched if it is still mapped
+    if (ring == nullptr || active_ring_.load() != ring)
+    {
+        ring_readers_.fetch_sub(1);
+        return nullptr;
+    }
+
+    int32_t width = 0;
+    int32_t height = 0;
+    const uint8_t *pixels = ring->AcquireLatest(&width, &height);
+    if (pixels == nullptr)
+    {
+        ring_readers_.fetch_sub(1);
+        return nullptr;
+    }
+    ring_pixel_buffer_.buffer = pixels;
+    ring_pixel_buffer_.width = width;
+    ring_pixel_buffer_.height = height;
+    ring_pixel_buffer_.release_callback = &Frame::OnSharedRingRelease;
+    ring_pixel_buffer_.release_context = this;
+    return &ring_pixel_buffer_;
+}
+
+// static
+void Frame::OnSharedRingRelease(void *release_context)
+{
+    static_cast<Frame *>(release_context)->ring_readers_.fetch_sub(1);
+}
+
+void Frame::WatchSharedRing(SharedFrameRing *ring)
+{
+    uint64_t seen = ring->latest_sequence();
+    while (watching_ring_.load())
+    {
+        uint64_t sequence = ring->latest_sequence();
+        if (sequence != seen)
+        {
+            seen = sequence;
+            bridge_->MarkTextureFrameAvailable(texture_id_);
+        }
+        std::this_thread::sleep_for(kSharedRingPollInterval);
+    }
+}
+
+bool Frame::StartRecording(const std::string &path)
+{
+    std::unique_ptr<CaptureRecorder> recorder = CaptureRecorder::Create(path);
+    if (recorder == nullptr)
+        return false;
+    const std::lock_guard<std::mutex> lock(recorder_mutex_);
+    recorder_ = std::move(recorder);
+    recording_.store(true);
+    return true;
+}
+
+uint64_t Frame::StopRecording()
+{
+    const std::lock_guard<std::mutex> lock(recorder_mutex_);
+    recording_.store(false);
+    uint64_t frames = recorder_ != nullptr ? recorder_->frame_count() : 0;
+    recorder_.reset();
+    return frames;
+}
+
+void Frame::RecordFrame(const uint8_t *buffer, int32_t width, int32_t height, int32_t stride,
+                        PixelFormat format, int64_t submitted_at)
+{
+    if (!recording_.load(std::memory_order_relaxed))
+        return;
+    const std::lock_guard<std::mutex> lock(recorder_mutex_);
+    if (recorder_ != nullptr)
+        recorder_->Record(buffer, width, height, stride, format, submitted_at);
+}
+
+bool Frame::StartReplay(const std::string &path, double speed, bool loop)
+{
+    StopReplay();
+    std::unique_ptr<CaptureReader> reader = CaptureReader::Open(path);
+    CaptureFrame first;
+    if (reader == nullptr || !(speed >= 0) || !reader->Next(&first))
+        return false;
+    reader->Rewind();
+    replay_width_.store(first.width);
+    replay_height_.store(first.height);
+    replay_stopping_ = false;
+    replayer_ = std::thread(&Frame::Replay, this, std::move(reader), speed, loop);
+    return true;
+}
+
+void Frame::StopReplay()
+{
+    {
+        const std::lock_guard<std::mutex> lock(replay_mutex_);
+        replay_stopping_ = true;
+    }
+    replay_stop_.notify_all();
+    if (replayer_.joinable())
+        replayer_.join();
+}
+
+void Frame::Replay(std::unique_ptr<CaptureReader> reader, double speed, bool loop)
+{
+    std::unique_lock<std::mutex> lock(replay_mutex_);
+    bool replayed = true;
+    while (replayed && !replay_stopping_)
+    {
+        replayed = false;
+        auto started = std::chrono::steady_clock::now();
+        CaptureFrame frame;
+        while (!replay_stopping_ && reader->Next(&frame))
+        {
+            replayed = true;
+            if (speed > 0)
+            {
+                auto due = started + std::chrono::nanoseconds(static_cast<int64_t>(frame.timestamp / speed));
+                if (replay_stop_.wait_until(lock, due, [this]
+                                            { return replay_stopping_; }))
+                    break;
+            }
+            lock.unlock();
+            // the reader reuses its pixels, the frame gets a copy it owns
+            uint8_t *buffer = static_cast<uint8_t *>(std::malloc(frame.size));
+            if (buffer != nullptr)
+            {
+                std::memcpy(buffer, frame.pixels, frame.size);
+                if (!Update(buffer, frame.width, frame.height, 0, frame.format, true,
+                            BufferRelease{&Frame::FreeReplayBuffer, nullptr}))
+                    std::free(buffer);
+            }
+            lock.lock();
+        }
+        if (!loop)
+            break;
+        reader->Rewind();
+    }
+}
+
+// static
+void Frame::FreeReplayBuffer(void *, uint8_t *buffer)
+{
+    std::free(buffer);
+}
+
+void Frame::Retire(std::function<void()> retired)
+{
+    StopPacer();
+    StopReplay();
+    StopRecording();
+    UnbindSharedRing();
+    // nothing allocates anymore, what the frame still holds is freed once
+    // the engine let go of it, possibly after the budget is gone
+    if (budget_ != nullptr)
+    {
+        budget_->resident_total()->fetch_sub(foreign_bytes_.load());
+        budget_ = nullptr;
+    }
+    pool_.DetachResidentTotal();
+    bridge_->UnregisterTexture(texture_id_, std::move(retired));
+}
+
+Frame::~Frame()
+{
+    // retired, and the engine released every fetched buffer once
+    // unregistering finished
+    StopPacer();
+    {
+        const std::lock_guard<std::mutex> lock(producer_mutex_);
+        ReleaseRetiredRings();
+    }
+
+    handoff_.ForEach([this](Slot &slot)
+                     { Recycle(slot); });
+    sources_.ForEach([this](Source &source)
+                     { FreeSource(source); });
+}
@@ -0,0 +1,331 @@
+#include "include/texture_interface/frame_delta.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kMaxRun = kFrameDeltaUnchanged - 1;
+    // an unchanged run costs two ops, 8 bytes, when it splits an XORed one,
+    // shorter ones are cheaper as zeros
+    constexpr uint64_t kMinUnchangedRun = 2;
+
+    const DeltaKernels kScalarKernels = {
+        ScalarXorBytes,
+        ScalarEqualRun,
+        ScalarDifferentRun,
+    };
+
+    DeltaKernels Merge(const DeltaKernels &base, const DeltaKernels *tier)
+    {
+        if (tier == nullptr)
+            return base;
+        return {
+            tier->xor_bytes != nullptr ? tier->xor_bytes : base.xor_bytes,
+            tier->equal_run != nullptr ? tier->equal_run : base.equal_run,
+            tier->different_run != nullptr ? tier->different_run : base.different_run,
+        };
+    }
+
+    inline void WriteOp(uint8_t *out, uint32_t op)
+    {
+        std::memcpy(out, &op, sizeof(op));
+    }
+
+    // Emits the ops of a frame as its rows are compared. XORed runs are
+    // continued across short unchanged runs and row ends, so the count of the
+    // open run is only written once it is closed.
+    class DeltaWriter
+    {
+    public:
+        DeltaWriter(uint8_t *out, size_t size, const DeltaKernels &kernels)
+            : out_(out), kernels_(kernels), size_(size)
+        {
+        }
+
+        void Unchanged(uint64_t pixels) { unchanged_ += pixels; }
+
+        void Changed(const uint8_t *previous, const uint8_t *current, uint64_t pixels)
+        {
+            if (unchanged_ > 0)
+            {
+                if (open_ != nullptr && unchanged_ < kMinUnchangedRun && count_ + unchanged_ <= kMaxRun)
+                {
+                    std::memset(out_ + size_, 0, unchanged_ * 4);
+                    size_ += unchanged_ * 4;
+                    count_ += static_cast<uint32_t>(unchanged_);
+                }
+                else
+                {
+                    Close();
+                    while (unchanged_ > 0)
+                    {
+                        uint32_t run = static_cast<uint32_t>(std::min<uint64_t>(unchanged_, kMaxRun));
+                        WriteOp(out_ + size_, kFrameDeltaUnchanged | run);
+                        size_ += 4;
+                        unchanged_ -= run;
+                    }
+                }
+                unchanged_ = 0;
+            }
+            while (pixels > 0)
+            {
+                if (open_ == nullptr || count_ == kMaxRun)
+                {
+                    Close();
+                    open_ = out_ + size_;
+                    size_ += 4;
+                }
+                uint32_t run = static_cast<uint32_t>(std::min<uint64_t>(pixels, kMaxRun - count_));
+                kernels_.xor_bytes(previous, current, out_ + size_, static_cast<size_t>(run) * 4);
+                size_ += static_cast<size_t>(run) * 4;
+                count_ += run;
+                previous += static_cast<size_t>(run) * 4;
+                current += static_cast<size_t>(run) * 4;
+                pixels -= run;
+            }
+        }
+
+        // trailing unchanged pixels need no op
+        size_t Finish()
+        {
+            Close();
+            return size_;
+        }
+
+    private:
+        void Close()
+        {
+            if (open_ != nullptr)
+                WriteOp(open_, count_);
+            open_ = nullptr;
+            count_ = 0;
+        }
+
+        uint8_t *out_;
+        const DeltaKernels &kernels_;
+        size_t size_;
+        uint64_t unchanged_ = 0;
+        uint8_t *open_ = nullptr;
+        uint32_t count_ = 0;
+    };
+
+    // Adds the changed run of |count| pixels from |position| on to the bands
+    // of |info|, rows it shares with the last band or that follow it extend
+    // that band.
+    void AddChangedRun(FrameDeltaInfo *info, DeltaBand *bounds, uint64_t position, uint64_t count)
+    {
+        uint64_t width = static_cast<uint64_t>(info->width);
+        int32_t y0 = static_cast<int32_t>(position / width);
+        int32_t y1 = static_cast<int32_t>((position + count - 1) / width) + 1;
+        int32_t x0 = 0;
+        int32_t x1 = info->width;
+        if (y1 - y0 == 1)
+        {
+            x0 = static_cast<int32_t>(position % width);
+            x1 = x0 + static_cast<int32_t>(count);
+        }
+
+        auto extend = [&](DeltaBand *band)
+        {
+            int32_t right = std::max(band->x + band->width, x1);
+            int32_t bottom = std::max(band->y + band->height, y1);
+            band->x = std::min(band->x, x0);
+            band->y = std::min(band->y, y0);
+            band->width = right - band->x;
+            band->height = bottom - band->y;
+        };
+        if (info->changed_pixels == 0)
+            *bounds = {x0, y0, x1 - x0, y1 - y0};
+        else
+            extend(bounds);
+        info->changed_pixels += count;
+
+        if (info->band_count > kMaxDeltaBands)
+            return;
+        if (info->band_count > 0)
+        {
+            DeltaBand &last = info->bands[info->band_count - 1];
+            if (last.y + last.height >= y0)
+            {
+                extend(&last);
+                return;
+            }
+        }
+        // one past the capacity marks the overflow
+        if (info->band_count < kMaxDeltaBands)
+            info->bands[info->band_count] = {x0, y0, x1 - x0, y1 - y0};
+        info->band_count++;
+    }
+}
+
+void ScalarXorBytes(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = static_cast<uint8_t>(a[i] ^ b[i]);
+}
+
+size_t ScalarEqualRun(const uint8_t *a, const uint8_t *b, size_t count)
+{
+    size_t i = 0;
+    while (i < count && std::memcmp(a + i * 4, b + i * 4, 4) == 0)
+        i++;
+    return i;
+}
+
+size_t ScalarDifferentRun(const uint8_t *a, const uint8_t *b, size_t count)
+{
+    size_t i = 0;
+    while (i < count && std::memcmp(a + i * 4, b + i * 4, 4) != 0)
+        i++;
+    return i;
+}
+
+const DeltaKernels &DeltaKernelsFor(SimdTier tier)
+{
+    static const DeltaKernels sse2 = Merge(kScalarKernels, Sse2DeltaKernels());
+    static const DeltaKernels avx2 = Merge(sse2, Avx2DeltaKernels());
+    switch (tier)
+    {
+    case SimdTier::kAvx2:
+        return avx2;
+    case SimdTier::kSse2:
+        return sse2;
+    case SimdTier::kScalar:
+        break;
+    }
+    return kScalarKernels;
+}
+
+const DeltaKernels &ActiveDeltaKernels()
+{
+    static const DeltaKernels &kernels = DeltaKernelsFor(DetectSimdTier());
+    return kernels;
+}
+
+size_t MaxFrameDeltaSize(int32_t width, int32_t height)
+{
+    // with unchanged runs of two pixels or more between them, ops and XORed
+    // pixels never outgrow the frame by more than two ops, plus one per run
+    // split at kMaxRun
+    uint64_t pixels = static_cast<uint64_t>(std::max(width, 0)) * static_cast<uint64_t>(std::max(height, 0));
+    return sizeof(FrameDeltaHeader) + static_cast<size_t>(pixels * 4 + 8 + pixels / kMaxRun * 8);
+}
+
+size_t EncodeFrameDelta(const uint8_t *previous, const uint8_t *current, int32_t width, int32_t height,
+                        int32_t stride, uint8_t *out, const DeltaKernels &kernels)
+{
+    size_t row_bytes = static_cast<size_t>(width) * 4;
+    size_t pitch = stride > 0 ? static_cast<size_t>(stride) : row_bytes;
+    FrameDeltaHeader header;
+    std::memcpy(header.magic, kFrameDeltaMagic, sizeof(header.magic));
+    header.version = kFrameDeltaVersion;
+    header.width = width;
+    header.height = height;
+    std::memcpy(out, &header, sizeof(header));
+
+    DeltaWriter writer(out, sizeof(header), kernels);
+    for (int32_t y = 0; y < height; y++)
+    {
+        const uint8_t *a = previous + y * pitch;
+        const uint8_t *b = current + y * pitch;
+        size_t x = 0;
+        while (x < static_cast<size_t>(width))
+        {
+            size_t equal = kernels.equal_run(a + x * 4, b + x * 4, width - x);
+            writer.Unchanged(equal);
+            x += equal;
+            if (x == static_cast<size_t>(width))
+                break;
+            size_t different = kernels.different_run(a + x * 4, b + x * 4, width - x);
+            writer.Changed(a + x * 4, b + x * 4, different);
+            x += different;
+        }
+    }
+    return writer.Finish();
+}
+
+bool ReadFrameDeltaInfo(const uint8_t *data, size_t size, FrameDeltaInfo *info)
+{
+    FrameDeltaHeader header;
+    if (data == nullptr || size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kFrameDeltaMagic, sizeof(header.magic)) != 0 ||
+        header.version != kFrameDeltaVersion || header.width <= 0 || header.height <= 0)
+        return false;
+
+    info->width = header.width;
+    info->height = header.height;
+    info->changed_pixels = 0;
+    info->band_count = 0;
+    DeltaBand bounds = {};
+    uint64_t pixels = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height);
+    uint64_t position = 0;
+    const uint8_t *in = data + sizeof(header);
+    const uint8_t *end = data + size;
+    while (in < end)
+    {
+        if (end - in < 4)
+            return false;
+        uint32_t op;
+        std::memcpy(&op, in, sizeof(op));
+        in += 4;
+        uint64_t count = op & ~kFrameDeltaUnchanged;
+        if (count == 0 || count > pixels - position)
+            return false;
+        if ((op & kFrameDeltaUnchanged) == 0)
+        {
+            if (static_cast<uint64_t>(end - in) / 4 < count)
+                return false;
+            AddChangedRun(info, &bounds, position, count);
+            in += count * 4;
+        }
+        position += count;
+    }
+    if (info->band_count > kMaxDeltaBands)
+    {
+        info->bands[0] = bounds;
+        info->band_count = 1;
+    }
+    return true;
+}
+
+bool ApplyFrameDelta(const uint8_t *data, size_t size, uint8_t *dst, const DeltaKernels &kernels)
+{
+    FrameDeltaHeader header;
+    if (data == nullptr || size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.width <= 0 || header.height <= 0)
+        return false;
+
+    // the caller's memory may have changed since ReadFrameDeltaInfo, every
+    // op is checked again before it is applied
+    uint64_t pixels = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height);
+    uint64_t position = 0;
+    const uint8_t *in = data + sizeof(header);
+    const uint8_t *end = data + size;
+    while (in < end)
+    {
+        if (end - in < 4)
+            return false;
+        uint32_t op;
+        std::memcpy(&op, in, sizeof(op));
+        in += 4;
+        uint64_t count = op & ~kFrameDeltaUnchanged;
+        if (count == 0 || count > pixels - position)
+            return false;
+        size_t bytes = static_cast<size_t>(count) * 4;
+        if ((op & kFrameDeltaUnchanged) == 0)
+        {
+            if (static_cast<size_t>(end - in) < bytes)
+                return false;
+            kernels.xor_bytes(dst, in, dst, bytes);
+            in += bytes;
+        }
+        dst += bytes;
+        position += count;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#include "include/texture_interface/frame_delta.h"
+
+// Built with AVX2 code generation enabled, only called after DetectSimdTier
+// reported AVX2 support.
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace
+{
+    void Avx2XorBytes(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(x, y));
+        }
+        ScalarXorBytes(a + i, b + i, dst + i, count - i);
+    }
+
+    // one mask bit per pixel, set where both are the same
+    inline int Avx2EqualPixels(const uint8_t *a, const uint8_t *b)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+    }
+
+    size_t Avx2EqualRun(const uint8_t *a, const uint8_t *b, size_t count)
+    {
+        size_t i = 0;
+        while (i + 8 <= count && Avx2EqualPixels(a + i * 4, b + i * 4) == 0xFF)
+            i += 8;
+        return i + ScalarEqualRun(a + i * 4, b + i * 4, count - i);
+    }
+
+    size_t Avx2DifferentRun(const uint8_t *a, const uint8_t *b, size_t count)
+    {
+        size_t i = 0;
+        while (i + 8 <= count && Avx2EqualPixels(a + i * 4, b + i * 4) == 0)
+            i += 8;
+        return i + ScalarDifferentRun(a + i * 4, b + i * 4, count - i);
+    }
+
+    const DeltaKernels kAvx2Kernels = {
+        Avx2XorBytes,
+        Avx2EqualRun,
+        Avx2DifferentRun,
+    };
+}
+
+const DeltaKernels *Avx2DeltaKernels()
+{
+    return &kAvx2Kernels;
+}
+
+#else
+
+const DeltaKernels *Avx2DeltaKernels()
+{
+    return nullptr;
+}
+
+#endif
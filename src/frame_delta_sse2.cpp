@@ -0,0 +1,66 @@
+#include "include/texture_interface/frame_delta.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+namespace
+{
+    void Sse2XorBytes(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(x, y));
+        }
+        ScalarXorBytes(a + i, b + i, dst + i, count - i);
+    }
+
+    // one mask bit per pixel, set where both are the same
+    inline int Sse2EqualPixels(const uint8_t *a, const uint8_t *b)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+    }
+
+    // whole blocks of four are skipped, the scalar kernel finds the end of
+    // the run within the first block that breaks it
+    size_t Sse2EqualRun(const uint8_t *a, const uint8_t *b, size_t count)
+    {
+        size_t i = 0;
+        while (i + 4 <= count && Sse2EqualPixels(a + i * 4, b + i * 4) == 0xF)
+            i += 4;
+        return i + ScalarEqualRun(a + i * 4, b + i * 4, count - i);
+    }
+
+    size_t Sse2DifferentRun(const uint8_t *a, const uint8_t *b, size_t count)
+    {
+        size_t i = 0;
+        while (i + 4 <= count && Sse2EqualPixels(a + i * 4, b + i * 4) == 0)
+            i += 4;
+        return i + ScalarDifferentRun(a + i * 4, b + i * 4, count - i);
+    }
+
+    const DeltaKernels kSse2Kernels = {
+        Sse2XorBytes,
+        Sse2EqualRun,
+        Sse2DifferentRun,
+    };
+}
+
+const DeltaKernels *Sse2DeltaKernels()
+{
+    return &kSse2Kernels;
+}
+
+#else
+
+const DeltaKernels *Sse2DeltaKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "include/texture_interface/frame_host.h"
+
+#include "include/texture_interface/frame_registry.h"
+
+FrameHost::FrameHost(TextureBridge *bridge) : bridge_(bridge), patterns_(&workers_) {}
+
+FrameHost::~FrameHost()
+{
+    // live frames go the same way as unregistered ones, the raster thread
+    // may still be fetching them until the bridge says otherwise
+    for (auto &[id, entry] : frames_)
+        Retire(entry);
+    frames_.clear();
+
+    // Bridges may only report on the platform thread, which is blocked
+    // here, so the frames the engine still holds are left to their retire
+    // callback. Retired frames no longer use the host's workers or budget.
+    for (Retired &retired : retired_)
+    {
+        const std::lock_guard<std::mutex> lock(retired.state->mutex);
+        if (!retired.state->done.load())
+            retired.state->orphan = std::move(retired.frame);
+    }
+    retired_.clear();
+}
+
+Frame *FrameHost::Register(int id)
+{
+    Collect();
+    auto [it, added] = frames_.try_emplace(id);
+    if (added)
+    {
+        it->second.frame = std::make_unique<Frame>(bridge_, &workers_, &budget_);
+        budget_.Add(it->second.frame.get());
+        it->second.handle = FrameRegistry::Instance().Add(it->second.frame.get());
+    }
+    return it->second.frame.get();
+}
+
+void FrameHost::Retire(Entry &entry)
+{
+    patterns_.Stop(entry.frame.get());
+    budget_.Remove(entry.frame.get());
+    // native callers can no longer reach the frame once this returns
+    FrameRegistry::Instance().Remove(entry.handle);
+
+    auto state = std::make_shared<RetireState>();
+    entry.frame->Retire([state]
+                        {
+                            std::unique_ptr<Frame> orphan;
+                            {
+                                const std::lock_guard<std::mutex> lock(state->mutex);
+                                state->done.store(true);
+                                orphan = std::move(state->orphan);
+                            }
+                            // set if the host is gone, the frame is
+                            // destroyed here then
+                        });
+    retired_.push_back({std::move(entry.frame), std::move(state)});
+}
+
+bool FrameHost::Unregister(int id)
+{
+    Collect();
+    auto it = frames_.find(id);
+    if (it == frames_.end())
+        return false;
+    Retire(it->second);
+    frames_.erase(it);
+    Collect();
+    return true;
+}
+
+size_t FrameHost::UnregisterAll(const std::vector<int> &ids)
+{
+    Collect();
+    size_t count = 0;
+    for (int id : ids)
+    {
+        auto it = frames_.find(id);
+        if (it == frames_.end())
+            continue;
+        Retire(it->second);
+        frames_.erase(it);
+        count++;
+    }
+    // bridges that unregister synchronously are done already
+    Collect();
+    return count;
+}
+
+void FrameHost::Collect()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        if (retired_[i].state->done.load())
+            retired_[i].frame.reset();
+        else if (kept++ != i)
+            retired_[kept - 1] = std::move(retired_[i]);
+    }
+    retired_.resize(kept);
+}
+
+Frame *FrameHost::Find(int id) const
+{
+    auto it = frames_.find(id);
+    return it != frames_.end() ? it->second.frame.get() : nullptr;
+}
+
+int64_t FrameHost::Handle(int id) const
+{
+    auto it = frames_.find(id);
+    return it != frames_.end() ? it->second.handle : 0;
+}
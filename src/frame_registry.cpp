@@ -0,0 +1,69 @@
+#include "include/texture_interface/frame_registry.h"
+
+#include <thread>
+
+// static
+FrameRegistry &FrameRegistry::Instance()
+{
+    static FrameRegistry registry;
+    return registry;
+}
+
+int64_t FrameRegistry::Add(Frame *frame)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index;
+    if (!free_.empty())
+    {
+        index = free_.back();
+        free_.pop_back();
+    }
+    else
+    {
+        if (used_ == kChunkSize * kMaxChunks)
+            return 0;
+        index = used_++;
+        if ((index & (kChunkSize - 1)) == 0)
+        {
+            storage_.push_back(std::make_unique<Slot[]>(kChunkSize));
+            chunks_[index >> kChunkBits].store(storage_.back().get(), std::memory_order_release);
+        }
+    }
+
+    Slot *slot = Find(index);
+    slot->frame.store(frame, std::memory_order_relaxed);
+    // publishes the frame to lookups that see the live bit
+    uint64_t state = slot->state.fetch_or(kLive, std::memory_order_release) | kLive;
+    size_.fetch_add(1);
+    return static_cast<int64_t>((state >> kGenerationShift) << kGenerationShift | index);
+}
+
+void FrameRegistry::Remove(int64_t handle)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t index = static_cast<uint64_t>(handle) & 0xFFFFFFFF;
+    if (handle <= 0 || index >= used_)
+        return;
+    Slot *slot = Find(static_cast<uint32_t>(index));
+    uint64_t generation = static_cast<uint64_t>(handle) >> kGenerationShift;
+    uint64_t state = slot->state.load();
+    if ((state >> kGenerationShift) != generation || (state & kLive) == 0)
+        return;
+
+    // no new pins once the live bit is gone, wait for native callers that
+    // are still inside the frame
+    state = slot->state.fetch_and(~kLive, std::memory_order_acq_rel) & ~kLive;
+    while ((state & kPinMask) != 0)
+    {
+        std::this_thread::yield();
+        state = slot->state.load(std::memory_order_acquire);
+    }
+
+    uint64_t next = (generation + 1) & kGenerationMask;
+    if (next == 0)
+        next = 1;
+    slot->frame.store(nullptr, std::memory_order_relaxed);
+    slot->state.store(next << kGenerationShift, std::memory_order_release);
+    free_.push_back(static_cast<uint32_t>(index));
+    size_.fetch_sub(1);
+}
@@ -0,0 +1,153 @@
+#include "include/texture_interface/frame_stats.h"
+
+#include <chrono>
+
+namespace
+{
+    int HighestBit(uint64_t value)
+    {
+        int bit = 0;
+        for (int shift = 32; shift > 0; shift >>= 1)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                bit += shift;
+            }
+        }
+        return bit;
+    }
+
+    size_t BucketIndex(uint64_t value)
+    {
+        if (value < 4)
+            return static_cast<size_t>(value);
+        int bit = HighestBit(value);
+        return static_cast<size_t>(bit - 1) * 4 + ((value >> (bit - 2)) & 3);
+    }
+
+    // middle of the values that fall into |index|
+    double BucketValue(size_t index)
+    {
+        if (index < 4)
+            return static_cast<double>(index);
+        int bit = static_cast<int>(index / 4) + 1;
+        uint64_t width = uint64_t(1) << (bit - 2);
+        return static_cast<double>((4 + index % 4) * width) + static_cast<double>(width) / 2;
+    }
+}
+
+void LatencyHistogram::Record(int64_t nanoseconds)
+{
+    uint64_t value = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+    buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Collect(Counts &counts, bool reset)
+{
+    for (size_t i = 0; i < kBuckets; i++)
+        counts[i] = reset ? buckets_[i].exchange(0, std::memory_order_relaxed)
+                          : buckets_[i].load(std::memory_order_relaxed);
+}
+
+// static
+double LatencyHistogram::Percentile(const Counts &counts, double percentile)
+{
+    uint64_t total = 0;
+    for (uint64_t count : counts)
+        total += count;
+    if (total == 0)
+        return 0;
+
+    // rank of the value the percentile falls on, counted from 1
+    uint64_t rank = static_cast<uint64_t>(percentile * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return BucketValue(i) / 1000.0;
+    }
+    return BucketValue(kBuckets - 1) / 1000.0;
+}
+
+FrameStats::FrameStats()
+{
+    window_start_ = Current();
+}
+
+// static
+int64_t FrameStats::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void FrameStats::RecordSubmit(size_t bytes)
+{
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void FrameStats::RecordTake(int64_t submitted_at, int64_t now)
+{
+    take_.Record(now - submitted_at);
+}
+
+void FrameStats::RecordFetch(int64_t published_at, int64_t now)
+{
+    displayed_.fetch_add(1, std::memory_order_relaxed);
+    queue_.Record(now - published_at);
+}
+
+void FrameStats::RecordRelease(int64_t submitted_at, int64_t fetched_at, int64_t now)
+{
+    upload_.Record(now - fetched_at);
+    if (submitted_at != 0)
+        total_.Record(now - submitted_at);
+}
+
+FrameStats::Totals FrameStats::Current() const
+{
+    return {submitted_.load(std::memory_order_relaxed), displayed_.load(std::memory_order_relaxed),
+            dropped_.load(std::memory_order_relaxed), skipped_.load(std::memory_order_relaxed),
+            bytes_.load(std::memory_order_relaxed), Now()};
+}
+
+FrameStatsSnapshot FrameStats::Snapshot(bool reset)
+{
+    const std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    Totals now = Current();
+
+    FrameStatsSnapshot snapshot{};
+    snapshot.frames_submitted = now.submitted - window_start_.submitted;
+    snapshot.frames_displayed = now.displayed - window_start_.displayed;
+    snapshot.frames_dropped = now.dropped - window_start_.dropped;
+    snapshot.frames_skipped = now.skipped - window_start_.skipped;
+    snapshot.bytes_submitted = now.bytes - window_start_.bytes;
+    snapshot.interval_seconds = static_cast<double>(now.at - window_start_.at) / 1e9;
+    if (snapshot.interval_seconds > 0)
+    {
+        snapshot.fps = static_cast<double>(snapshot.frames_displayed) / snapshot.interval_seconds;
+        snapshot.bytes_per_second = static_cast<double>(snapshot.bytes_submitted) / snapshot.interval_seconds;
+    }
+
+    LatencyHistogram::Counts counts;
+    take_.Collect(counts, reset);
+    snapshot.take_p50_us = LatencyHistogram::Percentile(counts, 0.5);
+    snapshot.take_p99_us = LatencyHistogram::Percentile(counts, 0.99);
+    queue_.Collect(counts, reset);
+    snapshot.queue_p50_us = LatencyHistogram::Percentile(counts, 0.5);
+    snapshot.queue_p99_us = LatencyHistogram::Percentile(counts, 0.99);
+    upload_.Collect(counts, reset);
+    snapshot.upload_p50_us = LatencyHistogram::Percentile(counts, 0.5);
+    snapshot.upload_p99_us = LatencyHistogram::Percentile(counts, 0.99);
+    total_.Collect(counts, reset);
+    snapshot.total_p50_us = LatencyHistogram::Percentile(counts, 0.5);
+    snapshot.total_p99_us = LatencyHistogram::Percentile(counts, 0.99);
+
+    if (reset)
+        window_start_ = now;
+    return snapshot;
+}
@@ -0,0 +1,38 @@
+#include "include/texture_interface/image_decoder.h"
+
+namespace
+{
+    bool IsSupportedSize(int64_t width, int64_t height)
+    {
+        return width > 0 && height > 0 && width <= kMaxImageDimension && height <= kMaxImageDimension &&
+               width * height <= kMaxImagePixels;
+    }
+}
+
+bool ReadImageInfo(const uint8_t *data, size_t size, ImageInfo *info)
+{
+    if (data == nullptr || size < 4)
+        return false;
+    bool known;
+    if (data[0] == 'q' && data[1] == 'o' && data[2] == 'i' && data[3] == 'f')
+        known = ReadQoiInfo(data, size, info);
+    else if (data[0] == 0xFF && data[1] == 0xD8)
+        known = ReadJpegInfo(data, size, info);
+    else
+        known = false;
+    return known && IsSupportedSize(info->width, info->height);
+}
+
+bool DecodeImage(const ImageInfo &info, const uint8_t *data, size_t size, uint8_t *dst, WorkerPool *workers)
+{
+    switch (info.codec)
+    {
+    case ImageCodec::kQoi:
+        return DecodeQoi(data, size, dst, info.width, info.height);
+    case ImageCodec::kJpeg:
+        return DecodeJpeg(data, size, dst, info.width, info.height, workers);
+    case ImageCodec::kUnknown:
+        break;
+    }
+    return false;
+}
@@ -0,0 +1,87 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "page_allocator.h"
+
+// Recycles the pixel buffers of a Frame so that steady state updates do not
+// touch the heap. Buffers are allocated as the PagePolicy says and
+// pre-faulted on first use, then kept on a free list until the pool is
+// trimmed or destroyed.
+class BufferPool
+{
+public:
+    // |resident_total|, if set, is kept up to date with the bytes the pool
+    // allocates and frees and has to outlive it or DetachResidentTotal.
+    explicit BufferPool(size_t max_free_buffers = 4, std::atomic<size_t> *resident_total = nullptr);
+    ~BufferPool();
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // Returns a buffer of at least |size| bytes for the owner of the pool,
+    // reusing a free one if possible, one on the caller's NUMA node first if
+    // NUMA placement is on.
+    uint8_t *Acquire(size_t size);
+
+    // Like Acquire, for a buffer handed out to a producer. A lent buffer only
+    // comes back through Reclaim, once it was filled, or Return, unused.
+    uint8_t *Lend(size_t size);
+
+    // Capacity of |buffer| if it is currently lent, 0 otherwise.
+    size_t LentCapacity(const uint8_t *buffer) const;
+
+    // Takes a lent buffer back for the owner's use. Returns false if |buffer|
+    // is not currently lent or holds less than |size| bytes, so a buffer can
+    // be reclaimed once only.
+    bool Reclaim(uint8_t *buffer, size_t size);
+
+    // Puts a lent buffer that was not reclaimed back on the free list.
+    // Returns false if |buffer| is not currently lent.
+    bool Return(uint8_t *buffer);
+
+    // Puts a buffer the owner acquired or reclaimed back on the free list.
+    // Returns false if the buffer was not handed out by this pool or is lent.
+    bool Release(uint8_t *buffer);
+
+    // Frees every buffer that is currently on the free list.
+    void Trim();
+
+    // Takes the pool's bytes out of |resident_total| and stops updating it.
+    void DetachResidentTotal();
+
+    size_t allocation_count() const;
+    size_t free_count() const;
+    size_t resident_bytes() const;
+
+private:
+    struct Entry
+    {
+        uint8_t *data;
+        size_t capacity;
+        bool in_use;
+        // handed out by Lend and not reclaimed or returned yet
+        bool lent;
+        PageAllocation allocation;
+    };
+
+    uint8_t *Take(size_t size, bool lent);
+    // puts |entry| on the free list, freeing the smallest free buffer if
+    // there are too many. Called with mutex_ held.
+    void Free(std::vector<Entry>::iterator entry);
+    std::vector<Entry>::iterator Find(const uint8_t *buffer);
+    void Deallocate(const Entry &entry);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    size_t max_free_buffers_;
+    std::atomic<size_t> *resident_total_;
+    size_t allocation_count_ = 0;
+};
+
+#endif
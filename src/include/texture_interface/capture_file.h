@@ -0,0 +1,132 @@
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "pixel_format.h"
+
+// Recorded frame sequences, to reproduce what a texture was fed. Layout, in
+// host byte order:
+//
+//   CaptureFileHeader
+//   one record per frame, 8 byte aligned:
+//     CaptureRecordHeader
+//     |body_size| bytes of line ops
+//
+// A frame is split into lines, the rows of each of its planes tightly
+// packed (see pixel_format.h). The body is a sequence of uint32 ops whose
+// low 31 bits count lines: with the high bit set those lines are the same as
+// in the previous frame, otherwise their bytes follow. Key frames do not
+// refer to the previous frame, frames of another size or format always are
+// key frames.
+
+struct CaptureFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    // kept up to date after every frame, so files of crashed processes can
+    // still be read
+    uint64_t frame_count;
+    uint64_t data_end;
+};
+
+struct CaptureRecordHeader
+{
+    uint64_t body_size;
+    // nanoseconds since the first frame was submitted
+    int64_t timestamp;
+    int32_t width;
+    int32_t height;
+    int32_t format;
+    uint32_t flags;
+};
+
+constexpr char kCaptureMagic[8] = {'T', 'I', 'C', 'A', 'P', 'T', 'U', 'R'};
+constexpr uint32_t kCaptureVersion = 1;
+constexpr uint32_t kCaptureKeyFrame = 1;
+constexpr uint32_t kCaptureUnchangedLines = 0x80000000u;
+
+// Appends frames to a capture file, growing the mapping as needed.
+class CaptureRecorder
+{
+public:
+    static std::unique_ptr<CaptureRecorder> Create(const std::string &path);
+    // truncates the file to what was recorded
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder &) = delete;
+    CaptureRecorder &operator=(const CaptureRecorder &) = delete;
+
+    // Appends a frame in |format| whose rows are |stride| bytes apart,
+    // submitted at FrameStats::Now() |timestamp|. Returns false, and records
+    // nothing more, once the file cannot grow.
+    bool Record(const uint8_t *buffer, int32_t width, int32_t height, int32_t stride, PixelFormat format,
+                int64_t timestamp);
+
+    uint64_t frame_count() const { return frame_count_; }
+
+private:
+    CaptureRecorder() = default;
+
+    bool Reserve(size_t bytes);
+    CaptureFileHeader *header() const { return reinterpret_cast<CaptureFileHeader *>(file_->data()); }
+
+    std::unique_ptr<MappedFile> file_;
+    size_t end_ = 0;
+    uint64_t frame_count_ = 0;
+    int64_t first_timestamp_ = 0;
+    bool failed_ = false;
+    // the last frame packed, what delta lines refer to
+    std::vector<uint8_t> previous_;
+    int32_t previous_width_ = 0;
+    int32_t previous_height_ = 0;
+    PixelFormat previous_format_ = PixelFormat::kRGBA;
+};
+
+struct CaptureFrame
+{
+    // tightly packed, valid until the next call on the reader
+    const uint8_t *pixels;
+    size_t size;
+    int32_t width;
+    int32_t height;
+    PixelFormat format;
+    int64_t timestamp;
+};
+
+// Decodes the frames of a capture file in order. Corrupt records end the
+// sequence instead of being read out of bounds.
+class CaptureReader
+{
+public:
+    static std::unique_ptr<CaptureReader> Open(const std::string &path);
+
+    CaptureReader(const CaptureReader &) = delete;
+    CaptureReader &operator=(const CaptureReader &) = delete;
+
+    // false after the last frame
+    bool Next(CaptureFrame *frame);
+    void Rewind();
+
+    uint64_t frame_count() const { return frame_count_; }
+
+private:
+    CaptureReader() = default;
+
+    std::unique_ptr<MappedFile> file_;
+    size_t data_end_ = 0;
+    uint64_t frame_count_ = 0;
+    size_t offset_ = 0;
+    std::vector<uint8_t> pixels_;
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    PixelFormat format_ = PixelFormat::kRGBA;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_features.h"
+
+// A fast 64 bit hash of frame contents, to tell resent frames from new ones.
+// It follows the structure of XXH3's long input loop: 64 byte stripes are
+// mixed into eight 64 bit accumulators with a secret that shifts with every
+// stripe, and the accumulators are scrambled once per block of 16 stripes.
+// The values are not those of XXH3 and only meant to be compared within
+// the running process.
+
+// bytes of a stripe and of a block
+constexpr size_t kHashStripe = 64;
+constexpr size_t kHashBlock = 1024;
+// 64 bit secret words, the 16 stripes of a block read words 0 to 22 and the
+// scramble the last eight
+constexpr size_t kHashSecretWords = 24;
+
+// Mixes |stripes| stripes of |data| into |acc|, stripe s with the secret
+// words from |secret| + s on.
+typedef void (*AccumulateStripesKernel)(uint64_t *acc, const uint8_t *data, size_t stripes,
+                                        const uint64_t *secret);
+// Scrambles |acc| with the first eight words of |secret|.
+typedef void (*ScrambleKernel)(uint64_t *acc, const uint64_t *secret);
+
+struct HashKernels
+{
+    AccumulateStripesKernel accumulate;
+    ScrambleKernel scramble;
+};
+
+// Kernels of |tier|, falling back to lower tiers for what it lacks.
+const HashKernels &HashKernelsFor(SimdTier tier);
+
+// Kernels for the running CPU, selected once.
+const HashKernels &ActiveHashKernels();
+
+// Hashes |size| bytes of |data|. With a |sample_step| above 1 only every
+// |sample_step|th block and the last one are read, which is that much
+// faster but misses changes confined to the blocks in between.
+uint64_t HashContent(const uint8_t *data, size_t size, size_t sample_step = 1,
+                     const HashKernels &kernels = ActiveHashKernels());
+
+// Scalar reference kernels, and the SIMD kernel tables, null where the
+// target architecture has no such tier.
+void ScalarAccumulateStripes(uint64_t *acc, const uint8_t *data, size_t stripes, const uint64_t *secret);
+void ScalarScramble(uint64_t *acc, const uint64_t *secret);
+const HashKernels *Sse2HashKernels();
+const HashKernels *Avx2HashKernels();
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Instruction set levels the SIMD kernels are compiled for, in ascending
+// order.
+enum class SimdTier
+{
+    kScalar = 0,
+    kSse2 = 1,
+    kAvx2 = 2,
+};
+
+// Highest tier the running CPU and OS support, detected once.
+SimdTier DetectSimdTier();
+
+#endif
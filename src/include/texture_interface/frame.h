@@ -0,0 +1,424 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "capture_file.h"
+#include "content_hash.h"
+#include "frame_delta.h"
+#include "frame_stats.h"
+#include "image_decoder.h"
+#include "memory_budget.h"
+#include "pixel_format.h"
+#include "semaphore.h"
+#include "shared_frame_ring.h"
+#include "shared_memory.h"
+#include "texture_bridge.h"
+#include "triple_buffer.h"
+#include "worker_pool.h"
+
+// Rectangle of changed pixels. |src| points at the rectangle's top left RGBA
+// pixel, |src_stride| is the distance between its rows in bytes.
+struct FrameRegion
+{
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    const uint8_t *src;
+    int32_t src_stride;
+};
+
+// How a caller's buffer is handed back once a frame no longer needs it,
+// instead of being freed through the bridge. |callback| runs on the thread
+// of a later update, trim or unregister, never on the raster thread, and
+// must not call back into the same frame.
+struct BufferRelease
+{
+    void (*callback)(void *context, uint8_t *buffer);
+    void *context;
+};
+
+// How Frame::Update treats frames that arrive faster than they are shown.
+enum class PacingMode : int32_t
+{
+    // every frame is converted and the engine notified right away
+    kImmediate = 0,
+    // frames are converted on a thread of the frame once the raster thread
+    // fetched the previous one, so a frame replaced before that costs
+    // nothing, and the engine is notified once per converted frame, also
+    // for updates that asked not to notify. The raster thread only swaps
+    // buffers and wakes that thread.
+    kCoalesce = 1,
+};
+
+// Whether Frame checks submitted frames against the one it shows, to skip
+// publishing frames that producers resend unchanged.
+enum class DuplicateCheck : int32_t
+{
+    kOff = 0,
+    // every byte is hashed
+    kFull = 1,
+    // one in kDuplicateSampleStep blocks of the content is hashed, changes
+    // confined to the others go unnoticed
+    kSampled = 2,
+};
+
+constexpr size_t kDuplicateSampleStep = 8;
+
+class Frame
+{
+public:
+    // |workers| splits the conversion and copy of large frames, |budget| is
+    // told whenever the frame might have grown. Both have to outlive the
+    // frame.
+    Frame(TextureBridge *bridge, WorkerPool *workers = nullptr, MemoryBudget *budget = nullptr);
+
+    int64_t texture_id() const { return texture_id_; }
+
+    // Takes ownership of |buffer| in |format|, whose rows are |stride| bytes
+    // apart, 0 meaning tightly packed. Packed RGBA buffers are displayed as
+    // they are, anything else is converted into a pooled buffer and released
+    // right away. Buffers are released through |release| if it has a
+    // callback and freed through the bridge otherwise. Returns false, without
+    // taking ownership, if the stride is too small or no buffer could be
+    // allocated. With |notify| false the engine is not told about the new
+    // frame until FlushFrameAvailable, so batches notify each texture once.
+    bool Update(uint8_t *buffer, int32_t width, int32_t height, int32_t stride = 0,
+                PixelFormat format = PixelFormat::kRGBA, bool notify = true, BufferRelease release = {});
+    void FlushFrameAvailable();
+
+    // Pooled buffers: acquire one, fill it and submit it, or hand it back
+    // unused with ReleaseBuffer. Submitted buffers are recycled once they have
+    // been replaced and the raster thread is done with them. Both return
+    // false for buffers that are not currently acquired, and SubmitBuffer
+    // for frames larger than the acquired buffer.
+    uint8_t *AcquireBuffer(int32_t width, int32_t height);
+    bool SubmitBuffer(uint8_t *buffer, int32_t width, int32_t height);
+    bool ReleaseBuffer(uint8_t *buffer);
+
+    // Decodes the compressed image |data| described by ReadImageInfo straight
+    // into a pooled buffer and publishes it. |data| stays owned by the
+    // caller. Returns false if it is corrupt or no buffer could be
+    // allocated.
+    bool UpdateEncoded(const uint8_t *data, size_t size, const ImageInfo &info, bool notify = true);
+
+    // Copies only the changed rectangles into the frame's persistent backing
+    // buffers, the source memory stays owned by the caller. Needs a previous
+    // full frame to draw onto and returns false without one.
+    bool UpdateRegion(int32_t x, int32_t y, int32_t width, int32_t height,
+                      const uint8_t *src, int32_t src_stride);
+    bool UpdateRegions(const FrameRegion *regions, size_t count);
+
+    // Applies a delta ReadFrameDeltaInfo accepted to the frame's persistent
+    // backing buffers, the same way as a region update of the rows it
+    // changes. Returns false without a previous full frame of the size the
+    // delta was encoded for, or if the delta is malformed after all, and
+    // publishes nothing then.
+    bool UpdateDelta(const uint8_t *data, size_t size, const FrameDeltaInfo &info);
+
+    const BufferPool &pool() const { return pool_; }
+
+    // Size in physical pixels the texture is displayed at, 0 if unknown.
+    // Larger frames are downscaled to the smallest size that still covers it
+    // before they are published, so copies and uploads scale with what is
+    // shown. Region updates fail while the last full frame is downscaled.
+    void set_display_size(int32_t width, int32_t height);
+
+    void set_pacing_mode(PacingMode mode);
+    PacingMode pacing_mode() const { return pacing_mode_.load(); }
+    // false while the last published frame has not been fetched by the
+    // raster thread, producers can use it to skip frames
+    bool ReadyForFrame() const;
+    // published frames that were replaced before the raster thread fetched
+    // them
+    uint64_t dropped_frames() const { return stats_.dropped_frames(); }
+
+    // Resent frames are released right away instead of being published, so
+    // the engine does not upload the same pixels again. Region and delta
+    // updates are not hashed, empty deltas are skipped though.
+    void set_duplicate_check(DuplicateCheck check) { duplicate_check_.store(check); }
+    DuplicateCheck duplicate_check() const { return duplicate_check_.load(); }
+    // frames that were skipped as duplicates
+    uint64_t skipped_frames() const { return stats_.skipped_frames(); }
+
+    // latency and throughput since the last reset
+    FrameStatsSnapshot Stats(bool reset) { return stats_.Snapshot(reset); }
+
+    // pooled buffers plus the caller's buffers the frame holds on to
+    size_t resident_bytes() const { return pool_.resident_bytes() + foreign_bytes_.load(); }
+    // FrameStats::Now() of the last update or fetch
+    int64_t last_active() const { return last_active_.load(std::memory_order_relaxed); }
+
+    // Frees the frame's content and shows a transparent placeholder until the
+    // next full frame, region updates fail until then. Returns the number of
+    // bytes freed; the buffers the raster thread still holds follow on a later
+    // Trim. Does nothing while a shared ring is bound.
+    size_t Evict();
+    bool evicted() const { return evicted_.load(); }
+    // Frees the pool's unused buffers and finishes an eviction once the
+    // raster thread moved on to the placeholder.
+    void Trim();
+
+    // Displays the frames an external process publishes into the named
+    // SharedFrameRing, without copying them. Updates submitted while a ring is
+    // bound are kept but not shown until it is unbound.
+    bool BindSharedRing(const std::string &name);
+    void UnbindSharedRing();
+    // size of the bound ring's slots, 0 if none is bound
+    int32_t shared_ring_width() const;
+    int32_t shared_ring_height() const;
+
+    // Records every frame submitted from now on into a capture file at
+    // |path|, with its timestamp, replacing a running recording. Returns
+    // false if the file could not be created.
+    bool StartRecording(const std::string &path);
+    // Finishes the capture file and returns the number of frames in it.
+    uint64_t StopRecording();
+
+    // Feeds the frames of a capture file back through Update, |speed| times
+    // as fast as they were recorded or as fast as possible with 0, and from
+    // the start again with |loop|. Returns false if the file is not a
+    // capture file or holds no frames.
+    bool StartReplay(const std::string &path, double speed, bool loop);
+    void StopReplay();
+    // size of the first replayed frame, 0 if nothing was replayed
+    int32_t replay_width() const { return replay_width_.load(); }
+    int32_t replay_height() const { return replay_height_.load(); }
+
+    // Stops feeding the texture and unregisters it without waiting for the
+    // raster thread. |retired| is called, possibly on another thread, once
+    // the engine released every buffer it fetched; only then the frame can
+    // be destroyed without blocking. The frame stops counting towards its
+    // budget and no longer uses its workers. Nothing else may be called
+    // after this.
+    void Retire(std::function<void()> retired);
+
+    // Only once Retire reported the frame as retired.
+    ~Frame();
+
+private:
+    struct Slot
+    {
+        uint8_t *buffer;
+        PixelBuffer pixel_buffer;
+        // content version the buffer holds
+        uint64_t version;
+        bool pooled;
+        // how a buffer that is not pooled goes back to the caller
+        BufferRelease release;
+        // shows the placeholder pixel, |buffer| is null
+        bool placeholder;
+        // FrameStats::Now() when the content was submitted and published
+        int64_t submitted_at;
+        int64_t published_at;
+    };
+
+    // an unconverted Update in kCoalesce mode
+    struct Source
+    {
+        uint8_t *buffer;
+        int32_t width;
+        int32_t height;
+        int32_t stride;
+        PixelFormat format;
+        // bytes counted in foreign_bytes_
+        size_t size;
+        BufferRelease release;
+        uint64_t version;
+        int64_t submitted_at;
+        int64_t published_at;
+    };
+
+    // what a producer submitted, to recognize it when it comes again
+    struct ContentKey
+    {
+        // false if duplicates are not checked
+        bool checked;
+        uint64_t hash;
+        int32_t width;
+        int32_t height;
+        int32_t stride;
+        PixelFormat format;
+        // of compressed content, which is hashed before it is decoded
+        ImageCodec codec;
+        // the same frame is downscaled differently once this changes
+        int32_t display_width;
+        int32_t display_height;
+    };
+
+    struct Damage
+    {
+        uint64_t version;
+        int32_t x;
+        int32_t y;
+        int32_t width;
+        int32_t height;
+    };
+
+    // number of damaged rectangles remembered to bring stale slots up to date
+    static constexpr size_t kDamageHistory = 32;
+
+    bool PublishUpdate(uint8_t *buffer, int32_t width, int32_t height, int32_t stride, PixelFormat format,
+                       int64_t submitted_at, bool notify, BufferRelease release, const ContentKey &key);
+    // Hashes the |size| bytes of |data| into |key|, whose shape is filled in
+    // already, and returns true if it is what the texture shows. Returns
+    // false without hashing if duplicates are not checked.
+    bool IsDuplicate(const uint8_t *data, size_t size, ContentKey *key);
+    // remembers the content of |key| as what the publish in progress shows
+    void RememberContent(const ContentKey *key);
+    // |key|, if set, describes what a producer submitted as |buffer|
+    void Publish(uint8_t *buffer, int32_t width, int32_t height, bool pooled, int64_t submitted_at,
+                 bool notify = true, bool scaled = false, BufferRelease release = {},
+                 const ContentKey *key = nullptr);
+    // publishes the filled pooled |buffer|, downscaled first if needed
+    void PublishPooled(uint8_t *buffer, int32_t width, int32_t height, int64_t submitted_at, bool notify,
+                       const ContentKey &key);
+    bool ScaledSize(int32_t width, int32_t height, int32_t *scaled_width, int32_t *scaled_height) const;
+    void PublishSource(uint8_t *buffer, int32_t width, int32_t height, int32_t stride,
+                       PixelFormat format, int64_t submitted_at, BufferRelease release, const ContentKey &key);
+    void NotifyFrameAvailable(bool notify);
+    void StartPacer();
+    void StopPacer();
+    void WakePacer();
+    void Pace();
+    void ConvertSource();
+    PixelBuffer *TrackFetch(PixelBuffer *pixel_buffer, uint64_t version,
+                                          int64_t submitted_at, int64_t published_at);
+    static void OnPixelBufferRelease(void *release_context);
+    bool PrepareBackingSlot(Slot &slot);
+    void PublishBackingSlot(Slot &slot, int64_t submitted_at, size_t bytes);
+    void ConvertFrame(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                      int32_t width, int32_t height, uint8_t *dst) const;
+    void ScaleFrame(PixelFormat format, const uint8_t *src, int32_t src_stride, int32_t width,
+                    int32_t height, uint8_t *dst, int32_t dst_width, int32_t dst_height) const;
+    void CopyRect(uint8_t *dst, const uint8_t *src, int32_t src_stride,
+                  int32_t x, int32_t y, int32_t width, int32_t height) const;
+    static void CopyRows(uint8_t *dst, size_t dst_stride, const uint8_t *src, ptrdiff_t src_stride,
+                         size_t row_bytes, int32_t rows);
+    void RecordDamage(int32_t x, int32_t y, int32_t width, int32_t height);
+    void Recycle(Slot &slot);
+    // caller allocated buffers the frame took over or handed back, also
+    // counted in the budget's total
+    void AddForeignBytes(size_t bytes);
+    void RemoveForeignBytes(size_t bytes);
+    void ReleaseForeign(uint8_t *buffer, const BufferRelease &release);
+    void FreeSource(Source &source);
+    void PublishPlaceholder();
+    void EnforceBudget();
+    const PixelBuffer *FetchSharedRing();
+    void WatchSharedRing(SharedFrameRing *ring);
+    void ReleaseRetiredRings();
+    static void OnSharedRingRelease(void *release_context);
+    void RecordFrame(const uint8_t *buffer, int32_t width, int32_t height, int32_t stride, PixelFormat format,
+                     int64_t submitted_at);
+    void Replay(std::unique_ptr<CaptureReader> reader, double speed, bool loop);
+    static void FreeReplayBuffer(void *context, uint8_t *buffer);
+
+    BufferPool pool_;
+    // producers publish into the back slot, the raster thread reads the front
+    // slot, so neither ever blocks the other
+    TripleBuffer<Slot> handoff_;
+    TextureBridge *bridge_ = nullptr;
+    WorkerPool *workers_ = nullptr;
+    MemoryBudget *budget_ = nullptr;
+    int64_t texture_id_;
+    // serializes producers (platform thread and native callers), never taken
+    // by the raster thread
+    std::mutex producer_mutex_;
+    // a frame was published without notifying the engine
+    std::atomic<bool> notify_pending_{false};
+    // caller allocated buffers in the slots and sources
+    std::atomic<size_t> foreign_bytes_{0};
+    std::atomic<int64_t> last_active_{0};
+    // the content was evicted and no full frame came since, settled once the
+    // raster thread gave back the buffers it held (guarded by producer_mutex_)
+    std::atomic<bool> evicted_{false};
+    bool eviction_settled_ = false;
+
+    std::atomic<PacingMode> pacing_mode_{PacingMode::kImmediate};
+    std::atomic<DuplicateCheck> duplicate_check_{DuplicateCheck::kOff};
+    std::atomic<int32_t> display_width_{0};
+    std::atomic<int32_t> display_height_{0};
+    FrameStats stats_;
+    // raster thread only: the last fetch, for the release timestamps
+    uint64_t fetched_version_ = 0;
+    int64_t fetched_at_ = 0;
+    // 0 unless the last fetch was the first one of its content
+    int64_t fetched_submitted_at_ = 0;
+    // raw frames handed to the pacer in kCoalesce mode, the producer frees
+    // them once they come back as its back slot
+    TripleBuffer<Source> sources_;
+
+    // producer side view of the newest content, guarded by producer_mutex_.
+    // It is packed RGBA unless the newest frame is an unconverted source.
+    const uint8_t *latest_buffer_ = nullptr;
+    int32_t latest_width_ = 0;
+    int32_t latest_height_ = 0;
+    int32_t latest_stride_ = 0;
+    PixelFormat latest_format_ = PixelFormat::kRGBA;
+    // the newest full frame was downscaled, regions cannot be mapped onto it
+    bool latest_scaled_ = false;
+    uint64_t content_version_ = 0;
+    // every change after this version is in damage_, older slots need a
+    // full copy
+    uint64_t damage_floor_ = 0;
+    std::array<Damage, kDamageHistory> damage_{};
+    size_t damage_head_ = 0;
+    size_t damage_count_ = 0;
+    // the last hashed submission and the content version it was published
+    // as, it is only shown while that is still the newest
+    ContentKey shown_content_{};
+    uint64_t shown_content_version_ = 0;
+
+    struct RetiredRing
+    {
+        std::unique_ptr<SharedMemory> memory;
+        std::unique_ptr<SharedFrameRing> ring;
+    };
+
+    std::unique_ptr<SharedMemory> shared_memory_;
+    std::unique_ptr<SharedFrameRing> shared_ring_;
+    // what the raster thread reads, cleared before the ring is unmapped
+    std::atomic<SharedFrameRing *> active_ring_{nullptr};
+    // raster fetches of ring slots that have not been released yet
+    std::atomic<int> ring_readers_{0};
+    // unbound rings that are still mapped until the raster thread released
+    // them, guarded by producer_mutex_
+    std::vector<RetiredRing> retired_rings_;
+    PixelBuffer ring_pixel_buffer_{};
+    std::thread ring_watcher_;
+    std::atomic<bool> watching_ring_{false};
+
+    // set while recorder_ is, so producers only lock when recording
+    std::atomic<bool> recording_{false};
+    std::mutex recorder_mutex_;
+    std::unique_ptr<CaptureRecorder> recorder_;
+
+    std::mutex replay_mutex_;
+    std::condition_variable replay_stop_;
+    bool replay_stopping_ = false;
+    std::thread replayer_;
+    std::atomic<int32_t> replay_width_{0};
+    std::atomic<int32_t> replay_height_{0};
+
+    // kCoalesce mode: converts the newest source whenever the raster thread
+    // has fetched the last converted one. It is woken through a semaphore so
+    // that the raster thread never waits for a lock.
+    std::mutex pacer_mutex_;
+    Semaphore pacer_wake_;
+    std::atomic<bool> pacer_woken_{false};
+    std::atomic<bool> pacer_stopping_{false};
+    std::thread pacer_;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef FRAME_DELTA_H
+#define FRAME_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_features.h"
+
+// Deltas between consecutive packed RGBA frames of the same size, for
+// content that barely changes from frame to frame, like remote desktops.
+// Layout, in host byte order:
+//
+//   FrameDeltaHeader
+//   a sequence of uint32 ops over the frame's pixels, row after row:
+//     the low 31 bits count pixels; with the high bit set those pixels are
+//     unchanged, otherwise that many pixels follow, XORed with the previous
+//     frame's
+//
+// Pixels after the last op are unchanged, so an unchanged frame is only the
+// header. Unchanged runs shorter than two pixels are folded into the XORed
+// runs around them, which bounds a delta to MaxFrameDeltaSize.
+
+struct FrameDeltaHeader
+{
+    char magic[4];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+};
+
+constexpr char kFrameDeltaMagic[4] = {'T', 'I', 'D', 'L'};
+constexpr uint32_t kFrameDeltaVersion = 1;
+constexpr uint32_t kFrameDeltaUnchanged = 0x80000000u;
+
+// Changed pixels are reported as at most this many row bands.
+constexpr size_t kMaxDeltaBands = 8;
+
+struct DeltaBand
+{
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+// What ReadFrameDeltaInfo found in a delta.
+struct FrameDeltaInfo
+{
+    int32_t width;
+    int32_t height;
+    uint64_t changed_pixels;
+    // cover every changed pixel, collapsed into their bounding box if there
+    // are more than kMaxDeltaBands of them
+    size_t band_count;
+    DeltaBand bands[kMaxDeltaBands];
+};
+
+// Writes |count| bytes of |a| XOR |b| to |dst|, which may be |a| or |b|.
+typedef void (*XorBytesKernel)(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count);
+// Number of leading pixels of the |count| RGBA pixels at |a| and |b| that are
+// the same, or that differ.
+typedef size_t (*PixelRunKernel)(const uint8_t *a, const uint8_t *b, size_t count);
+
+struct DeltaKernels
+{
+    XorBytesKernel xor_bytes;
+    PixelRunKernel equal_run;
+    PixelRunKernel different_run;
+};
+
+// Kernels of |tier|, falling back to lower tiers for what it lacks.
+const DeltaKernels &DeltaKernelsFor(SimdTier tier);
+
+// Kernels for the running CPU, selected once.
+const DeltaKernels &ActiveDeltaKernels();
+
+// Largest delta EncodeFrameDelta writes for a |width| x |height| frame.
+size_t MaxFrameDeltaSize(int32_t width, int32_t height);
+
+// Encodes the delta that turns |previous| into |current|, both RGBA frames
+// whose rows are |stride| bytes apart, into |out|, which has to hold
+// MaxFrameDeltaSize bytes. Returns the size of the delta.
+size_t EncodeFrameDelta(const uint8_t *previous, const uint8_t *current, int32_t width, int32_t height,
+                        int32_t stride, uint8_t *out, const DeltaKernels &kernels = ActiveDeltaKernels());
+
+// Checks that the |size| bytes at |data| are a well formed delta, without
+// reading past them, and describes what it changes. Returns false if not.
+bool ReadFrameDeltaInfo(const uint8_t *data, size_t size, FrameDeltaInfo *info);
+
+// Applies a delta ReadFrameDeltaInfo accepted to the packed RGBA frame |dst|
+// of the size it describes. Returns false, possibly after applying part of
+// it, if the delta turns out to be malformed.
+bool ApplyFrameDelta(const uint8_t *data, size_t size, uint8_t *dst,
+                     const DeltaKernels &kernels = ActiveDeltaKernels());
+
+// Scalar reference kernels, the SIMD kernels finish their runs with them.
+void ScalarXorBytes(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count);
+size_t ScalarEqualRun(const uint8_t *a, const uint8_t *b, size_t count);
+size_t ScalarDifferentRun(const uint8_t *a, const uint8_t *b, size_t count);
+
+// Kernel tables of the SIMD translation units, null where the target
+// architecture has no such tier.
+const DeltaKernels *Sse2DeltaKernels();
+const DeltaKernels *Avx2DeltaKernels();
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef FRAME_HOST_H
+#define FRAME_HOST_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "frame.h"
+#include "memory_budget.h"
+#include "pattern_generator.h"
+#include "texture_bridge.h"
+#include "worker_pool.h"
+
+// The frames of one plugin instance by the id the Dart side gave them. The
+// platform plugins only translate their method calls into calls on this.
+class FrameHost
+{
+public:
+    // |bridge| has to outlive the host.
+    explicit FrameHost(TextureBridge *bridge);
+    // Retires every frame. Frames the engine has not released yet are
+    // destroyed when the bridge reports them as unregistered, or never if
+    // the bridge is destroyed first.
+    ~FrameHost();
+
+    FrameHost(const FrameHost &) = delete;
+    FrameHost &operator=(const FrameHost &) = delete;
+
+    // Creates the frame for |id| unless it already exists and makes it
+    // reachable through the C ABI.
+    Frame *Register(int id);
+    // Returns false if there is no frame |id|. Native callers still inside
+    // the frame are waited for, the raster thread is not: the frame is
+    // retired and destroyed by a later call once the engine released its
+    // buffers.
+    bool Unregister(int id);
+    // Unregisters every frame of |ids| that exists at once and returns how
+    // many there were.
+    size_t UnregisterAll(const std::vector<int> &ids);
+    // Destroys the retired frames the engine is done with.
+    void Collect();
+    // frames that were unregistered but not destroyed yet
+    size_t retired_count() const { return retired_.size(); }
+
+    // null if there is no frame |id|
+    Frame *Find(int id) const;
+    // FrameRegistry handle of frame |id|, 0 if there is none
+    int64_t Handle(int id) const;
+
+    WorkerPool &workers() { return workers_; }
+    MemoryBudget &budget() { return budget_; }
+    PatternGenerator &patterns() { return patterns_; }
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<Frame> frame;
+        int64_t handle;
+    };
+
+    // shared with the bridge's unregister callback, which may come after
+    // the host is gone
+    struct RetireState
+    {
+        std::mutex mutex;
+        std::atomic<bool> done{false};
+        // a frame the host left behind, destroyed by the callback
+        std::unique_ptr<Frame> orphan;
+    };
+
+    struct Retired
+    {
+        std::unique_ptr<Frame> frame;
+        std::shared_ptr<RetireState> state;
+    };
+
+    void Retire(Entry &entry);
+
+    TextureBridge *bridge_;
+    // shared by all frames, declared first so that they outlive them
+    WorkerPool workers_;
+    MemoryBudget budget_;
+    std::unordered_map<int, Entry> frames_;
+    std::vector<Retired> retired_;
+    // declared last, it stops touching the frames before they are destroyed
+    PatternGenerator patterns_;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef FRAME_REGISTRY_H
+#define FRAME_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Frame;
+
+// Process wide lookup of frames by native handle, used by the C ABI so that
+// frames can be updated from any thread without going through the channel.
+//
+// Handles index a table of slots that only ever grows by whole chunks, so a
+// lookup is an array access and never waits for a rehash or a lock. Each slot
+// packs a generation, a live bit and the number of callers inside it into one
+// atomic word: lookups pin a slot with a single compare and swap, removing
+// clears the live bit, waits for the pins to drain and bumps the generation,
+// so handles of removed frames never resolve again, not even once the slot
+// is reused.
+class FrameRegistry
+{
+public:
+    static FrameRegistry &Instance();
+
+    // Add and Remove are serialized, lookups can run concurrently with both.
+    int64_t Add(Frame *frame);
+    // Returns once no caller is inside the frame anymore.
+    void Remove(int64_t handle);
+
+    // Calls |visit| with the frame registered under |handle|. The frame cannot
+    // be removed while |visit| runs. Returns false if there is no such frame.
+    template <typename F>
+    bool With(int64_t handle, F &&visit)
+    {
+        Slot *slot = Pin(handle);
+        if (slot == nullptr)
+            return false;
+        visit(*slot->frame.load(std::memory_order_acquire));
+        Unpin(slot);
+        return true;
+    }
+
+    // Calls |visit| with a function that resolves handles to frames, or null
+    // for unknown ones. Frames it returned stay registered until |visit|
+    // returns.
+    template <typename F>
+    void WithAll(F &&visit)
+    {
+        std::vector<Slot *> pinned;
+        visit([this, &pinned](int64_t handle) -> Frame *
+              {
+                  Slot *slot = Pin(handle);
+                  if (slot == nullptr)
+                      return nullptr;
+                  pinned.push_back(slot);
+                  return slot->frame.load(std::memory_order_acquire);
+              });
+        for (Slot *slot : pinned)
+            Unpin(slot);
+    }
+
+    size_t size() const { return size_.load(); }
+
+private:
+    // slot state: generation << 32 | live << 31 | pins
+    static constexpr uint64_t kLive = 1ull << 31;
+    static constexpr uint64_t kPinMask = kLive - 1;
+    static constexpr int kGenerationShift = 32;
+    // handles keep the generation in bits 32 to 62, so they stay positive
+    static constexpr uint32_t kGenerationMask = 0x7FFFFFFF;
+    static constexpr size_t kChunkBits = 10;
+    static constexpr size_t kChunkSize = size_t{1} << kChunkBits;
+    static constexpr size_t kMaxChunks = 4096;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> state{uint64_t{1} << kGenerationShift};
+        std::atomic<Frame *> frame{nullptr};
+    };
+
+    FrameRegistry() = default;
+
+    Slot *Find(uint32_t index) const
+    {
+        Slot *chunk = chunks_[index >> kChunkBits].load(std::memory_order_acquire);
+        return chunk != nullptr ? &chunk[index & (kChunkSize - 1)] : nullptr;
+    }
+
+    Slot *Pin(int64_t handle)
+    {
+        uint64_t index = static_cast<uint64_t>(handle) & 0xFFFFFFFF;
+        uint64_t generation = static_cast<uint64_t>(handle) >> kGenerationShift;
+        if (handle <= 0 || index >= kChunkSize * kMaxChunks)
+            return nullptr;
+        Slot *slot = Find(static_cast<uint32_t>(index));
+        if (slot == nullptr)
+            return nullptr;
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        do
+        {
+            if ((state >> kGenerationShift) != generation || (state & kLive) == 0)
+                return nullptr;
+        } while (!slot->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire));
+        return slot;
+    }
+
+    static void Unpin(Slot *slot) { slot->state.fetch_sub(1, std::memory_order_release); }
+
+    // guards Add and Remove, never taken by lookups
+    std::mutex mutex_;
+    std::array<std::atomic<Slot *>, kMaxChunks> chunks_{};
+    // owns the chunks, they are never moved or freed while the process runs
+    std::vector<std::unique_ptr<Slot[]>> storage_;
+    std::vector<uint32_t> free_;
+    uint32_t used_ = 0;
+    std::atomic<size_t> size_{0};
+};
+
+#endif
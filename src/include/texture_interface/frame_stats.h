@@ -0,0 +1,108 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Log-linear histogram of durations in nanoseconds, four buckets per power
+// of two. Recording is a single relaxed atomic increment.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t kBuckets = 256;
+    typedef std::array<uint64_t, kBuckets> Counts;
+
+    void Record(int64_t nanoseconds);
+    // copies the counts, clearing them if |reset| is set
+    void Collect(Counts &counts, bool reset);
+
+    // |percentile| in [0, 1] of |counts| in microseconds, 0 if empty
+    static double Percentile(const Counts &counts, double percentile);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+};
+
+// Mirrors ti_frame_stats. Counts cover the window since the last reset,
+// latencies are in microseconds.
+struct FrameStatsSnapshot
+{
+    uint64_t frames_submitted;
+    uint64_t frames_displayed;
+    uint64_t frames_dropped;
+    uint64_t bytes_submitted;
+    double interval_seconds;
+    double fps;
+    double bytes_per_second;
+    // submit until the frame is published to the raster thread
+    double take_p50_us;
+    double take_p99_us;
+    // published until the raster thread fetches it
+    double queue_p50_us;
+    double queue_p99_us;
+    // fetched until the engine releases the pixel buffer
+    double upload_p50_us;
+    double upload_p99_us;
+    // submit until release
+    double total_p50_us;
+    double total_p99_us;
+    // resent frames that were not published, see DuplicateCheck
+    uint64_t frames_skipped;
+};
+
+// Per frame instrumentation. The Record* calls are wait-free and can be made
+// from the producer and raster threads concurrently.
+class FrameStats
+{
+public:
+    FrameStats();
+
+    // steady clock timestamp in nanoseconds
+    static int64_t Now();
+
+    void RecordSubmit(size_t bytes);
+    void RecordTake(int64_t submitted_at, int64_t now);
+    void RecordFetch(int64_t published_at, int64_t now);
+    void RecordRelease(int64_t submitted_at, int64_t fetched_at, int64_t now);
+    void RecordDrop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+    void RecordSkip() { skipped_.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t dropped_frames() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t skipped_frames() const { return skipped_.load(std::memory_order_relaxed); }
+
+    // Summarizes the window since the last reset and starts a new one if
+    // |reset| is set.
+    FrameStatsSnapshot Snapshot(bool reset);
+
+private:
+    struct Totals
+    {
+        uint64_t submitted;
+        uint64_t displayed;
+        uint64_t dropped;
+        uint64_t skipped;
+        uint64_t bytes;
+        int64_t at;
+    };
+
+    Totals Current() const;
+
+    LatencyHistogram take_;
+    LatencyHistogram queue_;
+    LatencyHistogram upload_;
+    LatencyHistogram total_;
+    // lifetime totals, the window subtracts window_start_
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> displayed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> bytes_{0};
+
+    std::mutex snapshot_mutex_;
+    Totals window_start_;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "worker_pool.h"
+
+// Compressed frames Frame::UpdateEncoded decodes natively, so that MJPEG
+// cameras and image sequences need no decoding on the Dart side.
+enum class ImageCodec : int32_t
+{
+    kUnknown = 0,
+    kQoi = 1,
+    // baseline and extended Huffman JPEG with 8 bit samples, grayscale or
+    // YCbCr
+    kJpeg = 2,
+};
+
+struct ImageInfo
+{
+    ImageCodec codec;
+    int32_t width;
+    int32_t height;
+};
+
+// Larger images are rejected before anything is allocated for them.
+constexpr int32_t kMaxImageDimension = 1 << 15;
+constexpr int64_t kMaxImagePixels = int64_t{1} << 26;
+
+// Recognizes the codec from the first bytes of |data| and reads the image
+// size from its header. Returns false if it is not an image one of the
+// decoders supports, progressive or CMYK JPEGs for example.
+bool ReadImageInfo(const uint8_t *data, size_t size, ImageInfo *info);
+
+// Decodes |data| as described by ReadImageInfo into the packed RGBA image
+// |dst|. Stages that can be split are run on |workers|, which may be null.
+// Returns false if the data is corrupt, |dst| is partly written then.
+bool DecodeImage(const ImageInfo &info, const uint8_t *data, size_t size, uint8_t *dst, WorkerPool *workers);
+
+// the codecs behind ReadImageInfo and DecodeImage
+bool ReadQoiInfo(const uint8_t *data, size_t size, ImageInfo *info);
+bool DecodeQoi(const uint8_t *data, size_t size, uint8_t *dst, int32_t width, int32_t height);
+bool ReadJpegInfo(const uint8_t *data, size_t size, ImageInfo *info);
+bool DecodeJpeg(const uint8_t *data, size_t size, uint8_t *dst, int32_t width, int32_t height,
+                WorkerPool *workers);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// A file mapped into memory, read and write for files this process creates
+// and read only for existing ones. Paths are UTF-8.
+class MappedFile
+{
+public:
+    // Creates (or truncates) the file at |path| with |size| bytes.
+    static std::unique_ptr<MappedFile> Create(const std::string &path, size_t size);
+    // Maps an existing, non-empty file read only.
+    static std::unique_ptr<MappedFile> Open(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Grows or shrinks a created file and maps it again, data() can move.
+    // Returns false and leaves the file unmapped on failure.
+    bool Resize(size_t size);
+
+    uint8_t *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    bool Map(size_t size, bool writable);
+    void Unmap();
+
+    uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+#endif
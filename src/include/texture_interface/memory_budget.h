@@ -0,0 +1,57 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class Frame;
+
+// Caps the pixel memory held by the frames of a plugin instance. Once they
+// hold more than the limit, free buffers are trimmed first and then the least
+// recently used idle frames are evicted: their buffers are freed and they show
+// a placeholder until their next full frame.
+class MemoryBudget
+{
+public:
+    // nanoseconds a frame has to go without updates or fetches before it can
+    // be evicted
+    static constexpr int64_t kDefaultIdleTime = 2'000'000'000;
+
+    MemoryBudget() = default;
+
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    // |limit_bytes| of 0 disables the budget.
+    void Configure(size_t limit_bytes, int64_t idle_time = kDefaultIdleTime);
+    size_t limit_bytes() const { return limit_bytes_.load(); }
+
+    void Add(Frame *frame);
+    // Waits for an eviction of |frame| that is in progress.
+    void Remove(Frame *frame);
+
+    // Called by frames after they might have grown, |active| is never evicted.
+    // Only locks once the frames hold more than the limit. Must not be
+    // called with the frame's producer lock held.
+    void Enforce(const Frame *active = nullptr);
+
+    // pixel memory currently held by all frames
+    size_t ResidentBytes() const { return resident_total_.load(); }
+
+    // Running total of that memory, frames and their pools add what they
+    // allocate or take over and subtract what they free or hand back, so
+    // Enforce only scans the frames once the total is over the limit.
+    std::atomic<size_t> *resident_total() { return &resident_total_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Frame *> frames_;
+    std::atomic<size_t> limit_bytes_{0};
+    std::atomic<int64_t> idle_time_{kDefaultIdleTime};
+    std::atomic<size_t> resident_total_{0};
+};
+
+#endif
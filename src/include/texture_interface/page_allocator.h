@@ -0,0 +1,52 @@
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Where BufferPool gets its memory from. By default that is the heap. At 4K
+// and 8K the copy and conversion loops also pay for TLB misses and, on
+// multi-socket machines, for pages on another node, so the process can ask
+// for huge pages and for pages on the NUMA node of the allocating thread
+// instead. Whatever the OS refuses falls back to regular pages, and those
+// to the heap.
+struct PagePolicy
+{
+    // huge pages (transparent ones or hugetlbfs on Linux, large pages on
+    // Windows, which need the lock pages in memory privilege) for buffers
+    // of at least kMinHugePageBuffer bytes
+    bool huge_pages;
+    // pages placed on the node of the thread that allocates them
+    bool numa_local;
+};
+
+// Smaller buffers would waste too much of their last huge page.
+constexpr size_t kMinHugePageBuffer = 16 << 20;
+
+struct PageAllocation
+{
+    uint8_t *data;
+    // bytes allocated, at least what was asked for
+    size_t size;
+    // mapped from the OS rather than taken from the heap
+    bool mapped;
+    // backed by huge pages as far as the OS told
+    bool huge;
+    // NUMA node the pages were bound to, -1 if left to the OS
+    int32_t node;
+};
+
+// The process wide policy, applies to buffers allocated from then on.
+void SetPagePolicy(const PagePolicy &policy);
+PagePolicy GetPagePolicy();
+
+// Allocates |size| bytes aligned to at least 64 bytes following the policy.
+// |data| is null if even the heap is exhausted.
+PageAllocation AllocatePages(size_t size);
+void FreePages(const PageAllocation &allocation);
+
+// NUMA node of the CPU the calling thread runs on, -1 if unknown or NUMA
+// placement is not asked for.
+int32_t CurrentNumaNode();
+
+#endif
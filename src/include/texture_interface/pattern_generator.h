@@ -0,0 +1,77 @@
+#ifndef PATTERN_GENERATOR_H
+#define PATTERN_GENERATOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "frame.h"
+#include "test_pattern.h"
+#include "worker_pool.h"
+
+struct PatternConfig
+{
+    TestPattern pattern;
+    int32_t width;
+    int32_t height;
+    // frames per second, 0 for a new frame whenever the last one was
+    // fetched
+    double fps;
+    // 0xAARRGGBB for kSolid
+    uint32_t color;
+};
+
+// Feeds test patterns into frames through their buffer pools, as a load
+// generator for many textures at once. One thread serves all frames of a
+// plugin instance in the order their next frame is due; frames that fall
+// behind skip the frames they missed instead of bursting. Large frames are
+// rendered in bands on |workers|.
+class PatternGenerator
+{
+public:
+    // |workers| has to outlive the generator.
+    explicit PatternGenerator(WorkerPool *workers = nullptr);
+    ~PatternGenerator();
+
+    PatternGenerator(const PatternGenerator &) = delete;
+    PatternGenerator &operator=(const PatternGenerator &) = delete;
+
+    // Starts feeding |frame|, or changes what it is fed. Returns false for
+    // an invalid config.
+    bool Start(Frame *frame, const PatternConfig &config);
+    // Returns false if |frame| was not fed. Once this returns the generator
+    // no longer touches |frame|.
+    bool Stop(Frame *frame);
+
+    size_t active_count() const;
+
+private:
+    struct Stream
+    {
+        Frame *frame;
+        PatternConfig config;
+        uint64_t index;
+        // FrameStats::Now() the next frame is due at
+        int64_t due_at;
+    };
+
+    // how often fps 0 streams check whether their last frame was fetched
+    static constexpr int64_t kReadyPollInterval = 1000000;
+
+    void Loop();
+    void Render(const Stream &stream);
+
+    WorkerPool *workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<Stream> streams_;
+    // the frame the thread renders into outside the lock, Stop waits for it
+    Frame *rendering_ = nullptr;
+    bool stopping_ = false;
+    // started with the first stream
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <cstdint>
+
+#include "cpu_features.h"
+#include "pixel_format.h"
+
+// Row kernels converting |width| pixels to packed RGBA.
+typedef void (*PackedRowKernel)(const uint8_t *src, uint8_t *dst, int32_t width);
+typedef void (*Nv12RowKernel)(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int32_t width);
+typedef void (*I420RowKernel)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int32_t width);
+
+struct ConvertKernels
+{
+    PackedRowKernel bgra;
+    PackedRowKernel rgb24;
+    PackedRowKernel rgb565;
+    Nv12RowKernel nv12;
+    I420RowKernel i420;
+};
+
+// Kernels of |tier|, falling back to lower tiers for what it lacks.
+const ConvertKernels &ConvertKernelsFor(SimdTier tier);
+
+// Kernels for the running CPU, selected once.
+const ConvertKernels &ActiveConvertKernels();
+
+// Converts rows [row_begin, row_end) of a |width| x |height| image laid out as
+// described in pixel_format.h. |dst| is the start of the whole packed RGBA
+// image, so disjoint row ranges can be converted concurrently.
+void ConvertRows(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                 int32_t width, int32_t height, uint8_t *dst,
+                 int32_t row_begin, int32_t row_end,
+                 const ConvertKernels &kernels = ActiveConvertKernels());
+
+// Converts row |row| of a |width| x |height| image into |dst_row|, which
+// holds |width| RGBA pixels.
+void ConvertRow(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                int32_t width, int32_t height, int32_t row, uint8_t *dst_row,
+                const ConvertKernels &kernels = ActiveConvertKernels());
+
+// Scalar reference kernels, the SIMD kernels finish their rows with them.
+void ScalarBgraRow(const uint8_t *src, uint8_t *dst, int32_t width);
+void ScalarRgb24Row(const uint8_t *src, uint8_t *dst, int32_t width);
+void ScalarRgb565Row(const uint8_t *src, uint8_t *dst, int32_t width);
+void ScalarNv12Row(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int32_t width);
+void ScalarI420Row(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int32_t width);
+
+// Kernel tables of the SIMD translation units, null where the target
+// architecture has no such tier.
+const ConvertKernels *Sse2ConvertKernels();
+const ConvertKernels *Avx2ConvertKernels();
+
+// BT.601 limited range in 6 bit fixed point. Luma is scaled as
+// ((y * 257 * kYuvY) >> 16) - kYuvYBias, which fits a 16 bit multiply-high
+// and already includes the -16 offset and the rounding term. The SIMD
+// kernels use the same arithmetic in 16 bit lanes, so all tiers produce
+// identical output.
+constexpr int kYuvY = 18997;
+constexpr int kYuvYBias = 1160;
+constexpr int kYuvVToR = 102;
+constexpr int kYuvUToG = 25;
+constexpr int kYuvVToG = 52;
+constexpr int kYuvUToB = 129;
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Source layouts Frame can convert to the RGBA that FlutterDesktopPixelBuffer
+// expects. The values are part of the C ABI (TI_FORMAT_*).
+//
+// Planar formats are expected in one buffer: NV12 is a luma plane of |height|
+// rows followed by an interleaved UV plane of (height + 1) / 2 rows, both
+// |stride| bytes apart. I420 is a luma plane followed by U and V planes of
+// (height + 1) / 2 rows, (stride + 1) / 2 bytes apart. YUV is BT.601 limited
+// range.
+enum class PixelFormat : int32_t
+{
+    kRGBA = 0,
+    kBGRA = 1,
+    kRGB24 = 2,
+    kRGB565 = 3,
+    kNV12 = 4,
+    kI420 = 5,
+};
+
+inline bool IsValidPixelFormat(int32_t format)
+{
+    return format >= static_cast<int32_t>(PixelFormat::kRGBA) && format <= static_cast<int32_t>(PixelFormat::kI420);
+}
+
+// Row pitch of tightly packed rows, the luma pitch for planar formats.
+inline int32_t PackedStride(PixelFormat format, int32_t width)
+{
+    switch (format)
+    {
+    case PixelFormat::kRGBA:
+    case PixelFormat::kBGRA:
+        return width * 4;
+    case PixelFormat::kRGB24:
+        return width * 3;
+    case PixelFormat::kRGB565:
+        return width * 2;
+    case PixelFormat::kNV12:
+    case PixelFormat::kI420:
+        // NV12 needs an even pitch for its UV pairs
+        return (width + 1) & ~1;
+    }
+    return 0;
+}
+
+// Size of a buffer in |format| with |height| rows |stride| bytes apart.
+inline size_t SourceBytes(PixelFormat format, int32_t stride, int32_t height)
+{
+    size_t plane = static_cast<size_t>(stride) * height;
+    size_t chroma_rows = (height + 1) / 2;
+    switch (format)
+    {
+    case PixelFormat::kNV12:
+        return plane + static_cast<size_t>(stride) * chroma_rows;
+    case PixelFormat::kI420:
+        return plane + 2 * static_cast<size_t>((stride + 1) / 2) * chroma_rows;
+    default:
+        return plane;
+    }
+}
+
+// Bytes per pixel of the first plane.
+inline int32_t BytesPerPixel(PixelFormat format)
+{
+    switch (format)
+    {
+    case PixelFormat::kRGBA:
+    case PixelFormat::kBGRA:
+        return 4;
+    case PixelFormat::kRGB24:
+        return 3;
+    case PixelFormat::kRGB565:
+        return 2;
+    case PixelFormat::kNV12:
+    case PixelFormat::kI420:
+        return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PIXEL_SCALE_H
+#define PIXEL_SCALE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_features.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+
+// Downscaling of frames to the size they are displayed at. Shrinking by two
+// or more averages every source pixel a destination pixel covers (box
+// filter), smaller factors interpolate between the nearest four (bilinear).
+
+// Adds |count| bytes of |src| to |sums|.
+typedef void (*AccumulateRowKernel)(const uint8_t *src, uint32_t *sums, size_t count);
+// Blends |count| bytes of two rows, |weight| of |bottom| in 1/256.
+typedef void (*BlendRowsKernel)(const uint8_t *top, const uint8_t *bottom, uint8_t *dst, size_t count,
+                                int32_t weight);
+
+struct ScaleKernels
+{
+    AccumulateRowKernel accumulate;
+    BlendRowsKernel blend;
+};
+
+// Kernels of |tier|, falling back to lower tiers for what it lacks.
+const ScaleKernels &ScaleKernelsFor(SimdTier tier);
+
+// Kernels for the running CPU, selected once.
+const ScaleKernels &ActiveScaleKernels();
+
+// Size a |width| x |height| frame is scaled to so that it still covers
+// |display_width| x |display_height| pixels at its own aspect ratio. Returns
+// false if that is not smaller than the frame or no display size is set.
+bool DownscaledSize(int32_t width, int32_t height, int32_t display_width, int32_t display_height,
+                    int32_t *scaled_width, int32_t *scaled_height);
+
+// Scales a |width| x |height| image laid out as described in pixel_format.h
+// into rows [row_begin, row_end) of the packed RGBA image |dst|. Only
+// downscaling is supported. Disjoint row ranges can be scaled concurrently.
+void ScaleRows(PixelFormat format, const uint8_t *src, int32_t src_stride,
+               int32_t width, int32_t height, uint8_t *dst,
+               int32_t dst_width, int32_t dst_height,
+               int32_t row_begin, int32_t row_end,
+               const ConvertKernels &convert = ActiveConvertKernels(),
+               const ScaleKernels &scale = ActiveScaleKernels());
+
+// Scalar reference kernels, the SIMD kernels finish their rows with them.
+void ScalarAccumulateRow(const uint8_t *src, uint32_t *sums, size_t count);
+void ScalarBlendRows(const uint8_t *top, const uint8_t *bottom, uint8_t *dst, size_t count, int32_t weight);
+
+// Kernel tables of the SIMD translation units, null where the target
+// architecture has no such tier.
+const ScaleKernels *Sse2ScaleKernels();
+const ScaleKernels *Avx2ScaleKernels();
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef RELEASE_QUEUE_H
+#define RELEASE_QUEUE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Process wide queues of caller owned buffers that frames are done with, for
+// callers that cannot be called back on arbitrary threads and poll instead.
+// Queues are addressed by id, so buffers released after their queue was
+// destroyed are dropped instead of touching freed memory.
+class ReleaseQueue
+{
+public:
+    static int64_t Create();
+    static void Destroy(int64_t queue);
+
+    // Appends |buffer| to |queue|, does nothing if there is no such queue.
+    static void Push(int64_t queue, uint8_t *buffer);
+
+    // Moves up to |capacity| of the oldest buffers of |queue| into |buffers|
+    // and returns how many, or -1 if there is no such queue.
+    static int32_t Poll(int64_t queue, uint8_t **buffers, int32_t capacity);
+
+    // Release callback for Frame::Update, |context| is the queue id.
+    static void OnRelease(void *context, uint8_t *buffer);
+    static void *Context(int64_t queue);
+
+private:
+    struct Queues
+    {
+        std::mutex mutex;
+        std::unordered_map<int64_t, std::vector<uint8_t *>> released;
+        int64_t next_id = 1;
+    };
+
+    static Queues &Instance();
+};
+
+#endif
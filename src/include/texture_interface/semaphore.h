@@ -0,0 +1,32 @@
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#ifndef _WIN32
+#include <semaphore.h>
+#endif
+
+// Counting semaphore, a kernel semaphore object on Windows and an unnamed
+// POSIX semaphore elsewhere. Unlike a condition variable, Post takes no lock
+// and never blocks, so real-time threads can wake a worker with it.
+class Semaphore
+{
+public:
+    Semaphore();
+    ~Semaphore();
+
+    Semaphore(const Semaphore &) = delete;
+    Semaphore &operator=(const Semaphore &) = delete;
+
+    void Post();
+    // blocks until the count is positive and decrements it
+    void Wait();
+
+private:
+#ifdef _WIN32
+    void *handle_ = nullptr;
+#else
+    sem_t semaphore_;
+#endif
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SHARED_FRAME_RING_H
+#define SHARED_FRAME_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Ring of RGBA frame slots in memory shared with another process. The layout
+// only depends on fixed size types so that producers in other languages can
+// implement the protocol below from this header alone; C++ producers can use
+// SharedFrameRing, which needs shared_frame_ring.cpp:
+//
+//   SharedFrameRingHeader     at offset 0
+//   slot i                    at data_offset + i * slot_size
+//
+// The producer writes into any slot that is neither the latest one nor the
+// one pinned by the consumer, then publishes it by storing
+// (sequence << 8) | slot into |latest|. The consumer pins the slot it reads by
+// storing its index into |reading| and re-checking |latest|, so a published
+// slot is never overwritten while the plugin uploads it.
+struct SharedFrameSlotHeader
+{
+    int32_t width;
+    int32_t height;
+    uint64_t sequence;
+};
+
+struct SharedFrameRingHeader
+{
+    static constexpr uint32_t kMagic = 0x52464954; // "TIFR"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kMaxSlots = 8;
+    static constexpr uint32_t kNoSlot = 0xFFFFFFFF;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    // largest frame a slot can hold
+    int32_t width;
+    int32_t height;
+    uint32_t data_offset;
+    uint32_t reserved;
+    std::atomic<uint64_t> latest;
+    std::atomic<uint32_t> reading;
+    uint32_t padding;
+    SharedFrameSlotHeader slots[kMaxSlots];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock free");
+
+class SharedFrameRing
+{
+public:
+    // Bytes of shared memory needed for |slot_count| frames of |width| x |height|.
+    static size_t RequiredSize(uint32_t slot_count, int32_t width, int32_t height);
+
+    // Producer side: lays out a new ring in |memory|. Needs at least three
+    // slots so that a free slot always exists.
+    static std::unique_ptr<SharedFrameRing> Initialize(void *memory, size_t size, uint32_t slot_count,
+                                                       int32_t width, int32_t height);
+
+    // Validates the ring another process laid out in |memory|. Returns null if
+    // the memory does not hold a compatible ring.
+    static std::unique_ptr<SharedFrameRing> Attach(void *memory, size_t size);
+
+    // Producer: returns a slot that can be written, publish it with EndWrite.
+    uint8_t *BeginWrite();
+    void EndWrite(int32_t width, int32_t height);
+
+    // Consumer: pins the newest published slot and returns its pixels, or
+    // null if nothing was published yet. The slot stays pinned until the next
+    // call or Unpin.
+    const uint8_t *AcquireLatest(int32_t *width, int32_t *height);
+    void Unpin();
+
+    uint64_t latest_sequence() const { return header_->latest.load() >> 8; }
+    int32_t width() const { return header_->width; }
+    int32_t height() const { return header_->height; }
+
+private:
+    explicit SharedFrameRing(SharedFrameRingHeader *header)
+        : header_(header), slot_count_(header->slot_count), slot_size_(header->slot_size),
+          data_offset_(header->data_offset) {}
+
+    uint8_t *slot_data(uint32_t slot) const;
+
+    SharedFrameRingHeader *header_;
+    // validated copies, the other process could rewrite the header at any time
+    uint32_t slot_count_;
+    uint32_t slot_size_;
+    uint32_t data_offset_;
+    uint32_t write_slot_ = SharedFrameRingHeader::kNoSlot;
+};
+
+#endif
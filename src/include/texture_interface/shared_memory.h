@@ -0,0 +1,36 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Named shared memory mapping, a file mapping object on Windows and a POSIX
+// shm object elsewhere.
+class SharedMemory
+{
+public:
+    // Creates (or truncates) the named region, used by frame producers.
+    static std::unique_ptr<SharedMemory> Create(const std::string &name, size_t size);
+    // Maps an existing region created by another process.
+    static std::unique_ptr<SharedMemory> Open(const std::string &name);
+
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    void *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    SharedMemory() = default;
+
+    void *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *mapping_ = nullptr;
+#endif
+};
+
+#endif
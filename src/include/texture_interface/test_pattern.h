@@ -0,0 +1,44 @@
+#ifndef TEST_PATTERN_H
+#define TEST_PATTERN_H
+
+#include <cstdint>
+
+// Synthetic frames for load tests, rendered natively so that they measure
+// the plugin instead of whoever generates the pixels. The values are part of
+// the C ABI (TI_PATTERN_*).
+enum class TestPattern : int32_t
+{
+    // |color| everywhere
+    kSolid = 0,
+    // horizontal red and vertical green ramp, scrolling with the frame index
+    kGradient = 1,
+    // eight color bars, scrolling with the frame index
+    kBars = 2,
+    // different random pixels every frame, nothing compresses or repeats
+    kNoise = 3,
+    // the gradient below a band of 64 black and white cells that carry the
+    // render timestamp, see ReadPatternTimestamp
+    kTimestamp = 4,
+};
+
+inline bool IsValidTestPattern(int32_t pattern)
+{
+    return pattern >= static_cast<int32_t>(TestPattern::kSolid) &&
+           pattern <= static_cast<int32_t>(TestPattern::kTimestamp);
+}
+
+// Renders rows [row_begin, row_end) of frame |index| of |pattern| into the
+// packed |width| x |height| RGBA image |dst|. |color| is 0xAARRGGBB,
+// |timestamp| is what kTimestamp encodes. Disjoint row ranges can be rendered
+// concurrently.
+void RenderTestPatternRows(TestPattern pattern, uint32_t color, uint64_t index, int64_t timestamp,
+                           uint8_t *dst, int32_t width, int32_t height, int32_t row_begin, int32_t row_end);
+
+// Reads the timestamp of a kTimestamp frame back from its RGBA pixels, for
+// example from a screen capture of the texture. The cells survive scaling as
+// long as the image is at least 64 pixels wide. Returns false if |pixels| is
+// too small to carry one.
+bool ReadPatternTimestamp(const uint8_t *pixels, int32_t width, int32_t height, int32_t stride,
+                          int64_t *timestamp);
+
+#endif
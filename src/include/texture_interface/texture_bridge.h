@@ -0,0 +1,47 @@
+#ifndef TEXTURE_BRIDGE_H
+#define TEXTURE_BRIDGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Packed RGBA pixels handed to the engine, laid out like the desktop
+// embedder's FlutterDesktopPixelBuffer. |release_callback| is called with
+// |release_context| once the engine is done with |buffer|. Bridges whose
+// embedder does not report that call it before the next fetch and when the
+// texture is unregistered.
+struct PixelBuffer
+{
+    const uint8_t *buffer;
+    size_t width;
+    size_t height;
+    void (*release_callback)(void *release_context);
+    void *release_context;
+};
+
+// What Frame needs from the embedder, implemented by every platform plugin
+// on top of its texture registrar so that the core does not depend on one.
+class TextureBridge
+{
+public:
+    // called on the raster thread with the size the texture is drawn at,
+    // returns null if there is nothing to show
+    typedef std::function<const PixelBuffer *(size_t width, size_t height)> FetchCallback;
+
+    virtual ~TextureBridge() = default;
+
+    // Registers a pixel buffer texture and returns its id.
+    virtual int64_t RegisterTexture(FetchCallback fetch) = 0;
+    // Unregisters the texture without waiting for the raster thread.
+    // |unregistered|, if set, is called once |fetch| is not called anymore
+    // and every buffer it returned was released, on any thread and possibly
+    // before this returns. It is not called once the bridge is destroyed.
+    virtual void UnregisterTexture(int64_t texture_id, std::function<void()> unregistered) = 0;
+    virtual void MarkTextureFrameAvailable(int64_t texture_id) = 0;
+
+    // Frees a buffer whose ownership was passed to Frame::Update, allocated
+    // the way the platform's Dart side allocates them.
+    virtual void FreeBuffer(uint8_t *buffer) = 0;
+};
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef FLUTTER_PLUGIN_TEXTURE_INTERFACE_FFI_H_
+#define FLUTTER_PLUGIN_TEXTURE_INTERFACE_FFI_H_
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifdef TEXTURE_INTERFACE_IMPL
+#define TI_EXPORT __declspec(dllexport)
+#else
+#define TI_EXPORT __declspec(dllimport)
+#endif
+#else
+#define TI_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Status codes, the negative values match the error codes of the channel.
+#define TI_OK 0
+#define TI_ERROR_INVALID_ARGUMENT -1
+#define TI_ERROR_NOT_FOUND -2
+#define TI_ERROR_FOREIGN_BUFFER -3
+#define TI_ERROR_OUT_OF_MEMORY -4
+#define TI_ERROR_UNSUPPORTED -5
+#define TI_ERROR_SHARED_MEMORY -6
+#define TI_ERROR_NO_FRAME -7
+#define TI_ERROR_CORRUPT -8
+
+// Source pixel formats, see pixel_format.h for the planar layouts.
+#define TI_FORMAT_RGBA 0
+#define TI_FORMAT_BGRA 1
+#define TI_FORMAT_RGB24 2
+#define TI_FORMAT_RGB565 3
+#define TI_FORMAT_NV12 4
+#define TI_FORMAT_I420 5
+
+// Pacing modes, see PacingMode in frame.h.
+#define TI_PACING_IMMEDIATE 0
+#define TI_PACING_COALESCE 1
+
+// Duplicate checks, see DuplicateCheck in frame.h.
+#define TI_DUPLICATES_OFF 0
+#define TI_DUPLICATES_FULL 1
+#define TI_DUPLICATES_SAMPLED 2
+
+// Test patterns of the native load generator, see test_pattern.h.
+#define TI_PATTERN_SOLID 0
+#define TI_PATTERN_GRADIENT 1
+#define TI_PATTERN_BARS 2
+#define TI_PATTERN_NOISE 3
+#define TI_PATTERN_TIMESTAMP 4
+
+// Changed rectangle for ti_update_regions, |src| points at its top left
+// RGBA pixel and |src_stride| is the distance between its rows in bytes.
+typedef struct {
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  const uint8_t* src;
+  int32_t src_stride;
+} ti_region;
+
+// One entry of ti_update_frames, the arguments of ti_update_frame_format.
+typedef struct {
+  int64_t texture_handle;
+  uint8_t* buffer;
+  int32_t width;
+  int32_t height;
+  int32_t stride;
+  int32_t format;
+} ti_frame_update;
+
+// Hands a caller owned buffer back, see ti_update_frame_external.
+typedef void (*ti_release_callback)(void* context, uint8_t* buffer);
+
+// Per texture statistics for ti_get_stats. Counts cover the window since
+// the last reset, latencies are in microseconds: take is submit until the
+// frame is handed to the raster thread, queue until the engine fetches it,
+// upload until the engine releases it and total is submit until release.
+typedef struct {
+  uint64_t frames_submitted;
+  uint64_t frames_displayed;
+  uint64_t frames_dropped;
+  uint64_t bytes_submitted;
+  double interval_seconds;
+  double fps;
+  double bytes_per_second;
+  double take_p50_us;
+  double take_p99_us;
+  double queue_p50_us;
+  double queue_p99_us;
+  double upload_p50_us;
+  double upload_p99_us;
+  double total_p50_us;
+  double total_p99_us;
+  // frames skipped as duplicates, see ti_set_duplicate_check
+  uint64_t frames_skipped;
+} ti_frame_stats;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Native entry points for dart:ffi. They can be called synchronously from any
+// thread or isolate. |texture_handle| is the handle returned by the
+// RegisterTexture channel call, |stride| is the row pitch in bytes where 0
+// means tightly packed rows.
+
+// Takes ownership of |buffer| unless an error is returned. It is freed with
+// CoTaskMemFree on Windows and free elsewhere, matching calloc in Dart.
+// Packed rows are displayed without a copy, padded rows are compacted natively.
+TI_EXPORT int32_t ti_update_frame(int64_t texture_handle,
+                                  uint8_t* buffer, int32_t width,
+                                  int32_t height, int32_t stride);
+
+// Like ti_update_frame for a buffer in one of the TI_FORMAT_* layouts, which
+// is converted to RGBA natively. |stride| is the luma pitch for planar
+// formats.
+TI_EXPORT int32_t ti_update_frame_format(int64_t texture_handle,
+                                         uint8_t* buffer,
+                                         int32_t width,
+                                         int32_t height,
+                                         int32_t stride,
+                                         int32_t format);
+
+// Like ti_update_frame_format for memory that stays owned by the caller, a
+// decoder's output surface for example, so that it is displayed without a
+// defensive copy. Instead of being freed, |buffer| is passed to |release|
+// with |context| once the texture no longer needs it. That happens on the
+// thread of a later update or of unregistering, never on the raster thread,
+// and |release| must not call back into the same texture. Nothing is
+// released if an error is returned.
+TI_EXPORT int32_t ti_update_frame_external(int64_t texture_handle,
+                                           uint8_t* buffer, int32_t width,
+                                           int32_t height, int32_t stride,
+                                           int32_t format,
+                                           ti_release_callback release,
+                                           void* context);
+
+// Release queues for callers that cannot be called on arbitrary threads,
+// like Dart: buffers updated with ti_update_frame_queued are appended to
+// their queue once released and picked up with ti_poll_released. Buffers
+// released after their queue was destroyed are dropped.
+TI_EXPORT int64_t ti_create_release_queue(void);
+TI_EXPORT void ti_destroy_release_queue(int64_t queue);
+
+TI_EXPORT int32_t ti_update_frame_queued(int64_t texture_handle,
+                                         uint8_t* buffer, int32_t width,
+                                         int32_t height, int32_t stride,
+                                         int32_t format, int64_t queue);
+
+// Moves up to |capacity| released buffers of |queue|, oldest first, into
+// |buffers| and returns how many, or TI_ERROR_NOT_FOUND.
+TI_EXPORT int32_t ti_poll_released(int64_t queue, uint8_t** buffers,
+                                   int32_t capacity);
+
+// Publishes several frames, possibly of different textures, in one call.
+// Every texture is notified once, after all frames were published. Writes the
+// status of each entry to |statuses| if it is not null and returns the first
+// error, or TI_OK. Buffers of failed entries stay owned by the caller.
+TI_EXPORT int32_t ti_update_frames(const ti_frame_update* updates,
+                                   int32_t count,
+                                   int32_t* statuses);
+
+// Decodes a QOI or baseline JPEG image of |size| bytes natively into a pooled
+// buffer and displays it, |data| stays owned by the caller. Writes the image
+// size to |width| and |height| if they are not null. Fails with
+// TI_ERROR_UNSUPPORTED for other formats and TI_ERROR_CORRUPT if decoding
+// failed.
+TI_EXPORT int32_t ti_update_frame_encoded(int64_t texture_handle,
+                                          const uint8_t* data, int64_t size,
+                                          int32_t* width, int32_t* height);
+
+// Pooled buffers, see Frame::AcquireBuffer. Returns null on failure.
+// Submitting or releasing a buffer that is not currently acquired, because
+// it was submitted or released already for example, fails with
+// TI_ERROR_FOREIGN_BUFFER, submitting a frame larger than the acquired
+// buffer with TI_ERROR_INVALID_ARGUMENT.
+TI_EXPORT uint8_t* ti_acquire_buffer(int64_t texture_handle,
+                                     int32_t width, int32_t height);
+
+TI_EXPORT int32_t ti_submit_buffer(int64_t texture_handle,
+                                   uint8_t* buffer, int32_t width,
+                                   int32_t height);
+
+TI_EXPORT int32_t ti_release_buffer(int64_t texture_handle,
+                                    uint8_t* buffer);
+
+// Copies only the changed rectangles onto the last frame, the source memory
+// stays owned by the caller. Fails with TI_ERROR_NO_FRAME before the first
+// full frame and while the last one was downscaled.
+TI_EXPORT int32_t ti_update_region(int64_t texture_handle,
+                                   int32_t x, int32_t y,
+                                   int32_t width, int32_t height,
+                                   const uint8_t* src,
+                                   int32_t src_stride);
+
+TI_EXPORT int32_t ti_update_regions(int64_t texture_handle,
+                                    const ti_region* regions,
+                                    int32_t count);
+
+// Frame deltas, see frame_delta.h. ti_encode_frame_delta writes the delta
+// that turns the RGBA frame |previous| into |current| to |out| and its size
+// to |size|; |capacity| has to be at least ti_max_frame_delta_size, or
+// TI_ERROR_OUT_OF_MEMORY is returned. ti_update_frame_delta applies a delta
+// to the last frame, only the changed pixels are read and written. It fails
+// with TI_ERROR_CORRUPT if |data| is not a delta and with TI_ERROR_NO_FRAME
+// without a last frame of the size it was encoded for. Deltas always apply
+// to what the texture shows, so a producer has to encode them against the
+// frame it submitted last.
+TI_EXPORT int64_t ti_max_frame_delta_size(int32_t width, int32_t height);
+
+TI_EXPORT int32_t ti_encode_frame_delta(const uint8_t* previous,
+                                        const uint8_t* current,
+                                        int32_t width, int32_t height,
+                                        int32_t stride, uint8_t* out,
+                                        int64_t capacity, int64_t* size);
+
+TI_EXPORT int32_t ti_update_frame_delta(int64_t texture_handle,
+                                        const uint8_t* data, int64_t size);
+
+// Selects how frames that arrive faster than the display shows them are
+// handled. In TI_PACING_COALESCE mode frames are converted on a thread of
+// the texture once the previous one was fetched, and a frame replaced before
+// that is dropped without being converted.
+TI_EXPORT int32_t ti_set_pacing_mode(int64_t texture_handle,
+                                     int32_t mode);
+
+// Hashes every submitted frame, or with TI_DUPLICATES_SAMPLED a fixed
+// eighth of it, and skips publishing frames that match the one shown, so
+// the engine does not upload them again. Skipped frames count as success,
+// their buffers are released right away.
+TI_EXPORT int32_t ti_set_duplicate_check(int64_t texture_handle,
+                                         int32_t check);
+
+// Size in physical pixels the texture is displayed at, 0 x 0 if unknown.
+// Larger frames are downscaled natively to still cover it.
+TI_EXPORT int32_t ti_set_display_size(int64_t texture_handle,
+                                      int32_t width, int32_t height);
+
+// Backpressure: returns 1 once the last published frame was fetched by the
+// engine, 0 while it is still pending, or an error.
+TI_EXPORT int32_t ti_ready_for_frame(int64_t texture_handle);
+
+// Number of frames that were replaced before the engine fetched them.
+TI_EXPORT int32_t ti_dropped_frames(int64_t texture_handle,
+                                    uint64_t* dropped);
+
+// Number of frames that were skipped as duplicates.
+TI_EXPORT int32_t ti_skipped_frames(int64_t texture_handle,
+                                    uint64_t* skipped);
+
+// Pixel memory the texture currently holds, see MemoryBudget.
+TI_EXPORT int32_t ti_resident_bytes(int64_t texture_handle,
+                                    uint64_t* bytes);
+
+// Fills |stats| and starts a new window if |reset| is non-zero.
+TI_EXPORT int32_t ti_get_stats(int64_t texture_handle,
+                               ti_frame_stats* stats,
+                               int32_t reset);
+
+// The steady clock the plugin stamps frames with, in nanoseconds.
+TI_EXPORT int64_t ti_clock_now(void);
+
+// Reads the render timestamp back from the RGBA pixels of a
+// TI_PATTERN_TIMESTAMP frame, for example a screen capture of the texture,
+// so that ti_clock_now() minus it is the latency up to that point. |stride|
+// 0 means tightly packed.
+TI_EXPORT int32_t ti_read_pattern_timestamp(const uint8_t* pixels,
+                                            int32_t width,
+                                            int32_t height,
+                                            int32_t stride,
+                                            int64_t* timestamp);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // FLUTTER_PLUGIN_TEXTURE_INTERFACE_FFI_H_
@@ -0,0 +1,62 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Wait-free single producer / single consumer handoff of the newest value.
+// The producer fills back() and publishes it, the consumer swaps the newest
+// published slot into front(). Neither side ever waits for the other, the
+// only shared state is the index of the middle slot.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer side. The back slot is exclusively owned by the producer.
+    T &back() { return slots_[back_]; }
+
+    // Makes the back slot the newest value and hands the producer a new back
+    // slot. Returns true if the previous value was never consumed.
+    bool Publish()
+    {
+        uint8_t previous = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+        return (previous & kDirty) != 0;
+    }
+
+    // Consumer side. Swaps in the newest published value if there is one and
+    // returns whether front() changed.
+    bool Consume()
+    {
+        if ((middle_.load(std::memory_order_relaxed) & kDirty) == 0)
+            return false;
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndexMask;
+        return true;
+    }
+
+    // The front slot is exclusively owned by the consumer.
+    T &front() { return slots_[front_]; }
+
+    bool HasPending() const { return (middle_.load(std::memory_order_acquire) & kDirty) != 0; }
+
+    // Visits every slot. Only safe once producer and consumer are gone.
+    template <typename F>
+    void ForEach(F &&visit)
+    {
+        for (T &slot : slots_)
+            visit(slot);
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kDirty = 0x4;
+
+    T slots_[3]{};
+    // producer, consumer and shared index live on separate cache lines
+    alignas(64) uint8_t back_ = 0;
+    alignas(64) uint8_t front_ = 1;
+    alignas(64) std::atomic<uint8_t> middle_{2};
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Threads shared by all frames of a plugin instance to split the conversion
+// and copy of large frames into row bands. The calling thread always works
+// on its own job too, so a pool without threads runs everything inline.
+class WorkerPool
+{
+public:
+    static constexpr size_t kDefaultParallelThreshold = 1 << 20;
+
+    explicit WorkerPool(size_t thread_count = DefaultThreadCount());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // Restarts the pool with |thread_count| workers. Jobs below
+    // |parallel_threshold| bytes of output stay on the calling thread.
+    void Configure(size_t thread_count, size_t parallel_threshold);
+
+    size_t thread_count() const;
+    size_t parallel_threshold() const { return parallel_threshold_.load(); }
+
+    // Calls |task(begin, end)| for disjoint bands covering [0, rows) and
+    // returns once all of them ran. |bytes| is the size of the output, small
+    // jobs are not split.
+    template <typename F>
+    void ParallelFor(int32_t rows, size_t bytes, F &&task)
+    {
+        using Task = std::remove_reference_t<F>;
+        Run(rows, bytes,
+            [](void *context, int32_t begin, int32_t end)
+            { (*static_cast<Task *>(context))(begin, end); },
+            &task);
+    }
+
+    static size_t DefaultThreadCount();
+
+private:
+    typedef void (*BandFunction)(void *context, int32_t begin, int32_t end);
+
+    // lives on the stack of the thread that called Run
+    struct Job
+    {
+        BandFunction function;
+        void *context;
+        int32_t rows;
+        int32_t band_rows;
+        int32_t bands;
+        std::atomic<int32_t> next_band{0};
+        // guarded by mutex_
+        int32_t wanted_helpers = 0;
+        int32_t active_helpers = 0;
+        Job *next = nullptr;
+    };
+
+    void Run(int32_t rows, size_t bytes, BandFunction function, void *context);
+    static void WorkOn(Job &job);
+    void WorkerLoop();
+    void Start(size_t thread_count);
+    void Stop();
+
+    // Run holds it shared, Configure exclusively while it swaps the threads
+    mutable std::shared_mutex configure_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable helper_done_;
+    // jobs that still want helpers, linked through Job::next so that queuing
+    // never allocates, however many frames run jobs at once
+    Job *queue_ = nullptr;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+    std::atomic<size_t> parallel_threshold_{kDefaultParallelThreshold};
+};
+
+#endif
@@ -0,0 +1,902 @@
+#include "include/texture_interface/image_decoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+// Baseline JPEG (ITU T.81) with Huffman coding and 8 bit samples. The
+// entropy coded data is decoded into one coefficient buffer first, in
+// parallel between restart markers when the encoder wrote any, then every
+// row of MCUs is transformed and converted to RGBA independently.
+
+namespace
+{
+    constexpr uint8_t kMarkerSof0 = 0xC0;
+    constexpr uint8_t kMarkerSof1 = 0xC1;
+    constexpr uint8_t kMarkerDht = 0xC4;
+    constexpr uint8_t kMarkerRst0 = 0xD0;
+    constexpr uint8_t kMarkerRst7 = 0xD7;
+    constexpr uint8_t kMarkerSoi = 0xD8;
+    constexpr uint8_t kMarkerEoi = 0xD9;
+    constexpr uint8_t kMarkerSos = 0xDA;
+    constexpr uint8_t kMarkerDqt = 0xDB;
+    constexpr uint8_t kMarkerDri = 0xDD;
+    constexpr uint8_t kMarkerApp14 = 0xEE;
+
+    constexpr int kMaxComponents = 3;
+    constexpr int kFastBits = 9;
+
+    // natural position of the k-th coefficient in zigzag order, padded so
+    // that a corrupt run past the end stays inside the block
+    constexpr uint8_t kZigzag[64 + 16] = {
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+        63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63};
+
+    struct HuffmanTable
+    {
+        // code length << 8 | symbol for every kFastBits prefix of a code that
+        // short, 0 for longer codes
+        uint16_t fast[1 << kFastBits];
+        int32_t max_code[17];
+        int32_t min_code[17];
+        int32_t first_value[17];
+        uint8_t values[256];
+        bool defined;
+    };
+
+    struct Component
+    {
+        uint8_t id;
+        int32_t h;
+        int32_t v;
+        int32_t quant;
+        int32_t dc_table;
+        int32_t ac_table;
+        // log2 of hmax / h and vmax / v
+        int32_t h_shift;
+        int32_t v_shift;
+        // blocks in the coefficient buffer, whole MCUs
+        int32_t blocks_w;
+        int32_t blocks_h;
+        size_t offset;
+        bool scanned;
+    };
+
+    struct JpegImage
+    {
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t component_count = 0;
+        Component components[kMaxComponents] = {};
+        int32_t h_max = 1;
+        int32_t v_max = 1;
+        int32_t mcus_x = 0;
+        int32_t mcus_y = 0;
+        uint16_t quant[4][64] = {};
+        HuffmanTable dc[4] = {};
+        HuffmanTable ac[4] = {};
+        int32_t restart_interval = 0;
+        // Adobe transform 0: the three components are RGB, not YCbCr
+        bool adobe_rgb = false;
+        int16_t *coefficients = nullptr;
+    };
+
+    inline uint16_t ReadU16(const uint8_t *bytes)
+    {
+        return static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+    }
+
+    inline uint8_t Clamp(int64_t value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : value > 255 ? 255 : value);
+    }
+
+    int32_t Log2Ratio(int32_t max, int32_t factor)
+    {
+        switch (max / factor)
+        {
+        case 1:
+            return 0;
+        case 2:
+            return 1;
+        case 4:
+            return 2;
+        }
+        return -1;
+    }
+
+    bool ParseFrameHeader(const uint8_t *payload, size_t length, JpegImage *image)
+    {
+        if (length < 6 || payload[0] != 8)
+            return false;
+        image->height = ReadU16(payload + 1);
+        image->width = ReadU16(payload + 3);
+        image->component_count = payload[5];
+        // a height of 0 would follow in a DNL marker after the first scan
+        if (image->width == 0 || image->height == 0 ||
+            (image->component_count != 1 && image->component_count != 3) ||
+            length < 6 + 3 * static_cast<size_t>(image->component_count))
+            return false;
+
+        image->h_max = 1;
+        image->v_max = 1;
+        for (int32_t i = 0; i < image->component_count; i++)
+        {
+            Component &component = image->components[i];
+            const uint8_t *spec = payload + 6 + 3 * i;
+            component.id = spec[0];
+            component.h = spec[1] >> 4;
+            component.v = spec[1] & 0x0F;
+            component.quant = spec[2];
+            if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quant > 3)
+                return false;
+            // one component is never interleaved, its sampling does not matter
+            if (image->component_count == 1)
+                component.h = component.v = 1;
+            image->h_max = std::max(image->h_max, component.h);
+            image->v_max = std::max(image->v_max, component.v);
+        }
+        image->mcus_x = (image->width + 8 * image->h_max - 1) / (8 * image->h_max);
+        image->mcus_y = (image->height + 8 * image->v_max - 1) / (8 * image->v_max);
+        for (int32_t i = 0; i < image->component_count; i++)
+        {
+            Component &component = image->components[i];
+            component.h_shift = Log2Ratio(image->h_max, component.h);
+            component.v_shift = Log2Ratio(image->v_max, component.v);
+            if (component.h_shift < 0 || component.v_shift < 0 || image->h_max % component.h != 0 ||
+                image->v_max % component.v != 0)
+                return false;
+            component.blocks_w = image->mcus_x * component.h;
+            component.blocks_h = image->mcus_y * component.v;
+        }
+        return true;
+    }
+
+    bool ParseQuantTables(const uint8_t *payload, size_t length, JpegImage *image)
+    {
+        size_t pos = 0;
+        while (pos < length)
+        {
+            int32_t precision = payload[pos] >> 4;
+            int32_t id = payload[pos] & 0x0F;
+            size_t table_size = precision == 0 ? 64 : 128;
+            if (precision > 1 || id > 3 || length - pos - 1 < table_size)
+                return false;
+            const uint8_t *values = payload + pos + 1;
+            for (int32_t k = 0; k < 64; k++)
+                image->quant[id][kZigzag[k]] = precision == 0 ? values[k] : ReadU16(values + 2 * k);
+            pos += 1 + table_size;
+        }
+        return true;
+    }
+
+    bool BuildHuffmanTable(const uint8_t *counts, const uint8_t *values, size_t value_count,
+                           HuffmanTable *table)
+    {
+        std::memset(table, 0, sizeof(*table));
+        std::memcpy(table->values, values, value_count);
+        int32_t code = 0;
+        int32_t k = 0;
+        for (int32_t length = 1; length <= 16; length++)
+        {
+            table->first_value[length] = k;
+            table->min_code[length] = code;
+            for (int32_t i = 0; i < counts[length - 1]; i++, code++, k++)
+            {
+                // more codes than fit in |length| bits
+                if (code >= (1 << length))
+                    return false;
+                if (length > kFastBits)
+                    continue;
+                int32_t fill = 1 << (kFastBits - length);
+                int32_t prefix = code << (kFastBits - length);
+                for (int32_t j = 0; j < fill; j++)
+                    table->fast[prefix + j] = static_cast<uint16_t>(length << 8 | values[k]);
+            }
+            table->max_code[length] = counts[length - 1] != 0 ? code - 1 : -1;
+            code <<= 1;
+        }
+        table->defined = true;
+        return true;
+    }
+
+    bool ParseHuffmanTables(const uint8_t *payload, size_t length, JpegImage *image)
+    {
+        size_t pos = 0;
+        while (pos < length)
+        {
+            if (length - pos < 17)
+                return false;
+            int32_t table_class = payload[pos] >> 4;
+            int32_t id = payload[pos] & 0x0F;
+            if (table_class > 1 || id > 3)
+                return false;
+            const uint8_t *counts = payload + pos + 1;
+            size_t value_count = 0;
+            for (int32_t i = 0; i < 16; i++)
+                value_count += counts[i];
+            if (value_count > 256 || length - pos - 17 < value_count)
+                return false;
+            HuffmanTable *table = table_class == 0 ? &image->dc[id] : &image->ac[id];
+            if (!BuildHuffmanTable(counts, payload + pos + 17, value_count, table))
+                return false;
+            pos += 17 + value_count;
+        }
+        return true;
+    }
+
+    // Reads the entropy coded data between two markers MSB first, dropping
+    // the 0x00 stuffed after 0xFF. Past its end it yields zero bits.
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *begin, const uint8_t *end) : pos_(begin), end_(end) {}
+
+        uint32_t Peek16()
+        {
+            if (count_ < 16)
+                Fill();
+            return static_cast<uint32_t>(bits_ >> 48);
+        }
+
+        void Skip(int32_t count)
+        {
+            bits_ <<= count;
+            count_ -= count;
+        }
+
+        int32_t Take(int32_t count)
+        {
+            if (count_ < count)
+                Fill();
+            int32_t value = static_cast<int32_t>(bits_ >> (64 - count));
+            Skip(count);
+            return value;
+        }
+
+        // |count| bits as the signed magnitude category they encode
+        int32_t Extend(int32_t count)
+        {
+            if (count == 0)
+                return 0;
+            int32_t value = Take(count);
+            return value < (1 << (count - 1)) ? value - (1 << count) + 1 : value;
+        }
+
+    private:
+        void Fill()
+        {
+            while (count_ <= 56)
+            {
+                uint64_t byte = 0;
+                if (pos_ < end_)
+                {
+                    byte = *pos_++;
+                    if (byte == 0xFF && pos_ < end_ && *pos_ == 0x00)
+                        pos_++;
+                }
+                bits_ |= byte << (56 - count_);
+                count_ += 8;
+            }
+        }
+
+        const uint8_t *pos_;
+        const uint8_t *end_;
+        uint64_t bits_ = 0;
+        int32_t count_ = 0;
+    };
+
+    // -1 for a code that is not in |table|
+    int32_t DecodeSymbol(BitReader &reader, const HuffmanTable &table)
+    {
+        uint32_t peek = reader.Peek16();
+        uint16_t fast = table.fast[peek >> (16 - kFastBits)];
+        if (fast != 0)
+        {
+            reader.Skip(fast >> 8);
+            return fast & 0xFF;
+        }
+        for (int32_t length = kFastBits + 1; length <= 16; length++)
+        {
+            int32_t code = static_cast<int32_t>(peek >> (16 - length));
+            if (code <= table.max_code[length])
+            {
+                int32_t index = table.first_value[length] + code - table.min_code[length];
+                if (index < 0 || index > 255)
+                    return -1;
+                reader.Skip(length);
+                return table.values[index];
+            }
+        }
+        return -1;
+    }
+
+    bool DecodeBlock(BitReader &reader, const HuffmanTable &dc, const HuffmanTable &ac, int32_t *dc_pred,
+                     int16_t *block)
+    {
+        std::memset(block, 0, 64 * sizeof(int16_t));
+        int32_t category = DecodeSymbol(reader, dc);
+        if (category < 0 || category > 11)
+            return false;
+        // corrupt data could otherwise overflow it over many blocks
+        *dc_pred = std::clamp(*dc_pred + reader.Extend(category), -32768, 32767);
+        block[0] = static_cast<int16_t>(*dc_pred);
+
+        for (int32_t k = 1; k < 64;)
+        {
+            int32_t symbol = DecodeSymbol(reader, ac);
+            if (symbol < 0)
+                return false;
+            int32_t run = symbol >> 4;
+            int32_t size = symbol & 0x0F;
+            if (size == 0)
+            {
+                // end of block, or 16 zeros
+                if (run != 15)
+                    break;
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63)
+                return false;
+            block[kZigzag[k]] = static_cast<int16_t>(reader.Extend(size));
+            k++;
+        }
+        return true;
+    }
+
+    // blocks a single component scan codes per row or column
+    inline int32_t ScanBlocks(int32_t size, int32_t shift)
+    {
+        return (((size + (1 << shift) - 1) >> shift) + 7) / 8;
+    }
+
+    inline int16_t *BlockAt(const JpegImage &image, const Component &component, int32_t bx, int32_t by)
+    {
+        return image.coefficients + component.offset +
+               (static_cast<size_t>(by) * component.blocks_w + bx) * 64;
+    }
+
+    struct Scan
+    {
+        int32_t count;
+        int32_t components[kMaxComponents];
+        // entropy coded data up to the marker that ends it, and where each
+        // restart interval starts in it
+        const uint8_t *begin;
+        const uint8_t *end;
+        std::vector<const uint8_t *> intervals;
+    };
+
+    // Decodes units [first, last) of |scan| from the data at [begin, end).
+    // A unit is an MCU of an interleaved scan or a block of a single
+    // component one.
+    bool DecodeInterval(const JpegImage &image, const Scan &scan, const uint8_t *begin, const uint8_t *end,
+                        int64_t first, int64_t last)
+    {
+        BitReader reader(begin, end);
+        int32_t dc_pred[kMaxComponents] = {};
+        if (scan.count == 1)
+        {
+            const Component &component = image.components[scan.components[0]];
+            const HuffmanTable &dc = image.dc[component.dc_table];
+            const HuffmanTable &ac = image.ac[component.ac_table];
+            // a single component scan covers the blocks inside the image only
+            int32_t width = ScanBlocks(image.width, component.h_shift);
+            for (int64_t unit = first; unit < last; unit++)
+            {
+                int32_t bx = static_cast<int32_t>(unit % width);
+                int32_t by = static_cast<int32_t>(unit / width);
+                if (!DecodeBlock(reader, dc, ac, &dc_pred[0], BlockAt(image, component, bx, by)))
+                    return false;
+            }
+            return true;
+        }
+
+        for (int64_t unit = first; unit < last; unit++)
+        {
+            int32_t mx = static_cast<int32_t>(unit % image.mcus_x);
+            int32_t my = static_cast<int32_t>(unit / image.mcus_x);
+            for (int32_t i = 0; i < scan.count; i++)
+            {
+                const Component &component = image.components[scan.components[i]];
+                const HuffmanTable &dc = image.dc[component.dc_table];
+                const HuffmanTable &ac = image.ac[component.ac_table];
+                for (int32_t y = 0; y < component.v; y++)
+                {
+                    for (int32_t x = 0; x < component.h; x++)
+                    {
+                        int16_t *block = BlockAt(image, component, mx * component.h + x, my * component.v + y);
+                        if (!DecodeBlock(reader, dc, ac, &dc_pred[i], block))
+                            return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    int64_t ScanUnits(const JpegImage &image, const Scan &scan)
+    {
+        if (scan.count > 1)
+            return static_cast<int64_t>(image.mcus_x) * image.mcus_y;
+        const Component &component = image.components[scan.components[0]];
+        return static_cast<int64_t>(ScanBlocks(image.width, component.h_shift)) *
+               ScanBlocks(image.height, component.v_shift);
+    }
+
+    bool DecodeScan(const JpegImage &image, const Scan &scan, WorkerPool *workers)
+    {
+        int64_t units = ScanUnits(image, scan);
+        if (image.restart_interval == 0)
+            return DecodeInterval(image, scan, scan.begin, scan.end, 0, units);
+
+        int64_t expected = (units + image.restart_interval - 1) / image.restart_interval;
+        if (static_cast<int64_t>(scan.intervals.size()) < expected)
+            return false;
+        int32_t intervals = static_cast<int32_t>(expected);
+        std::atomic<bool> failed{false};
+        auto decode = [&](int32_t begin, int32_t end)
+        {
+            for (int32_t i = begin; i < end && !failed.load(std::memory_order_relaxed); i++)
+            {
+                // the interval ends at the restart marker of the next one
+                const uint8_t *data_end = i + 1 < static_cast<int32_t>(scan.intervals.size())
+                                              ? scan.intervals[i + 1] - 2
+                                              : scan.end;
+                int64_t first = static_cast<int64_t>(i) * image.restart_interval;
+                int64_t last = std::min(first + image.restart_interval, units);
+                if (!DecodeInterval(image, scan, scan.intervals[i], data_end, first, last))
+                    failed.store(true);
+            }
+        };
+        if (workers == nullptr)
+            decode(0, intervals);
+        else
+            workers->ParallelFor(intervals, static_cast<size_t>(image.width) * image.height * 4, decode);
+        return !failed.load();
+    }
+
+    // Finds the marker that ends the entropy coded data starting at |begin|
+    // and the restart markers inside it.
+    void SplitScan(const uint8_t *begin, const uint8_t *end, Scan *scan)
+    {
+        scan->begin = begin;
+        scan->intervals.assign(1, begin);
+        const uint8_t *pos = begin;
+        while (pos + 1 < end)
+        {
+            pos = static_cast<const uint8_t *>(std::memchr(pos, 0xFF, end - pos - 1));
+            if (pos == nullptr)
+                break;
+            uint8_t next = pos[1];
+            if (next >= kMarkerRst0 && next <= kMarkerRst7)
+            {
+                scan->intervals.push_back(pos + 2);
+                pos += 2;
+            }
+            else if (next == 0x00 || next == 0xFF)
+            {
+                // stuffed byte, or fill bytes before a marker
+                pos += next == 0x00 ? 2 : 1;
+            }
+            else
+            {
+                scan->end = pos;
+                return;
+            }
+        }
+        scan->end = end;
+    }
+
+    bool ParseScanHeader(const uint8_t *payload, size_t length, JpegImage *image, Scan *scan)
+    {
+        if (length < 1)
+            return false;
+        scan->count = payload[0];
+        if (scan->count < 1 || scan->count > image->component_count ||
+            length < 4 + 2 * static_cast<size_t>(scan->count))
+            return false;
+        for (int32_t i = 0; i < scan->count; i++)
+        {
+            const uint8_t *spec = payload + 1 + 2 * i;
+            int32_t index = -1;
+            for (int32_t c = 0; c < image->component_count; c++)
+            {
+                if (image->components[c].id == spec[0])
+                    index = c;
+            }
+            if (index < 0)
+                return false;
+            Component &component = image->components[index];
+            component.dc_table = spec[1] >> 4;
+            component.ac_table = spec[1] & 0x0F;
+            if (component.dc_table > 3 || component.ac_table > 3 || !image->dc[component.dc_table].defined ||
+                !image->ac[component.ac_table].defined)
+                return false;
+            component.scanned = true;
+            scan->components[i] = index;
+        }
+        // a baseline scan codes all coefficients in one pass
+        const uint8_t *selection = payload + 1 + 2 * scan->count;
+        return selection[0] == 0 && selection[1] == 63 && selection[2] == 0;
+    }
+
+    // One dimensional inverse DCT of 8 values with 12 fractional bits, the
+    // integer form of the separable transform libjpeg's slow path uses. The
+    // row pass needs 64 bits, a corrupt block can push it past 32.
+    constexpr int32_t Fixed(double value)
+    {
+        return static_cast<int32_t>(value * 4096 + 0.5);
+    }
+
+    template <typename T>
+    struct Idct1D
+    {
+        T x0, x1, x2, x3, t0, t1, t2, t3;
+
+        Idct1D(T s0, T s1, T s2, T s3, T s4, T s5, T s6, T s7)
+        {
+            T p1 = (s2 + s6) * Fixed(0.5411961);
+            T even2 = p1 + s6 * Fixed(-1.847759065);
+            T even3 = p1 + s2 * Fixed(0.765366865);
+            T even0 = (s0 + s4) * 4096;
+            T even1 = (s0 - s4) * 4096;
+            x0 = even0 + even3;
+            x3 = even0 - even3;
+            x1 = even1 + even2;
+            x2 = even1 - even2;
+
+            T p3 = s7 + s3;
+            T p4 = s5 + s1;
+            T q1 = s7 + s1;
+            T q2 = s5 + s3;
+            T p5 = (p3 + p4) * Fixed(1.175875602);
+            t0 = s7 * Fixed(0.298631336);
+            t1 = s5 * Fixed(2.053119869);
+            t2 = s3 * Fixed(3.072711026);
+            t3 = s1 * Fixed(1.501321110);
+            q1 = p5 + q1 * Fixed(-0.899976223);
+            q2 = p5 + q2 * Fixed(-2.562915447);
+            p3 *= Fixed(-1.961570560);
+            p4 *= Fixed(-0.390180644);
+            t3 += q1 + p4;
+            t2 += q2 + p3;
+            t1 += q2 + p4;
+            t0 += q1 + p3;
+        }
+    };
+
+    // Inverse DCT of one block into 8 x 8 samples. Coefficients of valid
+    // 8 bit data stay within +-2048 once dequantized.
+    void IdctBlock(const int16_t *coefficients, const uint16_t *quant, uint8_t *out, size_t out_stride)
+    {
+        int32_t dequantized[64];
+        for (int32_t i = 0; i < 64; i++)
+            dequantized[i] = std::clamp(coefficients[i] * static_cast<int32_t>(quant[i]), -2048, 2047);
+
+        int32_t values[64];
+        for (int32_t column = 0; column < 8; column++)
+        {
+            const int32_t *c = dequantized + column;
+            int32_t *v = values + column;
+            if (c[8] == 0 && c[16] == 0 && c[24] == 0 && c[32] == 0 && c[40] == 0 && c[48] == 0 && c[56] == 0)
+            {
+                // only the DC term, the column is flat
+                for (int32_t row = 0; row < 8; row++)
+                    v[row * 8] = c[0] * 4;
+                continue;
+            }
+            Idct1D<int32_t> idct(c[0], c[8], c[16], c[24], c[32], c[40], c[48], c[56]);
+            // keep 2 of the 12 fractional bits for the row pass
+            int32_t round = 512;
+            v[0] = (idct.x0 + idct.t3 + round) >> 10;
+            v[56] = (idct.x0 - idct.t3 + round) >> 10;
+            v[8] = (idct.x1 + idct.t2 + round) >> 10;
+            v[48] = (idct.x1 - idct.t2 + round) >> 10;
+            v[16] = (idct.x2 + idct.t1 + round) >> 10;
+            v[40] = (idct.x2 - idct.t1 + round) >> 10;
+            v[24] = (idct.x3 + idct.t0 + round) >> 10;
+            v[32] = (idct.x3 - idct.t0 + round) >> 10;
+        }
+        for (int32_t row = 0; row < 8; row++, out += out_stride)
+        {
+            const int32_t *v = values + row * 8;
+            if (v[1] == 0 && v[2] == 0 && v[3] == 0 && v[4] == 0 && v[5] == 0 && v[6] == 0 && v[7] == 0)
+            {
+                // what the full pass yields for a flat row
+                std::memset(out, Clamp(((v[0] + 16) >> 5) + 128), 8);
+                continue;
+            }
+            Idct1D<int64_t> idct(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+            // 12 fractional bits, the 2 kept above and 3 for the two 1/sqrt(8)
+            // scales, rounded and shifted from -128..127 to 0..255
+            int64_t bias = (1 << 16) + (int64_t{128} << 17);
+            out[0] = Clamp((idct.x0 + idct.t3 + bias) >> 17);
+            out[7] = Clamp((idct.x0 - idct.t3 + bias) >> 17);
+            out[1] = Clamp((idct.x1 + idct.t2 + bias) >> 17);
+            out[6] = Clamp((idct.x1 - idct.t2 + bias) >> 17);
+            out[2] = Clamp((idct.x2 + idct.t1 + bias) >> 17);
+            out[5] = Clamp((idct.x2 - idct.t1 + bias) >> 17);
+            out[3] = Clamp((idct.x3 + idct.t0 + bias) >> 17);
+            out[4] = Clamp((idct.x3 - idct.t0 + bias) >> 17);
+        }
+    }
+
+    // JFIF full range BT.601 with 16 fractional bits, per chroma sample
+    struct YCbCrTables
+    {
+        int32_t cr_to_r[256];
+        int32_t cb_to_b[256];
+        int32_t cb_to_g[256];
+        int32_t cr_to_g[256];
+
+        YCbCrTables()
+        {
+            for (int32_t i = 0; i < 256; i++)
+            {
+                int32_t chroma = i - 128;
+                cr_to_r[i] = (91881 * chroma + 32768) >> 16;
+                cb_to_b[i] = (116130 * chroma + 32768) >> 16;
+                // summed before the shift
+                cb_to_g[i] = -22554 * chroma + 32768;
+                cr_to_g[i] = -46802 * chroma;
+            }
+        }
+    };
+
+    // Row |y| of an MCU row of |component| at full resolution, widened into
+    // |scratch| if the component is subsampled horizontally.
+    const uint8_t *UpsampledRow(const Component &component, const uint8_t *plane, size_t stride, int32_t y,
+                                int32_t width, uint8_t *scratch)
+    {
+        const uint8_t *row = plane + (y >> component.v_shift) * stride;
+        if (component.h_shift == 0)
+            return row;
+        if (component.h_shift == 1)
+        {
+            // 4:2:x, the common case
+            for (int32_t x = 0; x + 1 < width; x += 2)
+                scratch[x] = scratch[x + 1] = row[x >> 1];
+            scratch[width - 1] = row[(width - 1) >> 1];
+            return scratch;
+        }
+        for (int32_t x = 0; x < width; x++)
+            scratch[x] = row[x >> component.h_shift];
+        return scratch;
+    }
+
+    // Transforms MCU rows [begin, end) and writes their pixels into |dst|.
+    void ConvertMcuRows(const JpegImage &image, uint8_t *dst, int32_t begin, int32_t end)
+    {
+        static const YCbCrTables tables;
+
+        // the samples of one MCU row per component, and a full width row of
+        // each for upsampling
+        std::vector<uint8_t> planes[kMaxComponents];
+        std::vector<uint8_t> rows[kMaxComponents];
+        size_t strides[kMaxComponents];
+        for (int32_t c = 0; c < image.component_count; c++)
+        {
+            const Component &component = image.components[c];
+            strides[c] = static_cast<size_t>(component.blocks_w) * 8;
+            planes[c].resize(strides[c] * component.v * 8);
+            rows[c].resize(image.width);
+        }
+
+        size_t dst_stride = static_cast<size_t>(image.width) * 4;
+        int32_t mcu_height = 8 * image.v_max;
+        for (int32_t my = begin; my < end; my++)
+        {
+            for (int32_t c = 0; c < image.component_count; c++)
+            {
+                const Component &component = image.components[c];
+                const uint16_t *quant = image.quant[component.quant];
+                for (int32_t y = 0; y < component.v; y++)
+                {
+                    int32_t by = my * component.v + y;
+                    uint8_t *out = planes[c].data() + static_cast<size_t>(y) * 8 * strides[c];
+                    for (int32_t bx = 0; bx < component.blocks_w; bx++)
+                        IdctBlock(BlockAt(image, component, bx, by), quant, out + bx * 8, strides[c]);
+                }
+            }
+
+            int32_t first_row = my * mcu_height;
+            int32_t row_count = std::min(mcu_height, image.height - first_row);
+            for (int32_t y = 0; y < row_count; y++)
+            {
+                uint8_t *out = dst + static_cast<size_t>(first_row + y) * dst_stride;
+                const uint8_t *s0 = UpsampledRow(image.components[0], planes[0].data(), strides[0], y,
+                                                 image.width, rows[0].data());
+                if (image.component_count == 1)
+                {
+                    for (int32_t x = 0; x < image.width; x++, out += 4)
+                    {
+                        out[0] = out[1] = out[2] = s0[x];
+                        out[3] = 255;
+                    }
+                    continue;
+                }
+
+                const uint8_t *s1 = UpsampledRow(image.components[1], planes[1].data(), strides[1], y,
+                                                 image.width, rows[1].data());
+                const uint8_t *s2 = UpsampledRow(image.components[2], planes[2].data(), strides[2], y,
+                                                 image.width, rows[2].data());
+                if (image.adobe_rgb)
+                {
+                    for (int32_t x = 0; x < image.width; x++, out += 4)
+                    {
+                        out[0] = s0[x];
+                        out[1] = s1[x];
+                        out[2] = s2[x];
+                        out[3] = 255;
+                    }
+                    continue;
+                }
+                for (int32_t x = 0; x < image.width; x++, out += 4)
+                {
+                    int32_t luma = s0[x];
+                    uint8_t cb = s1[x];
+                    uint8_t cr = s2[x];
+                    out[0] = Clamp(luma + tables.cr_to_r[cr]);
+                    out[1] = Clamp(luma + ((tables.cb_to_g[cb] + tables.cr_to_g[cr]) >> 16));
+                    out[2] = Clamp(luma + tables.cb_to_b[cb]);
+                    out[3] = 255;
+                }
+            }
+        }
+    }
+
+    // Walks the markers of |data| and calls |segment(marker, payload,
+    // length, &next)| for every one with a payload until it returns false,
+    // the image ends or the data is malformed. The walk continues at |next|,
+    // which SOS moves past the entropy coded data.
+    template <typename F>
+    bool WalkMarkers(const uint8_t *data, size_t size, F &&segment)
+    {
+        const uint8_t *end = data + size;
+        const uint8_t *pos = data + 2;
+        while (true)
+        {
+            // fill bytes may precede any marker
+            while (pos < end && *pos == 0xFF)
+                pos++;
+            if (pos >= end || pos[-1] != 0xFF)
+                return false;
+            uint8_t marker = *pos++;
+            if (marker == kMarkerEoi)
+                return true;
+            if ((marker >= kMarkerRst0 && marker <= kMarkerRst7) || marker == kMarkerSoi || marker == 0x01)
+                continue;
+            if (end - pos < 2)
+                return false;
+            size_t length = ReadU16(pos);
+            if (length < 2 || static_cast<size_t>(end - pos) < length)
+                return false;
+            const uint8_t *next = pos + length;
+            if (!segment(marker, pos + 2, length - 2, &next))
+                return false;
+            pos = next;
+        }
+    }
+
+    bool IsUnsupportedFrame(uint8_t marker)
+    {
+        // progressive, lossless, hierarchical or arithmetic coded
+        return marker >= 0xC2 && marker <= 0xCF && marker != kMarkerDht && marker != 0xC8 && marker != 0xCC;
+    }
+}
+
+bool ReadJpegInfo(const uint8_t *data, size_t size, ImageInfo *info)
+{
+    JpegImage image;
+    bool found = false;
+    WalkMarkers(data, size,
+                [&](uint8_t marker, const uint8_t *payload, size_t length, const uint8_t **)
+                {
+                    if (IsUnsupportedFrame(marker))
+                        return false;
+                    if (marker != kMarkerSof0 && marker != kMarkerSof1)
+                        return true;
+                    found = ParseFrameHeader(payload, length, &image);
+                    return false;
+                });
+    if (!found)
+        return false;
+    info->codec = ImageCodec::kJpeg;
+    info->width = image.width;
+    info->height = image.height;
+    return true;
+}
+
+bool DecodeJpeg(const uint8_t *data, size_t size, uint8_t *dst, int32_t width, int32_t height,
+                WorkerPool *workers)
+{
+    // reused between frames, it is as large as the frame itself
+    thread_local std::vector<int16_t> coefficients;
+
+    JpegImage image;
+    bool frame_seen = false;
+    bool scan_seen = false;
+    bool ok = true;
+    Scan scan;
+    bool walked = WalkMarkers(
+        data, size,
+        [&](uint8_t marker, const uint8_t *payload, size_t length, const uint8_t **next)
+        {
+            switch (marker)
+            {
+            case kMarkerSof0:
+            case kMarkerSof1:
+            {
+                if (frame_seen || !ParseFrameHeader(payload, length, &image) || image.width != width ||
+                    image.height != height)
+                    return ok = false;
+                frame_seen = true;
+                size_t total = 0;
+                for (int32_t c = 0; c < image.component_count; c++)
+                {
+                    Component &component = image.components[c];
+                    component.offset = total;
+                    total += static_cast<size_t>(component.blocks_w) * component.blocks_h * 64;
+                }
+                coefficients.resize(total);
+                image.coefficients = coefficients.data();
+                return true;
+            }
+            case kMarkerDqt:
+                return ok = ParseQuantTables(payload, length, &image);
+            case kMarkerDht:
+                return ok = ParseHuffmanTables(payload, length, &image);
+            case kMarkerDri:
+                if (length < 2)
+                    return ok = false;
+                image.restart_interval = ReadU16(payload);
+                return true;
+            case kMarkerApp14:
+                // Adobe marker, its transform flag tells RGB from YCbCr
+                if (length >= 12 && std::memcmp(payload, "Adobe", 5) == 0)
+                    image.adobe_rgb = payload[11] == 0;
+                return true;
+            case kMarkerSos:
+            {
+                if (!frame_seen || !ParseScanHeader(payload, length, &image, &scan))
+                    return ok = false;
+                SplitScan(payload + length, data + size, &scan);
+                if (!DecodeScan(image, scan, workers))
+                    return ok = false;
+                scan_seen = true;
+                *next = scan.end;
+                return true;
+            }
+            default:
+                if (IsUnsupportedFrame(marker))
+                    return ok = false;
+                return true;
+            }
+        });
+    // a stream cut off after its last scan still shows everything it has
+    if (!ok || !scan_seen || (!walked && scan.end != data + size))
+        return false;
+
+    // components no scan covered are left at their midpoint
+    for (int32_t c = 0; c < image.component_count; c++)
+    {
+        const Component &component = image.components[c];
+        if (!component.scanned)
+            std::fill_n(image.coefficients + component.offset,
+                        static_cast<size_t>(component.blocks_w) * component.blocks_h * 64, int16_t{0});
+    }
+    if (workers == nullptr)
+        ConvertMcuRows(image, dst, 0, image.mcus_y);
+    else
+        workers->ParallelFor(image.mcus_y, static_cast<size_t>(width) * height * 4,
+                             [&](int32_t begin, int32_t end)
+                             { ConvertMcuRows(image, dst, begin, end); });
+    return true;
+}
@@ -0,0 +1,164 @@
+#include "include/texture_interface/mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+namespace
+{
+    std::wstring Widen(const std::string &path)
+    {
+        int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wide.data(), length);
+        wide.resize(length - 1);
+        return wide;
+    }
+}
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Create(const std::string &path, size_t size)
+{
+    HANDLE file = CreateFileW(Widen(path).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    mapped->file_ = file;
+    if (!mapped->Map(size, true))
+        return nullptr;
+    return mapped;
+}
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path)
+{
+    HANDLE file = CreateFileW(Widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    mapped->file_ = file;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || !mapped->Map(static_cast<size_t>(size.QuadPart), false))
+        return nullptr;
+    return mapped;
+}
+
+bool MappedFile::Map(size_t size, bool writable)
+{
+    // mapping a file for writing extends it to |size|
+    mapping_ = CreateFileMappingW(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                  static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                  static_cast<DWORD>(size), nullptr);
+    if (mapping_ == nullptr)
+        return false;
+    data_ = static_cast<uint8_t *>(MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size));
+    if (data_ == nullptr)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+        return false;
+    }
+    size_ = size;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    Unmap();
+    LARGE_INTEGER end{};
+    end.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(file_, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file_))
+        return false;
+    return size == 0 || Map(size, true);
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+    if (file_ != nullptr)
+        CloseHandle(file_);
+}
+
+#else
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Create(const std::string &path, size_t size)
+{
+    int fd = open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0)
+        return nullptr;
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    mapped->fd_ = fd;
+    if (!mapped->Resize(size))
+        return nullptr;
+    return mapped;
+}
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    mapped->fd_ = fd;
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0 || !mapped->Map(static_cast<size_t>(info.st_size), false))
+        return nullptr;
+    return mapped;
+}
+
+bool MappedFile::Map(size_t size, bool writable)
+{
+    void *data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = static_cast<uint8_t *>(data);
+    size_ = size;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (data_ != nullptr)
+        munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    Unmap();
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        return false;
+    return size == 0 || Map(size, true);
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+    if (fd_ >= 0)
+        close(fd_);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include "include/texture_interface/memory_budget.h"
+
+#include "include/texture_interface/frame.h"
+#include "include/texture_interface/frame_stats.h"
+
+#include <algorithm>
+#include <utility>
+
+void MemoryBudget::Configure(size_t limit_bytes, int64_t idle_time)
+{
+    idle_time_.store(idle_time);
+    limit_bytes_.store(limit_bytes);
+    Enforce();
+}
+
+void MemoryBudget::Add(Frame *frame)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    frames_.push_back(frame);
+}
+
+void MemoryBudget::Remove(Frame *frame)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    frames_.erase(std::remove(frames_.begin(), frames_.end(), frame), frames_.end());
+}
+
+void MemoryBudget::Enforce(const Frame *active)
+{
+    size_t limit = limit_bytes_.load();
+    if (limit == 0 || resident_total_.load() <= limit)
+        return;
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // evicted frames give back the buffers the raster thread held once it
+    // moved on to the placeholder
+    for (Frame *frame : frames_)
+    {
+        if (frame->evicted())
+            frame->Trim();
+    }
+    size_t resident = resident_total_.load();
+    if (resident <= limit)
+        return;
+
+    // free buffers cost nothing but a reallocation
+    for (Frame *frame : frames_)
+        frame->Trim();
+    resident = resident_total_.load();
+    if (resident <= limit)
+        return;
+
+    // least recently used first, by a snapshot of the times since fetches
+    // keep moving them
+    int64_t idle_before = FrameStats::Now() - idle_time_.load();
+    std::vector<std::pair<int64_t, Frame *>> idle;
+    for (Frame *frame : frames_)
+    {
+        int64_t last_active = frame->last_active();
+        if (frame != active && !frame->evicted() && last_active <= idle_before)
+            idle.emplace_back(last_active, frame);
+    }
+    std::sort(idle.begin(), idle.end(),
+              [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+    for (const auto &[last_active, frame] : idle)
+    {
+        size_t freed = frame->Evict();
+        resident -= std::min(resident, freed);
+        if (resident <= limit)
+            return;
+    }
+}
@@ -0,0 +1,238 @@
+#include "include/texture_interface/page_allocator.h"
+
+#include <atomic>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t kHeapAlignment = 64;
+    constexpr size_t kPageSize = 4096;
+
+    std::atomic<bool> huge_pages{false};
+    std::atomic<bool> numa_local{false};
+
+    size_t RoundUp(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    PageAllocation AllocateHeap(size_t size)
+    {
+        uint8_t *data = static_cast<uint8_t *>(::operator new(size, std::align_val_t(kHeapAlignment), std::nothrow));
+        return {data, size, false, false, -1};
+    }
+
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege, which has to be granted to the
+    // user and enabled in the process token. Tried once.
+    bool EnableLockMemoryPrivilege()
+    {
+        static const bool enabled = []
+        {
+            HANDLE token;
+            if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+                return false;
+            TOKEN_PRIVILEGES privileges = {};
+            privileges.PrivilegeCount = 1;
+            privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+            bool adjusted = LookupPrivilegeValueW(nullptr, L"SeLockMemoryPrivilege",
+                                                  &privileges.Privileges[0].Luid) &&
+                            AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+                            GetLastError() != ERROR_NOT_ALL_ASSIGNED;
+            CloseHandle(token);
+            return adjusted;
+        }();
+        return enabled;
+    }
+
+    uint8_t *VirtualAllocOn(size_t size, DWORD type, int32_t node)
+    {
+        void *data = node >= 0 ? VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, type, PAGE_READWRITE,
+                                                    static_cast<DWORD>(node))
+                               : VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+        return static_cast<uint8_t *>(data);
+    }
+#else
+    constexpr size_t kHugePageSize = 2 << 20;
+
+    // MPOL_PREFERRED, the node is used while it has free memory
+    constexpr int kPreferredPolicy = 1;
+
+    void BindToNode(void *data, size_t size, int32_t node)
+    {
+#ifdef SYS_mbind
+        constexpr size_t kMaxNodes = 1024;
+        constexpr size_t kMaskBits = sizeof(unsigned long) * 8;
+        if (node < 0 || static_cast<size_t>(node) >= kMaxNodes)
+            return;
+        unsigned long mask[kMaxNodes / kMaskBits] = {};
+        mask[node / kMaskBits] = 1ul << (node % kMaskBits);
+        // best effort, the pages land on the allocating thread's node by
+        // default anyway unless the process policy says otherwise
+        syscall(SYS_mbind, data, size, kPreferredPolicy, mask, kMaxNodes + 1, 0);
+#else
+        (void)data;
+        (void)size;
+        (void)node;
+#endif
+    }
+
+    // Maps |size| bytes aligned to a huge page, so that transparent huge
+    // pages can back all of it.
+    uint8_t *MapHugeAligned(size_t size)
+    {
+        size_t padded = size + kHugePageSize;
+        void *mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+            return nullptr;
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t aligned = RoundUp(start, kHugePageSize);
+        if (aligned > start)
+            munmap(mapping, aligned - start);
+        size_t tail = padded - (aligned - start) - size;
+        if (tail > 0)
+            munmap(reinterpret_cast<void *>(aligned + size), tail);
+        return reinterpret_cast<uint8_t *>(aligned);
+    }
+#endif
+}
+
+void SetPagePolicy(const PagePolicy &policy)
+{
+    huge_pages.store(policy.huge_pages);
+    numa_local.store(policy.numa_local);
+}
+
+PagePolicy GetPagePolicy()
+{
+    return {huge_pages.load(), numa_local.load()};
+}
+
+#ifdef _WIN32
+
+int32_t CurrentNumaNode()
+{
+    if (!numa_local.load())
+        return -1;
+    PROCESSOR_NUMBER processor;
+    GetCurrentProcessorNumberEx(&processor);
+    USHORT node;
+    if (!GetNumaProcessorNodeEx(&processor, &node))
+        return -1;
+    return node;
+}
+
+PageAllocation AllocatePages(size_t size)
+{
+    PagePolicy policy = GetPagePolicy();
+    if (!policy.huge_pages && !policy.numa_local)
+        return AllocateHeap(size);
+
+    int32_t node = CurrentNumaNode();
+    size_t large_page = GetLargePageMinimum();
+    if (policy.huge_pages && large_page > 0 && size >= kMinHugePageBuffer && EnableLockMemoryPrivilege())
+    {
+        // large pages are committed and locked right away
+        size_t rounded = RoundUp(size, large_page);
+        if (uint8_t *data = VirtualAllocOn(rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, node))
+            return {data, rounded, true, true, node};
+    }
+    size_t rounded = RoundUp(size, kPageSize);
+    if (uint8_t *data = VirtualAllocOn(rounded, MEM_RESERVE | MEM_COMMIT, node))
+        return {data, rounded, true, false, node};
+    return AllocateHeap(size);
+}
+
+void FreePages(const PageAllocation &allocation)
+{
+    if (allocation.data == nullptr)
+        return;
+    if (allocation.mapped)
+        VirtualFree(allocation.data, 0, MEM_RELEASE);
+    else
+        ::operator delete(allocation.data, std::align_val_t(kHeapAlignment));
+}
+
+#else
+
+int32_t CurrentNumaNode()
+{
+    if (!numa_local.load())
+        return -1;
+#ifdef SYS_getcpu
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return static_cast<int32_t>(node);
+#endif
+    return -1;
+}
+
+PageAllocation AllocatePages(size_t size)
+{
+    PagePolicy policy = GetPagePolicy();
+    if (!policy.huge_pages && !policy.numa_local)
+        return AllocateHeap(size);
+
+    int32_t node = CurrentNumaNode();
+    size_t pages = RoundUp(size, kPageSize);
+    uint8_t *data = nullptr;
+    size_t mapped = 0;
+    bool huge = false;
+    if (policy.huge_pages && size >= kMinHugePageBuffer)
+    {
+#ifdef MAP_HUGETLB
+        // reserved hugetlbfs pages first, most systems have none
+        size_t rounded = RoundUp(size, kHugePageSize);
+        void *mapping = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                             -1, 0);
+        if (mapping != MAP_FAILED)
+        {
+            data = static_cast<uint8_t *>(mapping);
+            mapped = rounded;
+            huge = true;
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        if (data == nullptr)
+        {
+            // then transparent huge pages, if the kernel has them enabled
+            // for madvised ranges
+            data = MapHugeAligned(pages);
+            mapped = pages;
+            huge = data != nullptr && madvise(data, pages, MADV_HUGEPAGE) == 0;
+        }
+#endif
+    }
+    if (data == nullptr)
+    {
+        mapped = pages;
+        void *mapping = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+            return AllocateHeap(size);
+        data = static_cast<uint8_t *>(mapping);
+    }
+    // nothing is faulted in yet, BufferPool touches the pages after this
+    if (node >= 0)
+        BindToNode(data, mapped, node);
+    return {data, mapped, true, huge, node};
+}
+
+void FreePages(const PageAllocation &allocation)
+{
+    if (allocation.data == nullptr)
+        return;
+    if (allocation.mapped)
+        munmap(allocation.data, allocation.size);
+    else
+        ::operator delete(allocation.data, std::align_val_t(kHeapAlignment));
+}
+
+#endif
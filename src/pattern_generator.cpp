@@ -0,0 +1,126 @@
+#include "include/texture_interface/pattern_generator.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "include/texture_interface/frame_stats.h"
+
+PatternGenerator::PatternGenerator(WorkerPool *workers) : workers_(workers) {}
+
+PatternGenerator::~PatternGenerator()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+bool PatternGenerator::Start(Frame *frame, const PatternConfig &config)
+{
+    if (frame == nullptr || config.width <= 0 || config.height <= 0 || !(config.fps >= 0) ||
+        !IsValidTestPattern(static_cast<int32_t>(config.pattern)))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(streams_.begin(), streams_.end(),
+                               [frame](const Stream &stream)
+                               { return stream.frame == frame; });
+        if (it != streams_.end())
+            it->config = config;
+        else
+            streams_.push_back({frame, config, 0, FrameStats::Now()});
+        if (!thread_.joinable())
+            thread_ = std::thread(&PatternGenerator::Loop, this);
+    }
+    changed_.notify_all();
+    return true;
+}
+
+bool PatternGenerator::Stop(Frame *frame)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find_if(streams_.begin(), streams_.end(),
+                           [frame](const Stream &stream)
+                           { return stream.frame == frame; });
+    if (it == streams_.end())
+        return false;
+    streams_.erase(it);
+    changed_.wait(lock, [&]
+                  { return rendering_ != frame; });
+    return true;
+}
+
+size_t PatternGenerator::active_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return streams_.size();
+}
+
+void PatternGenerator::Loop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+        if (streams_.empty())
+        {
+            changed_.wait(lock);
+            continue;
+        }
+        auto next = std::min_element(streams_.begin(), streams_.end(),
+                                     [](const Stream &a, const Stream &b)
+                                     { return a.due_at < b.due_at; });
+        int64_t now = FrameStats::Now();
+        if (next->due_at > now)
+        {
+            changed_.wait_for(lock, std::chrono::nanoseconds(next->due_at - now));
+            continue;
+        }
+
+        if (next->config.fps > 0)
+        {
+            int64_t period = static_cast<int64_t>(1e9 / next->config.fps);
+            next->due_at += period;
+            // skip what was missed instead of catching up
+            if (next->due_at <= now)
+                next->due_at = now + period;
+        }
+        else if (!next->frame->ReadyForFrame())
+        {
+            next->due_at = now + kReadyPollInterval;
+            continue;
+        }
+
+        Stream stream = *next;
+        next->index++;
+        rendering_ = stream.frame;
+        lock.unlock();
+        Render(stream);
+        lock.lock();
+        rendering_ = nullptr;
+        changed_.notify_all();
+    }
+}
+
+void PatternGenerator::Render(const Stream &stream)
+{
+    const PatternConfig &config = stream.config;
+    uint8_t *buffer = stream.frame->AcquireBuffer(config.width, config.height);
+    if (buffer == nullptr)
+        return;
+    int64_t timestamp = FrameStats::Now();
+    auto render = [&](int32_t begin, int32_t end)
+    {
+        RenderTestPatternRows(config.pattern, config.color, stream.index, timestamp, buffer, config.width,
+                              config.height, begin, end);
+    };
+    size_t bytes = static_cast<size_t>(config.width) * config.height * 4;
+    if (workers_ != nullptr)
+        workers_->ParallelFor(config.height, bytes, render);
+    else
+        render(0, config.height);
+    stream.frame->SubmitBuffer(buffer, config.width, config.height);
+}
@@ -0,0 +1,164 @@
+#include "include/texture_interface/pixel_convert.h"
+
+#include <cstring>
+
+namespace
+{
+    inline uint8_t Clamp(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    inline void YuvPixel(int y, int u, int v, uint8_t *dst)
+    {
+        int luma = ((y * 257 * kYuvY) >> 16) - kYuvYBias;
+        int d = u - 128;
+        int e = v - 128;
+        dst[0] = Clamp((luma + kYuvVToR * e) >> 6);
+        dst[1] = Clamp((luma - kYuvUToG * d - kYuvVToG * e) >> 6);
+        dst[2] = Clamp((luma + kYuvUToB * d) >> 6);
+        dst[3] = 255;
+    }
+
+    const ConvertKernels kScalarKernels = {
+        ScalarBgraRow,
+        ScalarRgb24Row,
+        ScalarRgb565Row,
+        ScalarNv12Row,
+        ScalarI420Row,
+    };
+
+    ConvertKernels Merge(const ConvertKernels &base, const ConvertKernels *tier)
+    {
+        if (tier == nullptr)
+            return base;
+        return {
+            tier->bgra != nullptr ? tier->bgra : base.bgra,
+            tier->rgb24 != nullptr ? tier->rgb24 : base.rgb24,
+            tier->rgb565 != nullptr ? tier->rgb565 : base.rgb565,
+            tier->nv12 != nullptr ? tier->nv12 : base.nv12,
+            tier->i420 != nullptr ? tier->i420 : base.i420,
+        };
+    }
+}
+
+void ScalarBgraRow(const uint8_t *src, uint8_t *dst, int32_t width)
+{
+    for (int32_t x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        uint8_t b = src[0];
+        dst[1] = src[1];
+        dst[0] = src[2];
+        dst[2] = b;
+        dst[3] = src[3];
+    }
+}
+
+void ScalarRgb24Row(const uint8_t *src, uint8_t *dst, int32_t width)
+{
+    for (int32_t x = 0; x < width; x++, src += 3, dst += 4)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+    }
+}
+
+void ScalarRgb565Row(const uint8_t *src, uint8_t *dst, int32_t width)
+{
+    for (int32_t x = 0; x < width; x++, src += 2, dst += 4)
+    {
+        uint16_t pixel = static_cast<uint16_t>(src[0] | (src[1] << 8));
+        int r = (pixel >> 11) & 0x1F;
+        int g = (pixel >> 5) & 0x3F;
+        int b = pixel & 0x1F;
+        dst[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        dst[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        dst[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        dst[3] = 255;
+    }
+}
+
+void ScalarNv12Row(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int32_t width)
+{
+    for (int32_t x = 0; x < width; x++, dst += 4)
+        YuvPixel(y[x], uv[(x & ~1)], uv[(x & ~1) + 1], dst);
+}
+
+void ScalarI420Row(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int32_t width)
+{
+    for (int32_t x = 0; x < width; x++, dst += 4)
+        YuvPixel(y[x], u[x >> 1], v[x >> 1], dst);
+}
+
+const ConvertKernels &ConvertKernelsFor(SimdTier tier)
+{
+    static const ConvertKernels sse2 = Merge(kScalarKernels, Sse2ConvertKernels());
+    static const ConvertKernels avx2 = Merge(sse2, Avx2ConvertKernels());
+    switch (tier)
+    {
+    case SimdTier::kAvx2:
+        return avx2;
+    case SimdTier::kSse2:
+        return sse2;
+    case SimdTier::kScalar:
+        break;
+    }
+    return kScalarKernels;
+}
+
+const ConvertKernels &ActiveConvertKernels()
+{
+    static const ConvertKernels &kernels = ConvertKernelsFor(DetectSimdTier());
+    return kernels;
+}
+
+void ConvertRows(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                 int32_t width, int32_t height, uint8_t *dst,
+                 int32_t row_begin, int32_t row_end,
+                 const ConvertKernels &kernels)
+{
+    size_t dst_stride = static_cast<size_t>(width) * 4;
+    uint8_t *dst_row = dst + row_begin * dst_stride;
+    for (int32_t row = row_begin; row < row_end; row++, dst_row += dst_stride)
+        ConvertRow(format, src, src_stride, width, height, row, dst_row, kernels);
+}
+
+void ConvertRow(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                int32_t width, int32_t height, int32_t row, uint8_t *dst_row,
+                const ConvertKernels &kernels)
+{
+    const uint8_t *src_row = src + static_cast<size_t>(row) * src_stride;
+    switch (format)
+    {
+    case PixelFormat::kRGBA:
+        std::memcpy(dst_row, src_row, static_cast<size_t>(width) * 4);
+        break;
+    case PixelFormat::kBGRA:
+        kernels.bgra(src_row, dst_row, width);
+        break;
+    case PixelFormat::kRGB24:
+        kernels.rgb24(src_row, dst_row, width);
+        break;
+    case PixelFormat::kRGB565:
+        kernels.rgb565(src_row, dst_row, width);
+        break;
+    case PixelFormat::kNV12:
+    {
+        const uint8_t *uv_plane = src + static_cast<size_t>(height) * src_stride;
+        kernels.nv12(src_row, uv_plane + static_cast<size_t>(row >> 1) * src_stride, dst_row, width);
+        break;
+    }
+    case PixelFormat::kI420:
+    {
+        size_t chroma_stride = (static_cast<size_t>(src_stride) + 1) / 2;
+        size_t chroma_rows = (static_cast<size_t>(height) + 1) / 2;
+        const uint8_t *u_plane = src + static_cast<size_t>(height) * src_stride;
+        const uint8_t *v_plane = u_plane + chroma_rows * chroma_stride;
+        kernels.i420(src_row, u_plane + (row >> 1) * chroma_stride, v_plane + (row >> 1) * chroma_stride,
+                     dst_row, width);
+        break;
+    }
+    }
+}
@@ -0,0 +1,160 @@
+#include "include/texture_interface/pixel_convert.h"
+
+// Built with AVX2 code generation enabled, only called after DetectSimdTier
+// reported AVX2 support.
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace
+{
+    void Avx2BgraRow(const uint8_t *src, uint8_t *dst, int32_t width)
+    {
+        const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                              2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 4));
+            __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 4 + 32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4), _mm256_shuffle_epi8(first, swap));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4 + 32), _mm256_shuffle_epi8(second, swap));
+        }
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4), _mm256_shuffle_epi8(pixels, swap));
+        }
+        ScalarBgraRow(src + x * 4, dst + x * 4, width - x);
+    }
+
+    void Avx2Rgb24Row(const uint8_t *src, uint8_t *dst, int32_t width)
+    {
+        // each lane expands 12 source bytes into 4 pixels
+        const __m256i expand = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+        int32_t x = 0;
+        // the second lane loads 16 bytes from offset 12, stay 4 bytes clear
+        // of the end of the row
+        for (; x + 10 <= width; x += 8)
+        {
+            const uint8_t *pixels = src + x * 3;
+            __m256i source = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 12)), 1);
+            __m256i result = _mm256_or_si256(_mm256_shuffle_epi8(source, expand), alpha);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4), result);
+        }
+        ScalarRgb24Row(src + x * 3, dst + x * 4, width - x);
+    }
+
+    void Avx2Rgb565Row(const uint8_t *src, uint8_t *dst, int32_t width)
+    {
+        const __m256i mask5 = _mm256_set1_epi16(0x1F);
+        const __m256i mask6 = _mm256_set1_epi16(0x3F);
+        const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2));
+            __m256i r = _mm256_and_si256(_mm256_srli_epi16(pixels, 11), mask5);
+            __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixels, 5), mask6);
+            __m256i b = _mm256_and_si256(pixels, mask5);
+            r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+            g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+            b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+            __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+            __m256i ba = _mm256_or_si256(b, alpha);
+            // unpack works per lane: low holds pixels 0-3 and 8-11
+            __m256i low = _mm256_unpacklo_epi16(rg, ba);
+            __m256i high = _mm256_unpackhi_epi16(rg, ba);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4), _mm256_permute2x128_si256(low, high, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+        }
+        ScalarRgb565Row(src + x * 2, dst + x * 4, width - x);
+    }
+
+    // Converts 16 pixels of 16 bit luma and per pixel chroma and stores them.
+    inline void Avx2YuvToRgba16(__m256i y, __m256i u, __m256i v, uint8_t *dst)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i luma = _mm256_sub_epi16(
+            _mm256_mulhi_epu16(_mm256_or_si256(y, _mm256_slli_epi16(y, 8)), _mm256_set1_epi16(static_cast<short>(kYuvY))),
+            _mm256_set1_epi16(kYuvYBias));
+        __m256i d = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+        __m256i e = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+
+        __m256i r = _mm256_adds_epi16(luma, _mm256_mullo_epi16(e, _mm256_set1_epi16(kYuvVToR)));
+        __m256i g = _mm256_subs_epi16(_mm256_subs_epi16(luma, _mm256_mullo_epi16(d, _mm256_set1_epi16(kYuvUToG))),
+                                      _mm256_mullo_epi16(e, _mm256_set1_epi16(kYuvVToG)));
+        __m256i b = _mm256_adds_epi16(luma, _mm256_mullo_epi16(d, _mm256_set1_epi16(kYuvUToB)));
+        r = _mm256_packus_epi16(_mm256_srai_epi16(r, 6), zero);
+        g = _mm256_packus_epi16(_mm256_srai_epi16(g, 6), zero);
+        b = _mm256_packus_epi16(_mm256_srai_epi16(b, 6), zero);
+
+        __m256i rg = _mm256_unpacklo_epi8(r, g);
+        __m256i ba = _mm256_unpacklo_epi8(b, _mm256_set1_epi8(static_cast<char>(0xFF)));
+        __m256i low = _mm256_unpacklo_epi16(rg, ba);
+        __m256i high = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+
+    void Avx2Nv12Row(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int32_t width)
+    {
+        const __m256i low_word = _mm256_set1_epi32(0xFFFF);
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)));
+            __m256i chroma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x)));
+            __m256i u = _mm256_and_si256(chroma, low_word);
+            u = _mm256_or_si256(u, _mm256_slli_epi32(u, 16));
+            __m256i v = _mm256_srli_epi32(chroma, 16);
+            v = _mm256_or_si256(v, _mm256_slli_epi32(v, 16));
+            Avx2YuvToRgba16(luma, u, v, dst + x * 4);
+        }
+        ScalarNv12Row(y + x, uv + x, dst + x * 4, width - x);
+    }
+
+    inline __m256i LoadChroma8(const uint8_t *plane)
+    {
+        __m128i chroma = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(plane)));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(chroma, chroma)),
+                                       _mm_unpackhi_epi16(chroma, chroma), 1);
+    }
+
+    void Avx2I420Row(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int32_t width)
+    {
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)));
+            Avx2YuvToRgba16(luma, LoadChroma8(u + x / 2), LoadChroma8(v + x / 2), dst + x * 4);
+        }
+        ScalarI420Row(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+    }
+
+    const ConvertKernels kAvx2Kernels = {
+        Avx2BgraRow,
+        Avx2Rgb24Row,
+        Avx2Rgb565Row,
+        Avx2Nv12Row,
+        Avx2I420Row,
+    };
+}
+
+const ConvertKernels *Avx2ConvertKernels()
+{
+    return &kAvx2Kernels;
+}
+
+#else
+
+const ConvertKernels *Avx2ConvertKernels()
+{
+    return nullptr;
+}
+
+#endif
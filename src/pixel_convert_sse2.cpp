@@ -0,0 +1,137 @@
+#include "include/texture_interface/pixel_convert.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+#include <cstring>
+
+namespace
+{
+    void Sse2BgraRow(const uint8_t *src, uint8_t *dst, int32_t width)
+    {
+        const __m128i green_alpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m128i low_byte = _mm_set1_epi32(0x000000FF);
+        int32_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4));
+            // swap bytes 0 and 2 of every pixel
+            __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte);
+            __m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, low_byte), 16);
+            __m128i result = _mm_or_si128(_mm_and_si128(pixels, green_alpha), _mm_or_si128(red, blue));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), result);
+        }
+        ScalarBgraRow(src + x * 4, dst + x * 4, width - x);
+    }
+
+    void Sse2Rgb565Row(const uint8_t *src, uint8_t *dst, int32_t width)
+    {
+        const __m128i mask5 = _mm_set1_epi16(0x1F);
+        const __m128i mask6 = _mm_set1_epi16(0x3F);
+        const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+        int32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2));
+            __m128i r = _mm_and_si128(_mm_srli_epi16(pixels, 11), mask5);
+            __m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask6);
+            __m128i b = _mm_and_si128(pixels, mask5);
+            r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+            g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+            b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+            __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+            __m128i ba = _mm_or_si128(b, alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+        }
+        ScalarRgb565Row(src + x * 2, dst + x * 4, width - x);
+    }
+
+    // Converts 8 pixels of 16 bit luma and per pixel chroma and stores them.
+    inline void Sse2YuvToRgba8(__m128i y, __m128i u, __m128i v, uint8_t *dst)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i luma = _mm_sub_epi16(_mm_mulhi_epu16(_mm_or_si128(y, _mm_slli_epi16(y, 8)),
+                                                     _mm_set1_epi16(static_cast<short>(kYuvY))),
+                                     _mm_set1_epi16(kYuvYBias));
+        __m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+        __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+        // saturation only happens far above 255 << 6 and packus clamps anyway
+        __m128i r = _mm_adds_epi16(luma, _mm_mullo_epi16(e, _mm_set1_epi16(kYuvVToR)));
+        __m128i g = _mm_subs_epi16(_mm_subs_epi16(luma, _mm_mullo_epi16(d, _mm_set1_epi16(kYuvUToG))),
+                                   _mm_mullo_epi16(e, _mm_set1_epi16(kYuvVToG)));
+        __m128i b = _mm_adds_epi16(luma, _mm_mullo_epi16(d, _mm_set1_epi16(kYuvUToB)));
+        r = _mm_packus_epi16(_mm_srai_epi16(r, 6), zero);
+        g = _mm_packus_epi16(_mm_srai_epi16(g, 6), zero);
+        b = _mm_packus_epi16(_mm_srai_epi16(b, 6), zero);
+
+        __m128i rg = _mm_unpacklo_epi8(r, g);
+        __m128i ba = _mm_unpacklo_epi8(b, _mm_set1_epi8(static_cast<char>(0xFF)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    void Sse2Nv12Row(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int32_t width)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low_word = _mm_set1_epi32(0xFFFF);
+        int32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i luma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)), zero);
+            // U0 V0 U1 V1 .. as 16 bit, widened to one U and one V per pixel
+            __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(uv + x)), zero);
+            __m128i u = _mm_and_si128(chroma, low_word);
+            u = _mm_or_si128(u, _mm_slli_epi32(u, 16));
+            __m128i v = _mm_srli_epi32(chroma, 16);
+            v = _mm_or_si128(v, _mm_slli_epi32(v, 16));
+            Sse2YuvToRgba8(luma, u, v, dst + x * 4);
+        }
+        ScalarNv12Row(y + x, uv + x, dst + x * 4, width - x);
+    }
+
+    inline __m128i LoadChroma4(const uint8_t *plane)
+    {
+        int32_t value;
+        std::memcpy(&value, plane, sizeof(value));
+        __m128i chroma = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), _mm_setzero_si128());
+        return _mm_unpacklo_epi16(chroma, chroma);
+    }
+
+    void Sse2I420Row(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int32_t width)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        int32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i luma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)), zero);
+            Sse2YuvToRgba8(luma, LoadChroma4(u + x / 2), LoadChroma4(v + x / 2), dst + x * 4);
+        }
+        ScalarI420Row(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+    }
+
+    const ConvertKernels kSse2Kernels = {
+        Sse2BgraRow,
+        // packed 24 bit needs a byte shuffle, see the AVX2 kernels
+        nullptr,
+        Sse2Rgb565Row,
+        Sse2Nv12Row,
+        Sse2I420Row,
+    };
+}
+
+const ConvertKernels *Sse2ConvertKernels()
+{
+    return &kSse2Kernels;
+}
+
+#else
+
+const ConvertKernels *Sse2ConvertKernels()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "include/texture_interface/pixel_scale.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // rows the 32 bit column sums take before they could overflow, taller
+    // boxes carry them into 64 bit sums every that many rows
+    constexpr int32_t kMaxBoxRows = 1 << 16;
+
+    // Rows a thread needs to scale a band, kept across frames so that
+    // steady state scaling does not allocate. Bands run on the worker pool's
+    // threads and on every producer thread calling it, each uses its own.
+    struct ScaleScratch
+    {
+        std::vector<uint32_t> sums;
+        std::vector<uint8_t> rows;
+        // column sums of boxes taller than kMaxBoxRows
+        std::vector<uint64_t> wide_sums;
+    };
+
+    ScaleScratch &ThreadScratch(size_t sums, size_t rows)
+    {
+        thread_local ScaleScratch scratch;
+        if (scratch.sums.size() < sums)
+            scratch.sums.resize(sums);
+        if (scratch.rows.size() < rows)
+            scratch.rows.resize(rows);
+        return scratch;
+    }
+
+    const ScaleKernels kScalarKernels = {
+        ScalarAccumulateRow,
+        ScalarBlendRows,
+    };
+
+    ScaleKernels Merge(const ScaleKernels &base, const ScaleKernels *tier)
+    {
+        if (tier == nullptr)
+            return base;
+        return {
+            tier->accumulate != nullptr ? tier->accumulate : base.accumulate,
+            tier->blend != nullptr ? tier->blend : base.blend,
+        };
+    }
+
+    // Row |row| as packed RGBA, converted into |scratch| unless the source
+    // already is.
+    const uint8_t *SourceRow(PixelFormat format, const uint8_t *src, int32_t src_stride,
+                             int32_t width, int32_t height, int32_t row, uint8_t *scratch,
+                             const ConvertKernels &convert)
+    {
+        if (format == PixelFormat::kRGBA)
+            return src + static_cast<size_t>(row) * src_stride;
+        ConvertRow(format, src, src_stride, width, height, row, scratch, convert);
+        return scratch;
+    }
+
+    // First and one past the last of the |size| source pixels that
+    // destination pixel |index| of |dst_size| covers.
+    inline void Span(int32_t index, int32_t size, int32_t dst_size, int32_t *begin, int32_t *end)
+    {
+        *begin = static_cast<int32_t>(static_cast<int64_t>(index) * size / dst_size);
+        *end = std::max(*begin + 1, static_cast<int32_t>(static_cast<int64_t>(index + 1) * size / dst_size));
+    }
+
+    // Source position of the center of destination pixel |index| in 16.16
+    // fixed point, split into the pixel left of it and the weight of the one
+    // right of it in 1/256.
+    inline void Sample(int32_t index, int32_t size, int32_t dst_size, int32_t *first, int32_t *weight)
+    {
+        int64_t position = ((static_cast<int64_t>(2 * index + 1) * size) << 15) / dst_size - (1 << 15);
+        position = std::max<int64_t>(position, 0);
+        *first = static_cast<int32_t>(position >> 16);
+        *weight = static_cast<int32_t>((position >> 8) & 0xFF);
+    }
+
+    // Adds the column sums of pixels [x0, x1) to |total|.
+    template <typename Sum>
+    inline void AddColumns(const Sum *sums, int32_t x0, int32_t x1, uint64_t *total)
+    {
+        for (int32_t x = x0; x < x1; x++)
+        {
+            const Sum *sum = &sums[static_cast<size_t>(x) * 4];
+            total[0] += sum[0];
+            total[1] += sum[1];
+            total[2] += sum[2];
+            total[3] += sum[3];
+        }
+    }
+
+    void BoxRows(PixelFormat format, const uint8_t *src, int32_t src_stride, int32_t width, int32_t height,
+                 uint8_t *dst, int32_t dst_width, int32_t dst_height, int32_t row_begin, int32_t row_end,
+                 const ConvertKernels &convert, const ScaleKernels &scale)
+    {
+        size_t row_bytes = static_cast<size_t>(width) * 4;
+        ScaleScratch &scratch = ThreadScratch(row_bytes, format == PixelFormat::kRGBA ? 0 : row_bytes);
+        uint32_t *sums = scratch.sums.data();
+        for (int32_t dst_y = row_begin; dst_y < row_end; dst_y++)
+        {
+            // sum the covered rows first, every source byte is touched once
+            int32_t y0, y1;
+            Span(dst_y, height, dst_height, &y0, &y1);
+            bool tall = y1 - y0 > kMaxBoxRows;
+            uint64_t *wide_sums = nullptr;
+            if (tall)
+            {
+                scratch.wide_sums.assign(row_bytes, 0);
+                wide_sums = scratch.wide_sums.data();
+            }
+            std::fill(sums, sums + row_bytes, 0);
+            for (int32_t y = y0; y < y1; y++)
+            {
+                scale.accumulate(SourceRow(format, src, src_stride, width, height, y, scratch.rows.data(), convert),
+                                 sums, row_bytes);
+                if (tall && ((y + 1 - y0) % kMaxBoxRows == 0 || y + 1 == y1))
+                {
+                    for (size_t i = 0; i < row_bytes; i++)
+                        wide_sums[i] += sums[i];
+                    std::fill(sums, sums + row_bytes, 0);
+                }
+            }
+
+            uint8_t *dst_row = dst + static_cast<size_t>(dst_y) * dst_width * 4;
+            for (int32_t dst_x = 0; dst_x < dst_width; dst_x++, dst_row += 4)
+            {
+                int32_t x0, x1;
+                Span(dst_x, width, dst_width, &x0, &x1);
+                // a 16384 pixel wide box of 65536 rows needs more than 32 bits
+                uint64_t total[4] = {0, 0, 0, 0};
+                if (tall)
+                    AddColumns(wide_sums, x0, x1, total);
+                else
+                    AddColumns(sums, x0, x1, total);
+                uint64_t count = static_cast<uint64_t>(x1 - x0) * static_cast<uint64_t>(y1 - y0);
+                for (int channel = 0; channel < 4; channel++)
+                    dst_row[channel] = static_cast<uint8_t>((total[channel] + count / 2) / count);
+            }
+        }
+    }
+
+    void BilinearRows(PixelFormat format, const uint8_t *src, int32_t src_stride, int32_t width, int32_t height,
+                      uint8_t *dst, int32_t dst_width, int32_t dst_height, int32_t row_begin, int32_t row_end,
+                      const ConvertKernels &convert, const ScaleKernels &scale)
+    {
+        size_t row_bytes = static_cast<size_t>(width) * 4;
+        uint8_t *top_scratch = ThreadScratch(0, row_bytes * 3).rows.data();
+        uint8_t *bottom_scratch = top_scratch + row_bytes;
+        uint8_t *blended = bottom_scratch + row_bytes;
+        for (int32_t dst_y = row_begin; dst_y < row_end; dst_y++)
+        {
+            int32_t y0, weight_y;
+            Sample(dst_y, height, dst_height, &y0, &weight_y);
+            int32_t y1 = std::min(y0 + 1, height - 1);
+            const uint8_t *top = SourceRow(format, src, src_stride, width, height, y0, top_scratch, convert);
+            const uint8_t *row = top;
+            if (weight_y != 0 && y1 != y0)
+            {
+                const uint8_t *bottom = SourceRow(format, src, src_stride, width, height, y1, bottom_scratch,
+                                                  convert);
+                scale.blend(top, bottom, blended, row_bytes, weight_y);
+                row = blended;
+            }
+
+            uint8_t *dst_row = dst + static_cast<size_t>(dst_y) * dst_width * 4;
+            for (int32_t dst_x = 0; dst_x < dst_width; dst_x++, dst_row += 4)
+            {
+                int32_t x0, weight_x;
+                Sample(dst_x, width, dst_width, &x0, &weight_x);
+                const uint8_t *left = row + static_cast<size_t>(x0) * 4;
+                const uint8_t *right = row + static_cast<size_t>(std::min(x0 + 1, width - 1)) * 4;
+                for (int channel = 0; channel < 4; channel++)
+                    dst_row[channel] = static_cast<uint8_t>(
+                        (left[channel] * (256 - weight_x) + right[channel] * weight_x + 128) >> 8);
+            }
+        }
+    }
+}
+
+void ScalarAccumulateRow(const uint8_t *src, uint32_t *sums, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sums[i] += src[i];
+}
+
+void ScalarBlendRows(const uint8_t *top, const uint8_t *bottom, uint8_t *dst, size_t count, int32_t weight)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = static_cast<uint8_t>((top[i] * (256 - weight) + bottom[i] * weight + 128) >> 8);
+}
+
+const ScaleKernels &ScaleKernelsFor(SimdTier tier)
+{
+    static const ScaleKernels sse2 = Merge(kScalarKernels, Sse2ScaleKernels());
+    static const ScaleKernels avx2 = Merge(sse2, Avx2ScaleKernels());
+    switch (tier)
+    {
+    case SimdTier::kAvx2:
+        return avx2;
+    case SimdTier::kSse2:
+        return sse2;
+    case SimdTier::kScalar:
+        break;
+    }
+    return kScalarKernels;
+}
+
+const ScaleKernels &ActiveScaleKernels()
+{
+    static const ScaleKernels &kernels = ScaleKernelsFor(DetectSimdTier());
+    return kernels;
+}
+
+bool DownscaledSize(int32_t width, int32_t height, int32_t display_width, int32_t display_height,
+                    int32_t *scaled_width, int32_t *scaled_height)
+{
+    if (width <= 0 || height <= 0 || display_width <= 0 || display_height <= 0)
+        return false;
+    // the axis that needs more pixels decides, the frame is never cropped
+    double factor = std::max(static_cast<double>(display_width) / width,
+                             static_cast<double>(display_height) / height);
+    if (factor >= 1.0)
+        return false;
+    *scaled_width = std::clamp(static_cast<int32_t>(std::ceil(width * factor)), 1, width);
+    *scaled_height = std::clamp(static_cast<int32_t>(std::ceil(height * factor)), 1, height);
+    return *scaled_width < width || *scaled_height < height;
+}
+
+void ScaleRows(PixelFormat format, const uint8_t *src, int32_t src_stride,
+               int32_t width, int32_t height, uint8_t *dst,
+               int32_t dst_width, int32_t dst_height,
+               int32_t row_begin, int32_t row_end,
+               const ConvertKernels &convert, const ScaleKernels &scale)
+{
+    // interpolating skips source pixels once they are more than two per
+    // destination pixel
+    if (width >= 2 * dst_width || height >= 2 * dst_height)
+        BoxRows(format, src, src_stride, width, height, dst, dst_width, dst_height, row_begin, row_end, convert,
+                scale);
+    else
+        BilinearRows(format, src, src_stride, width, height, dst, dst_width, dst_height, row_begin, row_end,
+                     convert, scale);
+}
@@ -0,0 +1,62 @@
+#include "include/texture_interface/pixel_scale.h"
+
+// Built with AVX2 code generation enabled, only called after DetectSimdTier
+// reported AVX2 support.
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace
+{
+    void Avx2AccumulateRow(const uint8_t *src, uint32_t *sums, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m256i *out = reinterpret_cast<__m256i *>(sums + i);
+            _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), _mm256_cvtepu8_epi32(bytes)));
+            _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1),
+                                                          _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8))));
+        }
+        ScalarAccumulateRow(src + i, sums + i, count - i);
+    }
+
+    void Avx2BlendRows(const uint8_t *top, const uint8_t *bottom, uint8_t *dst, size_t count, int32_t weight)
+    {
+        const __m256i top_weight = _mm256_set1_epi16(static_cast<short>(256 - weight));
+        const __m256i bottom_weight = _mm256_set1_epi16(static_cast<short>(weight));
+        const __m256i rounding = _mm256_set1_epi16(128);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            // the weights add up to 256, so products and sums fit 16 bit lanes
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(top + i)));
+            __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + i)));
+            __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(a, top_weight), _mm256_mullo_epi16(b, bottom_weight));
+            __m256i blended = _mm256_srli_epi16(_mm256_add_epi16(sum, rounding), 8);
+            __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(blended), _mm256_extracti128_si256(blended, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+        ScalarBlendRows(top + i, bottom + i, dst + i, count - i, weight);
+    }
+
+    const ScaleKernels kAvx2Kernels = {
+        Avx2AccumulateRow,
+        Avx2BlendRows,
+    };
+}
+
+const ScaleKernels *Avx2ScaleKernels()
+{
+    return &kAvx2Kernels;
+}
+
+#else
+
+const ScaleKernels *Avx2ScaleKernels()
+{
+    return nullptr;
+}
+
+#endif
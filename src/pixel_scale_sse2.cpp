@@ -0,0 +1,71 @@
+#include "include/texture_interface/pixel_scale.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+namespace
+{
+    void Sse2AccumulateRow(const uint8_t *src, uint32_t *sums, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            __m128i *out = reinterpret_cast<__m128i *>(sums + i);
+            _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), _mm_unpacklo_epi16(low, zero)));
+            _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), _mm_unpackhi_epi16(low, zero)));
+            _mm_storeu_si128(out + 2, _mm_add_epi32(_mm_loadu_si128(out + 2), _mm_unpacklo_epi16(high, zero)));
+            _mm_storeu_si128(out + 3, _mm_add_epi32(_mm_loadu_si128(out + 3), _mm_unpackhi_epi16(high, zero)));
+        }
+        ScalarAccumulateRow(src + i, sums + i, count - i);
+    }
+
+    // the weights add up to 256, so products and sums fit 16 bit lanes
+    inline __m128i Sse2Blend8(__m128i top, __m128i bottom, __m128i top_weight, __m128i bottom_weight)
+    {
+        __m128i sum = _mm_add_epi16(_mm_mullo_epi16(top, top_weight), _mm_mullo_epi16(bottom, bottom_weight));
+        return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+    }
+
+    void Sse2BlendRows(const uint8_t *top, const uint8_t *bottom, uint8_t *dst, size_t count, int32_t weight)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i top_weight = _mm_set1_epi16(static_cast<short>(256 - weight));
+        const __m128i bottom_weight = _mm_set1_epi16(static_cast<short>(weight));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + i));
+            __m128i low = Sse2Blend8(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), top_weight,
+                                     bottom_weight);
+            __m128i high = Sse2Blend8(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), top_weight,
+                                      bottom_weight);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(low, high));
+        }
+        ScalarBlendRows(top + i, bottom + i, dst + i, count - i, weight);
+    }
+
+    const ScaleKernels kSse2Kernels = {
+        Sse2AccumulateRow,
+        Sse2BlendRows,
+    };
+}
+
+const ScaleKernels *Sse2ScaleKernels()
+{
+    return &kSse2Kernels;
+}
+
+#else
+
+const ScaleKernels *Sse2ScaleKernels()
+{
+    return nullptr;
+}
+
+#endif
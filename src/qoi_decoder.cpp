@@ -0,0 +1,112 @@
+#include "include/texture_interface/image_decoder.h"
+
+#include <cstring>
+
+// The Quite OK Image format, https://qoiformat.org/qoi-specification.pdf.
+// Every pixel depends on the one before it, so it is decoded on one thread;
+// it is cheap enough that this keeps up with the frame rates JPEG does.
+
+namespace
+{
+    constexpr size_t kHeaderSize = 14;
+    constexpr size_t kEndMarkerSize = 8;
+
+    constexpr uint8_t kOpRgb = 0xFE;
+    constexpr uint8_t kOpRgba = 0xFF;
+    constexpr uint8_t kOpIndex = 0x00;
+    constexpr uint8_t kOpDiff = 0x40;
+    constexpr uint8_t kOpLuma = 0x80;
+    constexpr uint8_t kOpRun = 0xC0;
+    constexpr uint8_t kOpMask = 0xC0;
+
+    inline uint32_t ReadBigEndian(const uint8_t *bytes)
+    {
+        return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+               static_cast<uint32_t>(bytes[2]) << 8 | bytes[3];
+    }
+
+    inline size_t IndexHash(const uint8_t *pixel)
+    {
+        return (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+    }
+}
+
+bool ReadQoiInfo(const uint8_t *data, size_t size, ImageInfo *info)
+{
+    if (size < kHeaderSize + kEndMarkerSize || std::memcmp(data, "qoif", 4) != 0)
+        return false;
+    uint32_t width = ReadBigEndian(data + 4);
+    uint32_t height = ReadBigEndian(data + 8);
+    uint8_t channels = data[12];
+    if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX || (channels != 3 && channels != 4))
+        return false;
+    info->codec = ImageCodec::kQoi;
+    info->width = static_cast<int32_t>(width);
+    info->height = static_cast<int32_t>(height);
+    return true;
+}
+
+bool DecodeQoi(const uint8_t *data, size_t size, uint8_t *dst, int32_t width, int32_t height)
+{
+    // the end marker only pads the stream, chunks never reach into it
+    const uint8_t *in = data + kHeaderSize;
+    const uint8_t *end = data + size - kEndMarkerSize;
+    uint8_t *out = dst;
+    uint8_t *out_end = dst + static_cast<size_t>(width) * height * 4;
+
+    uint8_t index[64][4] = {};
+    uint8_t pixel[4] = {0, 0, 0, 255};
+    while (out < out_end)
+    {
+        if (in >= end)
+            return false;
+        uint8_t op = *in++;
+        size_t run = 1;
+        if (op == kOpRgb)
+        {
+            if (end - in < 3)
+                return false;
+            std::memcpy(pixel, in, 3);
+            in += 3;
+        }
+        else if (op == kOpRgba)
+        {
+            if (end - in < 4)
+                return false;
+            std::memcpy(pixel, in, 4);
+            in += 4;
+        }
+        else if ((op & kOpMask) == kOpIndex)
+        {
+            std::memcpy(pixel, index[op], 4);
+        }
+        else if ((op & kOpMask) == kOpDiff)
+        {
+            pixel[0] += ((op >> 4) & 3) - 2;
+            pixel[1] += ((op >> 2) & 3) - 2;
+            pixel[2] += (op & 3) - 2;
+        }
+        else if ((op & kOpMask) == kOpLuma)
+        {
+            if (in >= end)
+                return false;
+            uint8_t next = *in++;
+            int green = (op & 0x3F) - 32;
+            pixel[0] += green - 8 + (next >> 4);
+            pixel[1] += green;
+            pixel[2] += green - 8 + (next & 0x0F);
+        }
+        else
+        {
+            run = (op & 0x3F) + 1;
+        }
+
+        std::memcpy(index[IndexHash(pixel)], pixel, 4);
+        size_t left = static_cast<size_t>(out_end - out) / 4;
+        if (run > left)
+            return false;
+        for (size_t i = 0; i < run; i++, out += 4)
+            std::memcpy(out, pixel, 4);
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#include "include/texture_interface/release_queue.h"
+
+#include <algorithm>
+
+// static
+ReleaseQueue::Queues &ReleaseQueue::Instance()
+{
+    static Queues queues;
+    return queues;
+}
+
+// static
+int64_t ReleaseQueue::Create()
+{
+    Queues &queues = Instance();
+    const std::lock_guard<std::mutex> lock(queues.mutex);
+    int64_t queue = queues.next_id++;
+    queues.released.emplace(queue, std::vector<uint8_t *>());
+    return queue;
+}
+
+// static
+void ReleaseQueue::Destroy(int64_t queue)
+{
+    Queues &queues = Instance();
+    const std::lock_guard<std::mutex> lock(queues.mutex);
+    queues.released.erase(queue);
+}
+
+// static
+void ReleaseQueue::Push(int64_t queue, uint8_t *buffer)
+{
+    Queues &queues = Instance();
+    const std::lock_guard<std::mutex> lock(queues.mutex);
+    auto it = queues.released.find(queue);
+    if (it != queues.released.end())
+        it->second.push_back(buffer);
+}
+
+// static
+int32_t ReleaseQueue::Poll(int64_t queue, uint8_t **buffers, int32_t capacity)
+{
+    Queues &queues = Instance();
+    const std::lock_guard<std::mutex> lock(queues.mutex);
+    auto it = queues.released.find(queue);
+    if (it == queues.released.end())
+        return -1;
+    std::vector<uint8_t *> &released = it->second;
+    size_t count = std::min(released.size(), static_cast<size_t>(std::max(capacity, 0)));
+    std::copy(released.begin(), released.begin() + count, buffers);
+    released.erase(released.begin(), released.begin() + count);
+    return static_cast<int32_t>(count);
+}
+
+// static
+void ReleaseQueue::OnRelease(void *context, uint8_t *buffer)
+{
+    Push(static_cast<int64_t>(reinterpret_cast<intptr_t>(context)), buffer);
+}
+
+// static
+void *ReleaseQueue::Context(int64_t queue)
+{
+    return reinterpret_cast<void *>(static_cast<intptr_t>(queue));
+}
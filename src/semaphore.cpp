@@ -0,0 +1,53 @@
+#include "include/texture_interface/semaphore.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#endif
+
+#ifdef _WIN32
+
+Semaphore::Semaphore() : handle_(CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr)) {}
+
+Semaphore::~Semaphore()
+{
+    CloseHandle(handle_);
+}
+
+void Semaphore::Post()
+{
+    ReleaseSemaphore(handle_, 1, nullptr);
+}
+
+void Semaphore::Wait()
+{
+    WaitForSingleObject(handle_, INFINITE);
+}
+
+#else
+
+Semaphore::Semaphore()
+{
+    sem_init(&semaphore_, 0, 0);
+}
+
+Semaphore::~Semaphore()
+{
+    sem_destroy(&semaphore_);
+}
+
+void Semaphore::Post()
+{
+    sem_post(&semaphore_);
+}
+
+void Semaphore::Wait()
+{
+    // signals interrupt the wait
+    while (sem_wait(&semaphore_) != 0 && errno == EINTR)
+    {
+    }
+}
+
+#endif
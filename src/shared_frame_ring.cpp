@@ -0,0 +1,146 @@
+#include "include/texture_interface/shared_frame_ring.h"
+
+#include <new>
+
+namespace
+{
+    constexpr size_t kSlotAlignment = 4096;
+
+    size_t AlignUp(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    size_t SlotSize(int32_t width, int32_t height)
+    {
+        return AlignUp(static_cast<size_t>(width) * height * 4, kSlotAlignment);
+    }
+
+    size_t DataOffset()
+    {
+        return AlignUp(sizeof(SharedFrameRingHeader), kSlotAlignment);
+    }
+}
+
+// static
+size_t SharedFrameRing::RequiredSize(uint32_t slot_count, int32_t width, int32_t height)
+{
+    return DataOffset() + slot_count * SlotSize(width, height);
+}
+
+// static
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Initialize(void *memory, size_t size, uint32_t slot_count,
+                                                             int32_t width, int32_t height)
+{
+    if (memory == nullptr || slot_count < 3 || slot_count > SharedFrameRingHeader::kMaxSlots ||
+        width <= 0 || height <= 0 || size < RequiredSize(slot_count, width, height))
+        return nullptr;
+
+    SharedFrameRingHeader *header = new (memory) SharedFrameRingHeader{};
+    header->magic = SharedFrameRingHeader::kMagic;
+    header->version = SharedFrameRingHeader::kVersion;
+    header->slot_count = slot_count;
+    header->slot_size = static_cast<uint32_t>(SlotSize(width, height));
+    header->width = width;
+    header->height = height;
+    header->data_offset = static_cast<uint32_t>(DataOffset());
+    header->latest.store(0);
+    header->reading.store(SharedFrameRingHeader::kNoSlot);
+    return std::unique_ptr<SharedFrameRing>(new SharedFrameRing(header));
+}
+
+// static
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Attach(void *memory, size_t size)
+{
+    if (memory == nullptr || size < sizeof(SharedFrameRingHeader))
+        return nullptr;
+
+    SharedFrameRingHeader *header = static_cast<SharedFrameRingHeader *>(memory);
+    if (header->magic != SharedFrameRingHeader::kMagic || header->version != SharedFrameRingHeader::kVersion)
+        return nullptr;
+    if (header->slot_count < 3 || header->slot_count > SharedFrameRingHeader::kMaxSlots)
+        return nullptr;
+    if (header->width <= 0 || header->height <= 0 ||
+        header->slot_size < static_cast<size_t>(header->width) * header->height * 4)
+        return nullptr;
+    if (size < header->data_offset + static_cast<size_t>(header->slot_count) * header->slot_size)
+        return nullptr;
+    return std::unique_ptr<SharedFrameRing>(new SharedFrameRing(header));
+}
+
+uint8_t *SharedFrameRing::BeginWrite()
+{
+    uint64_t latest = header_->latest.load();
+    uint32_t latest_slot = latest != 0 ? static_cast<uint32_t>(latest & 0xFF) : SharedFrameRingHeader::kNoSlot;
+    uint32_t reading = header_->reading.load();
+
+    // with three or more slots one is always neither latest nor pinned
+    uint32_t start = write_slot_ == SharedFrameRingHeader::kNoSlot ? 0 : write_slot_ + 1;
+    for (uint32_t i = 0; i < slot_count_; i++)
+    {
+        uint32_t slot = (start + i) % slot_count_;
+        if (slot != latest_slot && slot != reading)
+        {
+            write_slot_ = slot;
+            return slot_data(slot);
+        }
+    }
+    return nullptr;
+}
+
+void SharedFrameRing::EndWrite(int32_t width, int32_t height)
+{
+    if (write_slot_ == SharedFrameRingHeader::kNoSlot)
+        return;
+
+    uint64_t sequence = (header_->latest.load() >> 8) + 1;
+    SharedFrameSlotHeader &slot = header_->slots[write_slot_];
+    slot.width = width;
+    slot.height = height;
+    slot.sequence = sequence;
+    header_->latest.store((sequence << 8) | write_slot_);
+}
+
+const uint8_t *SharedFrameRing::AcquireLatest(int32_t *width, int32_t *height)
+{
+    uint64_t latest = header_->latest.load();
+    for (;;)
+    {
+        if (latest == 0)
+        {
+            Unpin();
+            return nullptr;
+        }
+        uint32_t slot = static_cast<uint32_t>(latest & 0xFF);
+        header_->reading.store(slot);
+        // if |latest| did not move the producer has seen the pin before it
+        // could pick this slot again
+        uint64_t check = header_->latest.load();
+        if (check == latest)
+        {
+            // the producer is not trusted to stay inside its slot
+            int32_t slot_width = slot < slot_count_ ? header_->slots[slot].width : 0;
+            int32_t slot_height = slot < slot_count_ ? header_->slots[slot].height : 0;
+            if (slot_width <= 0 || slot_height <= 0 ||
+                static_cast<size_t>(slot_width) * slot_height * 4 > slot_size_)
+            {
+                Unpin();
+                return nullptr;
+            }
+            *width = slot_width;
+            *height = slot_height;
+            return slot_data(slot);
+        }
+        latest = check;
+    }
+}
+
+void SharedFrameRing::Unpin()
+{
+    header_->reading.store(SharedFrameRingHeader::kNoSlot);
+}
+
+uint8_t *SharedFrameRing::slot_data(uint32_t slot) const
+{
+    return reinterpret_cast<uint8_t *>(header_) + data_offset_ + static_cast<size_t>(slot) * slot_size_;
+}
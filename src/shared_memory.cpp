@@ -0,0 +1,137 @@
+#include "include/texture_interface/shared_memory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+    std::wstring Widen(const std::string &name)
+    {
+        int length = MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, nullptr, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, wide.data(), length);
+        wide.resize(length - 1);
+        return wide;
+    }
+#else
+    // POSIX shm names have to start with a slash
+    std::string ShmName(const std::string &name)
+    {
+        return name.empty() || name[0] != '/' ? "/" + name : name;
+    }
+#endif
+}
+
+#ifdef _WIN32
+
+// static
+std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string &name, size_t size)
+{
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size), Widen(name).c_str());
+    if (mapping == nullptr)
+        return nullptr;
+    void *data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->mapping_ = mapping;
+    memory->data_ = data;
+    memory->size_ = size;
+    return memory;
+}
+
+// static
+std::unique_ptr<SharedMemory> SharedMemory::Open(const std::string &name)
+{
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, Widen(name).c_str());
+    if (mapping == nullptr)
+        return nullptr;
+    void *data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info{};
+    if (data == nullptr || VirtualQuery(data, &info, sizeof(info)) == 0)
+    {
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        return nullptr;
+    }
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->mapping_ = mapping;
+    memory->data_ = data;
+    memory->size_ = info.RegionSize;
+    return memory;
+}
+
+SharedMemory::~SharedMemory()
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+}
+
+#else
+
+// static
+std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string &name, size_t size)
+{
+    int fd = shm_open(ShmName(name).c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->data_ = data;
+    memory->size_ = size;
+    return memory;
+}
+
+// static
+std::unique_ptr<SharedMemory> SharedMemory::Open(const std::string &name)
+{
+    int fd = shm_open(ShmName(name).c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return nullptr;
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->data_ = data;
+    memory->size_ = size;
+    return memory;
+}
+
+SharedMemory::~SharedMemory()
+{
+    if (data_ != nullptr)
+        munmap(data_, size_);
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include "texture_interface/capture_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "test_check.h"
+
+namespace
+{
+    constexpr int32_t kWidth = 8;
+    constexpr int32_t kHeight = 4;
+
+    std::string CapturePath(const char *name)
+    {
+#ifdef _WIN32
+        int pid = _getpid();
+#else
+        int pid = getpid();
+#endif
+        return (std::filesystem::temp_directory_path() / (std::string(name) + "_" + std::to_string(pid) + ".ticap"))
+            .string();
+    }
+
+    std::vector<uint8_t> Pattern(size_t size, uint8_t seed)
+    {
+        std::vector<uint8_t> pixels(size);
+        for (size_t i = 0; i < pixels.size(); i++)
+            pixels[i] = static_cast<uint8_t>(seed + i * 7);
+        return pixels;
+    }
+
+    bool Shows(const CaptureFrame &frame, const std::vector<uint8_t> &pixels, int32_t width, int32_t height,
+               PixelFormat format)
+    {
+        return frame.width == width && frame.height == height && frame.format == format &&
+               frame.size == pixels.size() && std::memcmp(frame.pixels, pixels.data(), pixels.size()) == 0;
+    }
+
+    // Key frames, delta frames, padded rows and a format change all replay
+    // to what was recorded.
+    void ReplaysWhatWasRecorded()
+    {
+        std::string path = CapturePath("capture_round_trip");
+        std::vector<uint8_t> first = Pattern(kWidth * kHeight * 4, 1);
+        std::vector<uint8_t> second = first;
+        // one changed row between unchanged ones
+        std::memset(&second[kWidth * 4], 0xAB, kWidth * 4);
+        // the second frame again, rows padded to twice their length
+        std::vector<uint8_t> padded(kWidth * kHeight * 8, 0xEE);
+        for (int32_t row = 0; row < kHeight; row++)
+            std::memcpy(&padded[row * kWidth * 8], &second[row * kWidth * 4], kWidth * 4);
+        std::vector<uint8_t> nv12 = Pattern(SourceBytes(PixelFormat::kNV12, kWidth, kHeight), 5);
+        {
+            std::unique_ptr<CaptureRecorder> recorder = CaptureRecorder::Create(path);
+            CHECK(recorder != nullptr);
+            if (recorder == nullptr)
+                return;
+            CHECK(recorder->Record(first.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, 1000));
+            CHECK(recorder->Record(second.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, 2000));
+            CHECK(recorder->Record(padded.data(), kWidth, kHeight, kWidth * 8, PixelFormat::kRGBA, 3000));
+            CHECK(recorder->Record(nv12.data(), kWidth, kHeight, 0, PixelFormat::kNV12, 4000));
+            CHECK(recorder->frame_count() == 4);
+        }
+
+        std::unique_ptr<CaptureReader> reader = CaptureReader::Open(path);
+        CHECK(reader != nullptr);
+        if (reader != nullptr)
+        {
+            CHECK(reader->frame_count() == 4);
+            for (int pass = 0; pass < 2; pass++)
+            {
+                CaptureFrame frame;
+                CHECK(reader->Next(&frame) && Shows(frame, first, kWidth, kHeight, PixelFormat::kRGBA));
+                CHECK(frame.timestamp == 0);
+                CHECK(reader->Next(&frame) && Shows(frame, second, kWidth, kHeight, PixelFormat::kRGBA));
+                CHECK(frame.timestamp == 1000);
+                CHECK(reader->Next(&frame) && Shows(frame, second, kWidth, kHeight, PixelFormat::kRGBA));
+                CHECK(reader->Next(&frame) && Shows(frame, nv12, kWidth, kHeight, PixelFormat::kNV12));
+                CHECK(frame.timestamp == 3000);
+                CHECK(!reader->Next(&frame));
+                reader->Rewind();
+            }
+        }
+        reader.reset();
+        std::remove(path.c_str());
+    }
+
+    // A file cut short, as by a crash mid-write, replays the frames that
+    // are whole and stops at the first that is not.
+    void StopsAtTruncatedRecords()
+    {
+        std::string path = CapturePath("capture_truncated");
+        std::vector<uint8_t> pixels = Pattern(kWidth * kHeight * 4, 3);
+        {
+            std::unique_ptr<CaptureRecorder> recorder = CaptureRecorder::Create(path);
+            CHECK(recorder != nullptr);
+            if (recorder == nullptr)
+                return;
+            for (int i = 0; i < 3; i++)
+            {
+                pixels[0] = static_cast<uint8_t>(i);
+                CHECK(recorder->Record(pixels.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, i));
+            }
+        }
+
+        // into the body of the last record, the header still claims three
+        // frames
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        std::unique_ptr<CaptureReader> reader = CaptureReader::Open(path);
+        CHECK(reader != nullptr);
+        if (reader != nullptr)
+        {
+            CHECK(reader->frame_count() == 3);
+            CaptureFrame frame;
+            CHECK(reader->Next(&frame) && frame.pixels[0] == 0);
+            CHECK(reader->Next(&frame) && frame.pixels[0] == 1);
+            CHECK(!reader->Next(&frame));
+        }
+        reader.reset();
+
+        // down to part of the file header
+        std::filesystem::resize_file(path, sizeof(CaptureFileHeader) - 1);
+        CHECK(CaptureReader::Open(path) == nullptr);
+        std::remove(path.c_str());
+    }
+
+    void RejectsOtherFiles()
+    {
+        std::string path = CapturePath("capture_foreign");
+        {
+            std::FILE *file = std::fopen(path.c_str(), "wb");
+            CHECK(file != nullptr);
+            if (file == nullptr)
+                return;
+            std::vector<uint8_t> bytes = Pattern(256, 9);
+            std::fwrite(bytes.data(), 1, bytes.size(), file);
+            std::fclose(file);
+        }
+        CHECK(CaptureReader::Open(path) == nullptr);
+        CHECK(CaptureReader::Open(path + ".missing") == nullptr);
+        std::remove(path.c_str());
+    }
+}
+
+int main()
+{
+    ReplaysWhatWasRecorded();
+    StopsAtTruncatedRecords();
+    RejectsOtherFiles();
+    return TestResult();
+}
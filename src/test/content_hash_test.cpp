@@ -0,0 +1,182 @@
+#include "texture_interface/content_hash.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/frame.h"
+#include "texture_interface/frame_delta.h"
+#include "test_check.h"
+
+namespace
+{
+    // 16 hash blocks of RGBA
+    constexpr int32_t kWidth = 64;
+    constexpr int32_t kHeight = 64;
+    constexpr size_t kSize = static_cast<size_t>(kWidth) * kHeight * 4;
+
+    // every buffer handed back, in order
+    struct Releases
+    {
+        std::vector<uint8_t *> buffers;
+
+        static void OnRelease(void *context, uint8_t *buffer)
+        {
+            static_cast<Releases *>(context)->buffers.push_back(buffer);
+        }
+
+        BufferRelease release() { return {&Releases::OnRelease, this}; }
+    };
+
+    std::vector<uint8_t> Content(size_t size)
+    {
+        std::vector<uint8_t> content(size);
+        for (size_t i = 0; i < size; i++)
+            content[i] = static_cast<uint8_t>(i * 31 + (i >> 8));
+        return content;
+    }
+
+    // Every SIMD tier the CPU has hashes like the scalar kernels, at sizes
+    // that end in partial stripes and blocks.
+    void SimdTiersMatchScalar()
+    {
+        std::vector<uint8_t> content = Content(kHashBlock * 5 + 100);
+        for (SimdTier tier : {SimdTier::kSse2, SimdTier::kAvx2})
+        {
+            if (DetectSimdTier() < tier)
+            {
+                std::printf("skipping SIMD tier %d, not supported by this CPU\n", static_cast<int>(tier));
+                continue;
+            }
+            for (size_t size : {size_t{0}, size_t{1}, size_t{63}, size_t{64}, size_t{1000}, kHashBlock,
+                                kHashBlock + 1, content.size()})
+            {
+                for (size_t step : {size_t{1}, kDuplicateSampleStep})
+                {
+                    bool same = HashContent(content.data(), size, step, HashKernelsFor(tier)) ==
+                                HashContent(content.data(), size, step, HashKernelsFor(SimdTier::kScalar));
+                    if (!same)
+                        std::fprintf(stderr, "tier %d, size %zu, step %zu\n", static_cast<int>(tier), size, step);
+                    CHECK(same);
+                }
+            }
+        }
+    }
+
+    // The full hash sees a change anywhere, the sampled one only in the
+    // blocks it reads: every kDuplicateSampleStep-th and the last.
+    void SampledHashesReadSomeBlocks()
+    {
+        std::vector<uint8_t> content = Content(kSize);
+        uint64_t full = HashContent(content.data(), content.size());
+        uint64_t sampled = HashContent(content.data(), content.size(), kDuplicateSampleStep);
+        CHECK(full != sampled);
+        CHECK(HashContent(content.data(), content.size() - 1) != full);
+
+        for (size_t block : {size_t{0}, size_t{1}, kDuplicateSampleStep - 1, kDuplicateSampleStep,
+                             kSize / kHashBlock - 1})
+        {
+            std::vector<uint8_t> changed = content;
+            changed[block * kHashBlock + 17] ^= 1;
+            bool read = block % kDuplicateSampleStep == 0 || block == kSize / kHashBlock - 1;
+            CHECK(HashContent(changed.data(), changed.size()) != full);
+            CHECK((HashContent(changed.data(), changed.size(), kDuplicateSampleStep) != sampled) == read);
+        }
+    }
+
+    // Resent frames are handed back without being published, anything that
+    // changes what would be shown is not a resend.
+    void SkipsResentFrames()
+    {
+        FakeTextureBridge bridge;
+        Releases releases;
+        Frame frame(&bridge);
+        frame.set_duplicate_check(DuplicateCheck::kFull);
+        std::vector<std::vector<uint8_t>> buffers(4, Content(kSize));
+        auto update = [&](size_t index, int32_t width, int32_t height)
+        {
+            return frame.Update(buffers[index].data(), width, height, 0, PixelFormat::kRGBA, true,
+                                releases.release());
+        };
+
+        CHECK(update(0, kWidth, kHeight));
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[0].data());
+        CHECK(update(1, kWidth, kHeight));
+        CHECK(frame.skipped_frames() == 1);
+        CHECK(releases.buffers == std::vector<uint8_t *>{buffers[1].data()});
+        CHECK(bridge.frames_available(frame.texture_id()) == 1);
+
+        // the same bytes as another shape
+        CHECK(update(2, kHeight * 2, kWidth / 2));
+        CHECK(frame.skipped_frames() == 1);
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[2].data());
+
+        buffers[3][kSize - 1] ^= 1;
+        CHECK(update(3, kHeight * 2, kWidth / 2));
+        CHECK(frame.skipped_frames() == 1);
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[3].data());
+
+        // not checked once turned off
+        frame.set_duplicate_check(DuplicateCheck::kOff);
+        buffers[0] = buffers[3];
+        CHECK(update(0, kHeight * 2, kWidth / 2));
+        CHECK(frame.skipped_frames() == 1);
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[0].data());
+        frame.Retire({});
+    }
+
+    // Sampling trades missed changes in the blocks it skips for speed.
+    void SampledChecksMissUnsampledChanges()
+    {
+        for (DuplicateCheck check : {DuplicateCheck::kFull, DuplicateCheck::kSampled})
+        {
+            FakeTextureBridge bridge;
+            Releases releases;
+            Frame frame(&bridge);
+            frame.set_duplicate_check(check);
+            std::vector<uint8_t> first = Content(kSize);
+            std::vector<uint8_t> second = first;
+            second[kHashBlock + 5] ^= 1;
+            CHECK(frame.Update(first.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, true, releases.release()));
+            CHECK(frame.Update(second.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, true, releases.release()));
+            CHECK(frame.skipped_frames() == (check == DuplicateCheck::kSampled ? 1u : 0u));
+            frame.Retire({});
+        }
+    }
+
+    // With duplicates checked a delta without changes is skipped before
+    // anything is copied, without it is published like any other.
+    void SkipsEmptyDeltas()
+    {
+        for (DuplicateCheck check : {DuplicateCheck::kOff, DuplicateCheck::kFull})
+        {
+            FakeTextureBridge bridge;
+            Releases releases;
+            Frame frame(&bridge);
+            frame.set_duplicate_check(check);
+            std::vector<uint8_t> content = Content(kSize);
+            CHECK(frame.Update(content.data(), kWidth, kHeight, 0, PixelFormat::kRGBA, true, releases.release()));
+            CHECK(bridge.Fetch(frame.texture_id()) != nullptr);
+
+            std::vector<uint8_t> delta(MaxFrameDeltaSize(kWidth, kHeight));
+            delta.resize(EncodeFrameDelta(content.data(), content.data(), kWidth, kHeight, 0, delta.data()));
+            FrameDeltaInfo info;
+            CHECK(ReadFrameDeltaInfo(delta.data(), delta.size(), &info));
+            CHECK(frame.UpdateDelta(delta.data(), delta.size(), info));
+            bool skipped = check != DuplicateCheck::kOff;
+            CHECK(bridge.frames_available(frame.texture_id()) == (skipped ? 1u : 2u));
+            CHECK(frame.skipped_frames() == (skipped ? 1u : 0u));
+            frame.Retire({});
+        }
+    }
+}
+
+int main()
+{
+    SimdTiersMatchScalar();
+    SampledHashesReadSomeBlocks();
+    SkipsResentFrames();
+    SampledChecksMissUnsampledChanges();
+    SkipsEmptyDeltas();
+    return TestResult();
+}
@@ -0,0 +1,141 @@
+#ifndef FAKE_TEXTURE_BRIDGE_H
+#define FAKE_TEXTURE_BRIDGE_H
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "texture_interface/texture_bridge.h"
+
+// TextureBridge standing in for the engine in tests and benchmarks. Fetch
+// plays the raster thread: like the pixel buffer embedders it releases what
+// the previous fetch of the texture returned before fetching again, and once
+// more when the texture is unregistered, so frames have to be retired before
+// the bridge goes. One thread fetches each texture.
+class FakeTextureBridge : public TextureBridge
+{
+public:
+    // Unregistered textures the engine is done with once FinishUnregisters
+    // runs instead of right away, like a raster thread that still holds
+    // them. Pending ones are dropped with the bridge.
+    explicit FakeTextureBridge(bool defer_unregister = false) : defer_unregister_(defer_unregister) {}
+
+    int64_t RegisterTexture(FetchCallback fetch) override
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        int64_t texture_id = next_texture_id_++;
+        textures_[texture_id] = std::make_unique<Texture>();
+        textures_[texture_id]->fetch = std::move(fetch);
+        return texture_id;
+    }
+
+    void UnregisterTexture(int64_t texture_id, std::function<void()> unregistered) override
+    {
+        std::unique_ptr<Texture> texture;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            auto it = textures_.find(texture_id);
+            if (it != textures_.end())
+            {
+                texture = std::move(it->second);
+                textures_.erase(it);
+            }
+        }
+        if (defer_unregister_)
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            unregistering_.emplace_back(std::move(texture), std::move(unregistered));
+            return;
+        }
+        if (texture != nullptr)
+            ReleaseFetched(*texture);
+        if (unregistered)
+            unregistered();
+    }
+
+    // Releases what the textures unregistered so far fetched last and
+    // reports them as unregistered.
+    void FinishUnregisters()
+    {
+        std::vector<std::pair<std::unique_ptr<Texture>, std::function<void()>>> unregistering;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            unregistering.swap(unregistering_);
+        }
+        for (auto &[texture, unregistered] : unregistering)
+        {
+            if (texture != nullptr)
+                ReleaseFetched(*texture);
+            if (unregistered)
+                unregistered();
+        }
+    }
+
+    void MarkTextureFrameAvailable(int64_t texture_id) override
+    {
+        if (Texture *texture = Find(texture_id))
+            texture->frames_available.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void FreeBuffer(uint8_t *buffer) override { std::free(buffer); }
+
+    // Returns what the texture shows, null if it shows nothing or is not
+    // registered. The pixels stay valid until the next fetch.
+    const PixelBuffer *Fetch(int64_t texture_id, size_t width = 0, size_t height = 0)
+    {
+        Texture *texture = Find(texture_id);
+        if (texture == nullptr)
+            return nullptr;
+        ReleaseFetched(*texture);
+        texture->fetched = texture->fetch(width, height);
+        return texture->fetched;
+    }
+
+    // MarkTextureFrameAvailable calls for the texture so far.
+    uint64_t frames_available(int64_t texture_id)
+    {
+        Texture *texture = Find(texture_id);
+        return texture != nullptr ? texture->frames_available.load() : 0;
+    }
+
+    size_t texture_count()
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return textures_.size();
+    }
+
+private:
+    struct Texture
+    {
+        FetchCallback fetch;
+        const PixelBuffer *fetched = nullptr;
+        std::atomic<uint64_t> frames_available{0};
+    };
+
+    Texture *Find(int64_t texture_id)
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(texture_id);
+        return it != textures_.end() ? it->second.get() : nullptr;
+    }
+
+    static void ReleaseFetched(Texture &texture)
+    {
+        const PixelBuffer *fetched = texture.fetched;
+        texture.fetched = nullptr;
+        if (fetched != nullptr && fetched->release_callback != nullptr)
+            fetched->release_callback(fetched->release_context);
+    }
+
+    bool defer_unregister_;
+    std::mutex mutex_;
+    std::map<int64_t, std::unique_ptr<Texture>> textures_;
+    std::vector<std::pair<std::unique_ptr<Texture>, std::function<void()>>> unregistering_;
+    int64_t next_texture_id_ = 1;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "texture_interface/frame_delta.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "test_check.h"
+
+namespace
+{
+    struct Frames
+    {
+        int32_t width;
+        int32_t height;
+        int32_t stride;
+        std::vector<uint8_t> previous;
+        std::vector<uint8_t> current;
+    };
+
+    // Two frames whose rows are padded by a pixel, |current| differing from
+    // |previous| in scattered pixels and in runs of every length.
+    Frames MakeFrames(int32_t width, int32_t height, std::mt19937 &random)
+    {
+        Frames frames{width, height, (width + 1) * 4, {}, {}};
+        std::uniform_int_distribution<int> byte(0, 255);
+        frames.previous.resize(static_cast<size_t>(frames.stride) * height);
+        for (uint8_t &value : frames.previous)
+            value = static_cast<uint8_t>(byte(random));
+        frames.current = frames.previous;
+        std::uniform_int_distribution<int> pixel(0, width * height - 1);
+        std::uniform_int_distribution<int> length(1, width * 2);
+        for (int change = 0; change < 3; change++)
+        {
+            int start = pixel(random);
+            int end = std::min(start + length(random), width * height);
+            for (int i = start; i < end; i++)
+                frames.current[(i / width) * frames.stride + (i % width) * 4 + byte(random) % 4] ^= 0x5A;
+        }
+        return frames;
+    }
+
+    std::vector<uint8_t> Packed(const Frames &frames, const std::vector<uint8_t> &pixels)
+    {
+        size_t row = static_cast<size_t>(frames.width) * 4;
+        std::vector<uint8_t> packed(row * frames.height);
+        for (int32_t y = 0; y < frames.height; y++)
+            std::memcpy(&packed[y * row], &pixels[static_cast<size_t>(y) * frames.stride], row);
+        return packed;
+    }
+
+    std::vector<uint8_t> Encode(const Frames &frames, const DeltaKernels &kernels)
+    {
+        std::vector<uint8_t> delta(MaxFrameDeltaSize(frames.width, frames.height));
+        size_t size = EncodeFrameDelta(frames.previous.data(), frames.current.data(), frames.width, frames.height,
+                                       frames.stride, delta.data(), kernels);
+        CHECK(size >= sizeof(FrameDeltaHeader) && size <= delta.size());
+        delta.resize(size);
+        return delta;
+    }
+
+    bool InBands(const FrameDeltaInfo &info, int32_t x, int32_t y)
+    {
+        for (size_t i = 0; i < info.band_count; i++)
+        {
+            const DeltaBand &band = info.bands[i];
+            if (x >= band.x && x < band.x + band.width && y >= band.y && y < band.y + band.height)
+                return true;
+        }
+        return false;
+    }
+
+    // Deltas of every tier the CPU has are the scalar ones, describe every
+    // changed pixel and turn the previous frame into the current one.
+    void RoundTripsOnEveryTier()
+    {
+        std::mt19937 random(11);
+        for (SimdTier tier : {SimdTier::kScalar, SimdTier::kSse2, SimdTier::kAvx2})
+        {
+            if (DetectSimdTier() < tier)
+            {
+                std::printf("skipping SIMD tier %d, not supported by this CPU\n", static_cast<int>(tier));
+                continue;
+            }
+            const DeltaKernels &kernels = DeltaKernelsFor(tier);
+            for (int32_t width = 1; width <= 70; width++)
+            {
+                Frames frames = MakeFrames(width, 5, random);
+                std::vector<uint8_t> delta = Encode(frames, kernels);
+                bool same = delta == Encode(frames, DeltaKernelsFor(SimdTier::kScalar));
+
+                FrameDeltaInfo info;
+                bool read = ReadFrameDeltaInfo(delta.data(), delta.size(), &info);
+                bool covered = read && info.width == width && info.height == frames.height;
+                uint64_t changed = 0;
+                for (int32_t y = 0; y < frames.height; y++)
+                {
+                    for (int32_t x = 0; x < width; x++)
+                    {
+                        size_t offset = static_cast<size_t>(y) * frames.stride + x * 4;
+                        if (std::memcmp(&frames.previous[offset], &frames.current[offset], 4) == 0)
+                            continue;
+                        changed++;
+                        covered = covered && InBands(info, x, y);
+                    }
+                }
+                // short unchanged runs are sent along with the changed ones
+                covered = covered && info.changed_pixels >= changed;
+
+                std::vector<uint8_t> applied = Packed(frames, frames.previous);
+                bool applies = ApplyFrameDelta(delta.data(), delta.size(), applied.data(), kernels) &&
+                               applied == Packed(frames, frames.current);
+                if (!same || !covered || !applies)
+                    std::fprintf(stderr, "tier %d, width %d\n", static_cast<int>(tier), width);
+                CHECK(same);
+                CHECK(covered);
+                CHECK(applies);
+            }
+        }
+    }
+
+    void UnchangedFramesAreOnlyTheHeader()
+    {
+        std::mt19937 random(3);
+        Frames frames = MakeFrames(32, 8, random);
+        frames.current = frames.previous;
+        std::vector<uint8_t> delta = Encode(frames, ActiveDeltaKernels());
+        CHECK(delta.size() == sizeof(FrameDeltaHeader));
+        FrameDeltaInfo info;
+        CHECK(ReadFrameDeltaInfo(delta.data(), delta.size(), &info));
+        CHECK(info.changed_pixels == 0 && info.band_count == 0);
+    }
+
+    // |delta| with the uint32 at |offset| replaced by |value|
+    std::vector<uint8_t> WithWord(std::vector<uint8_t> delta, size_t offset, uint32_t value)
+    {
+        std::memcpy(&delta[offset], &value, sizeof(value));
+        return delta;
+    }
+
+    bool Rejected(const std::vector<uint8_t> &delta, bool check_apply)
+    {
+        FrameDeltaInfo info;
+        if (ReadFrameDeltaInfo(delta.data(), delta.size(), &info))
+            return false;
+        if (!check_apply)
+            return true;
+        // a frame as large as the header claims, ops past it must not be
+        // written
+        std::vector<uint8_t> dst(16 * 4 * 4);
+        return !ApplyFrameDelta(delta.data(), delta.size(), dst.data());
+    }
+
+    // Deltas come from the caller's memory, malformed ones are refused
+    // without reading or writing out of bounds.
+    void RejectsCorruptDeltas()
+    {
+        std::mt19937 random(5);
+        Frames frames = MakeFrames(16, 4, random);
+        frames.current = frames.previous;
+        // a run of 3 changed pixels at the start
+        for (int i = 0; i < 12; i++)
+            frames.current[i] ^= 0xFF;
+        std::vector<uint8_t> delta = Encode(frames, ActiveDeltaKernels());
+        size_t op = sizeof(FrameDeltaHeader);
+        uint32_t first;
+        std::memcpy(&first, &delta[op], sizeof(first));
+        CHECK(first == 3);
+        CHECK(!Rejected(delta, true));
+
+        CHECK(Rejected({}, true));
+        CHECK(Rejected(std::vector<uint8_t>(delta.begin(), delta.begin() + sizeof(FrameDeltaHeader) - 1), true));
+        CHECK(Rejected(WithWord(delta, 0, 0), false));
+        CHECK(Rejected(WithWord(delta, 4, kFrameDeltaVersion + 1), false));
+        CHECK(Rejected(WithWord(delta, 8, 0), true));
+        CHECK(Rejected(WithWord(delta, 12, static_cast<uint32_t>(-4)), true));
+        // an op cut short, an empty run, more pixels than the frame has and
+        // more changed pixels than follow
+        CHECK(Rejected(std::vector<uint8_t>(delta.begin(), delta.begin() + op + 2), true));
+        CHECK(Rejected(WithWord(delta, op, 0), true));
+        CHECK(Rejected(WithWord(delta, op, kFrameDeltaUnchanged | (16 * 4 + 1)), true));
+        CHECK(Rejected(WithWord(delta, op, 4), true));
+        CHECK(Rejected(std::vector<uint8_t>(delta.begin(), delta.end() - 1), true));
+    }
+}
+
+int main()
+{
+    RoundTripsOnEveryTier();
+    UnchangedFramesAreOnlyTheHeader();
+    RejectsCorruptDeltas();
+    return TestResult();
+}
@@ -0,0 +1,128 @@
+#include "texture_interface/frame_host.h"
+
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/frame_registry.h"
+#include "test_check.h"
+
+namespace
+{
+    // counts the buffers handed back to the caller
+    struct Releases
+    {
+        int count = 0;
+
+        static void OnRelease(void *context, uint8_t *)
+        {
+            static_cast<Releases *>(context)->count++;
+        }
+
+        BufferRelease release() { return {&Releases::OnRelease, this}; }
+    };
+
+    bool Reachable(int64_t handle)
+    {
+        return FrameRegistry::Instance().With(handle, [](Frame &) {});
+    }
+
+    void RegistersFramesOnce()
+    {
+        FakeTextureBridge bridge;
+        FrameHost host(&bridge);
+        Frame *frame = host.Register(1);
+        CHECK(frame != nullptr);
+        CHECK(host.Register(1) == frame);
+        CHECK(host.Find(1) == frame);
+        CHECK(host.Find(2) == nullptr);
+        CHECK(host.Handle(2) == 0);
+        CHECK(Reachable(host.Handle(1)));
+        CHECK(bridge.texture_count() == 1);
+    }
+
+    void UnregistersFrames()
+    {
+        FakeTextureBridge bridge;
+        FrameHost host(&bridge);
+        host.Register(1);
+        host.Register(2);
+        int64_t handle = host.Handle(1);
+        CHECK(!host.Unregister(3));
+        CHECK(host.Unregister(1));
+        CHECK(!host.Unregister(1));
+        CHECK(host.Find(1) == nullptr);
+        CHECK(host.Handle(1) == 0);
+        CHECK(!Reachable(handle));
+        // the fake bridge reports unregisters right away
+        CHECK(host.retired_count() == 0);
+        CHECK(bridge.texture_count() == 1);
+        CHECK(host.Find(2) != nullptr);
+    }
+
+    void UnregistersManyAtOnce()
+    {
+        FakeTextureBridge bridge;
+        FrameHost host(&bridge);
+        for (int id = 1; id <= 4; id++)
+            host.Register(id);
+        CHECK(host.UnregisterAll({1, 3, 5}) == 2);
+        CHECK(host.Find(1) == nullptr && host.Find(3) == nullptr);
+        CHECK(host.Find(2) != nullptr && host.Find(4) != nullptr);
+        CHECK(bridge.texture_count() == 2);
+        CHECK(host.UnregisterAll({}) == 0);
+    }
+
+    // Retired frames live on until the engine released what it fetched and
+    // no longer count towards the budget meanwhile.
+    void CollectsRetiredFramesOnceTheEngineIsDone()
+    {
+        FakeTextureBridge bridge(true);
+        Releases releases;
+        FrameHost host(&bridge);
+        Frame *frame = host.Register(1);
+        std::vector<uint8_t> buffer(8 * 8 * 4);
+        CHECK(frame->Update(buffer.data(), 8, 8, 0, PixelFormat::kRGBA, true, releases.release()));
+        CHECK(bridge.Fetch(frame->texture_id()) != nullptr);
+        CHECK(host.budget().ResidentBytes() > 0);
+
+        CHECK(host.Unregister(1));
+        CHECK(host.retired_count() == 1);
+        CHECK(host.budget().ResidentBytes() == 0);
+        host.Collect();
+        CHECK(host.retired_count() == 1);
+        CHECK(releases.count == 0);
+
+        bridge.FinishUnregisters();
+        host.Collect();
+        CHECK(host.retired_count() == 0);
+        CHECK(releases.count == 1);
+    }
+
+    // A host destroyed while the engine still holds a frame leaves it to the
+    // bridge's callback instead of waiting or leaking it.
+    void DestroysFramesLeftBehindByTheHost()
+    {
+        FakeTextureBridge bridge(true);
+        Releases releases;
+        std::vector<uint8_t> buffer(8 * 8 * 4);
+        {
+            FrameHost host(&bridge);
+            Frame *frame = host.Register(1);
+            CHECK(frame->Update(buffer.data(), 8, 8, 0, PixelFormat::kRGBA, true, releases.release()));
+            CHECK(bridge.Fetch(frame->texture_id()) != nullptr);
+        }
+        CHECK(releases.count == 0);
+        bridge.FinishUnregisters();
+        CHECK(releases.count == 1);
+    }
+}
+
+int main()
+{
+    RegistersFramesOnce();
+    UnregistersFrames();
+    UnregistersManyAtOnce();
+    CollectsRetiredFramesOnceTheEngineIsDone();
+    DestroysFramesLeftBehindByTheHost();
+    return TestResult();
+}
@@ -0,0 +1,160 @@
+#include "texture_interface/frame_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/frame.h"
+#include "test_check.h"
+
+namespace
+{
+    // the frame |handle| resolves to, null for none
+    Frame *Resolve(int64_t handle)
+    {
+        Frame *found = nullptr;
+        FrameRegistry::Instance().With(handle, [&](Frame &frame) { found = &frame; });
+        return found;
+    }
+
+    void ResolvesHandles()
+    {
+        FakeTextureBridge bridge;
+        Frame first(&bridge);
+        Frame second(&bridge);
+        FrameRegistry &registry = FrameRegistry::Instance();
+        size_t size = registry.size();
+        int64_t a = registry.Add(&first);
+        int64_t b = registry.Add(&second);
+        CHECK(a > 0 && b > 0 && a != b);
+        CHECK(registry.size() == size + 2);
+        CHECK(Resolve(a) == &first);
+        CHECK(Resolve(b) == &second);
+        CHECK(Resolve(0) == nullptr);
+        CHECK(Resolve(-1) == nullptr);
+        // an index past every slot
+        CHECK(Resolve(int64_t{1} << 32 | 0xFFFFFFF0) == nullptr);
+
+        registry.WithAll([&](auto resolve)
+                         {
+                             CHECK(resolve(a) == &first);
+                             CHECK(resolve(b) == &second);
+                             CHECK(resolve(a + 1234567) == nullptr);
+                         });
+        registry.Remove(a);
+        registry.Remove(b);
+        CHECK(registry.size() == size);
+        first.Retire({});
+        second.Retire({});
+    }
+
+    // A removed handle stays dead once its slot holds another frame, and
+    // removing it again leaves that frame alone.
+    void RejectsStaleHandles()
+    {
+        FakeTextureBridge bridge;
+        Frame first(&bridge);
+        Frame second(&bridge);
+        FrameRegistry &registry = FrameRegistry::Instance();
+        int64_t stale = registry.Add(&first);
+        registry.Remove(stale);
+        CHECK(Resolve(stale) == nullptr);
+
+        int64_t reused = registry.Add(&second);
+        // the same slot under the next generation
+        CHECK((reused & 0xFFFFFFFF) == (stale & 0xFFFFFFFF));
+        CHECK(reused != stale);
+        CHECK(Resolve(stale) == nullptr);
+        CHECK(Resolve(reused) == &second);
+        registry.Remove(stale);
+        CHECK(Resolve(reused) == &second);
+
+        // every generation of the slot is rejected once it moved on
+        std::vector<int64_t> handles = {stale, reused};
+        for (int i = 0; i < 8; i++)
+        {
+            registry.Remove(handles.back());
+            handles.push_back(registry.Add(&first));
+        }
+        for (size_t i = 0; i + 1 < handles.size(); i++)
+            CHECK(Resolve(handles[i]) == nullptr);
+        CHECK(Resolve(handles.back()) == &first);
+        registry.Remove(handles.back());
+        first.Retire({});
+        second.Retire({});
+    }
+
+    // Enough frames to need more than one chunk of slots, the first chunk
+    // keeps resolving while the table grows.
+    void GrowsPastAChunk()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        FrameRegistry &registry = FrameRegistry::Instance();
+        std::vector<int64_t> handles;
+        for (int i = 0; i < 3000; i++)
+            handles.push_back(registry.Add(&frame));
+        bool all = true;
+        for (int64_t handle : handles)
+            all = all && Resolve(handle) == &frame;
+        CHECK(all);
+        for (int64_t handle : handles)
+            registry.Remove(handle);
+        for (int64_t handle : handles)
+            all = all && Resolve(handle) == nullptr;
+        CHECK(all);
+        frame.Retire({});
+    }
+
+    void RemoveWaitsForCallersInside()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        FrameRegistry &registry = FrameRegistry::Instance();
+        int64_t handle = registry.Add(&frame);
+        std::atomic<bool> inside{false};
+        std::atomic<bool> leave{false};
+        std::atomic<bool> left{false};
+        std::thread caller([&]
+                           {
+                               registry.With(handle, [&](Frame &)
+                                             {
+                                                 inside = true;
+                                                 while (!leave)
+                                                     std::this_thread::yield();
+                                                 left = true;
+                                             });
+                           });
+        while (!inside)
+            std::this_thread::yield();
+        std::atomic<bool> removed_after_leaving{false};
+        std::thread remover([&]
+                            {
+                                registry.Remove(handle);
+                                removed_after_leaving = left.load();
+                            });
+        // new lookups fail as soon as the removal started, the caller inside
+        // holds it up
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (Resolve(handle) != nullptr && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+        CHECK(Resolve(handle) == nullptr);
+        CHECK(inside && !left);
+        leave = true;
+        caller.join();
+        remover.join();
+        CHECK(removed_after_leaving);
+        frame.Retire({});
+    }
+}
+
+int main()
+{
+    ResolvesHandles();
+    RejectsStaleHandles();
+    GrowsPastAChunk();
+    RemoveWaitsForCallersInside();
+    return TestResult();
+}
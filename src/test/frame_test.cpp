@@ -0,0 +1,192 @@
+#include "texture_interface/frame.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "test_check.h"
+
+namespace
+{
+    // every buffer handed back, in order
+    struct Releases
+    {
+        std::vector<uint8_t *> buffers;
+
+        static void OnRelease(void *context, uint8_t *buffer)
+        {
+            static_cast<Releases *>(context)->buffers.push_back(buffer);
+        }
+
+        BufferRelease release() { return {&Releases::OnRelease, this}; }
+    };
+
+    uint8_t *FilledBuffer(size_t size, uint8_t value)
+    {
+        uint8_t *buffer = static_cast<uint8_t *>(std::malloc(size));
+        std::memset(buffer, value, size);
+        return buffer;
+    }
+
+    // polls |condition| for up to a second, for work on the frame's threads
+    bool Eventually(const std::function<bool()> &condition)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    void ShowsNothingBeforeTheFirstUpdate()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        CHECK(bridge.Fetch(frame.texture_id()) == nullptr);
+        frame.Retire({});
+    }
+
+    void ShowsPackedRgbaAsItIs()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        uint8_t *buffer = FilledBuffer(16 * 8 * 4, 7);
+        CHECK(frame.Update(buffer, 16, 8));
+        CHECK(bridge.frames_available(frame.texture_id()) == 1);
+
+        const PixelBuffer *pixels = bridge.Fetch(frame.texture_id());
+        CHECK(pixels != nullptr && pixels->buffer == buffer && pixels->width == 16 && pixels->height == 8);
+        frame.Retire({});
+    }
+
+    void ConvertsOtherFormatsAndReleasesTheSourceRightAway()
+    {
+        FakeTextureBridge bridge;
+        Releases releases;
+        Frame frame(&bridge);
+        std::vector<uint8_t> bgra = {1, 2, 3, 4, 5, 6, 7, 8};
+        CHECK(frame.Update(bgra.data(), 2, 1, 0, PixelFormat::kBGRA, true, releases.release()));
+        CHECK(releases.buffers == std::vector<uint8_t *>{bgra.data()});
+
+        const PixelBuffer *pixels = bridge.Fetch(frame.texture_id());
+        CHECK(pixels != nullptr &&
+              std::vector<uint8_t>(pixels->buffer, pixels->buffer + 8) ==
+                  (std::vector<uint8_t>{3, 2, 1, 4, 7, 6, 5, 8}));
+        frame.Retire({});
+    }
+
+    void ReleasesReplacedFramesOnceTheRasterThreadMovedOn()
+    {
+        FakeTextureBridge bridge;
+        Releases releases;
+        Frame frame(&bridge);
+        std::vector<std::vector<uint8_t>> buffers(5, std::vector<uint8_t>(4 * 4 * 4));
+        auto update = [&](size_t index)
+        { return frame.Update(buffers[index].data(), 4, 4, 0, PixelFormat::kRGBA, true, releases.release()); };
+
+        CHECK(update(0));
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[0].data());
+        CHECK(update(1));
+        CHECK(update(2));
+        // 1 was replaced before it was fetched, its slot is only reused by
+        // a later update
+        CHECK(frame.dropped_frames() == 1);
+        CHECK(releases.buffers.empty());
+
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffers[2].data());
+        CHECK(update(3));
+        CHECK(releases.buffers == std::vector<uint8_t *>{buffers[1].data()});
+        // 0 was shown until the last fetch
+        CHECK(update(4));
+        CHECK(releases.buffers == (std::vector<uint8_t *>{buffers[1].data(), buffers[0].data()}));
+        frame.Retire({});
+    }
+
+    void SubmitsPooledBuffers()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        uint8_t *buffer = frame.AcquireBuffer(32, 32);
+        CHECK(buffer != nullptr);
+        std::memset(buffer, 9, 32 * 32 * 4);
+        CHECK(frame.SubmitBuffer(buffer, 32, 32));
+        CHECK(!frame.SubmitBuffer(buffer, 32, 32));
+        CHECK(bridge.Fetch(frame.texture_id())->buffer == buffer);
+
+        // after a warm-up, a producer kept at the raster thread's pace only
+        // ever gets recycled buffers
+        auto submit = [&](uint8_t value)
+        {
+            uint8_t *next = frame.AcquireBuffer(32, 32);
+            CHECK(next != nullptr);
+            if (next == nullptr)
+                return;
+            std::memset(next, value, 32 * 32 * 4);
+            CHECK(frame.SubmitBuffer(next, 32, 32));
+            CHECK(bridge.Fetch(frame.texture_id())->buffer == next);
+        };
+        for (uint8_t value = 0; value < 8; value++)
+            submit(value);
+        size_t allocations = frame.pool().allocation_count();
+        CHECK(allocations > 0);
+        for (int i = 0; i < 100; i++)
+            submit(static_cast<uint8_t>(i));
+        CHECK(frame.pool().allocation_count() == allocations);
+        frame.Retire({});
+    }
+
+    // A batch flushes its notifications before the pacer converted the
+    // frame, the pacer has to announce it on its own.
+    void NotifiesBatchedUpdatesInCoalesceMode()
+    {
+        FakeTextureBridge bridge;
+        Releases releases;
+        Frame frame(&bridge);
+        frame.set_pacing_mode(PacingMode::kCoalesce);
+        std::vector<std::vector<uint8_t>> buffers(2, std::vector<uint8_t>(16 * 16 * 4, 5));
+        CHECK(frame.Update(buffers[0].data(), 16, 16, 0, PixelFormat::kBGRA, false, releases.release()));
+        frame.FlushFrameAvailable();
+        CHECK(Eventually([&]
+                         { return bridge.frames_available(frame.texture_id()) == 1; }));
+
+        // held back until the first one is fetched, long after the flush
+        CHECK(frame.Update(buffers[1].data(), 16, 16, 0, PixelFormat::kBGRA, false, releases.release()));
+        frame.FlushFrameAvailable();
+        CHECK(bridge.Fetch(frame.texture_id()) != nullptr);
+        CHECK(Eventually([&]
+                         { return bridge.frames_available(frame.texture_id()) == 2; }));
+        frame.Retire({});
+    }
+
+    void RetireUnregistersTheTexture()
+    {
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        CHECK(frame.Update(FilledBuffer(8 * 8 * 4, 0), 8, 8));
+        bridge.Fetch(frame.texture_id());
+        bool retired = false;
+        frame.Retire([&]
+                     { retired = true; });
+        CHECK(retired);
+        CHECK(bridge.texture_count() == 0);
+    }
+}
+
+int main()
+{
+    ShowsNothingBeforeTheFirstUpdate();
+    ShowsPackedRgbaAsItIs();
+    ConvertsOtherFormatsAndReleasesTheSourceRightAway();
+    ReleasesReplacedFramesOnceTheRasterThreadMovedOn();
+    SubmitsPooledBuffers();
+    NotifiesBatchedUpdatesInCoalesceMode();
+    RetireUnregistersTheTexture();
+    return TestResult();
+}
@@ -0,0 +1,130 @@
+#include "texture_interface/pixel_convert.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_check.h"
+
+namespace
+{
+    const PixelFormat kFormats[] = {PixelFormat::kBGRA, PixelFormat::kRGB24, PixelFormat::kRGB565,
+                                    PixelFormat::kNV12, PixelFormat::kI420};
+
+    std::vector<uint8_t> Convert(PixelFormat format, const std::vector<uint8_t> &src, int32_t width,
+                                 int32_t height, const ConvertKernels &kernels)
+    {
+        std::vector<uint8_t> dst(static_cast<size_t>(width) * height * 4);
+        ConvertRows(format, src.data(), PackedStride(format, width), width, height, dst.data(), 0, height,
+                    kernels);
+        return dst;
+    }
+
+    std::vector<uint8_t> ConvertScalar(PixelFormat format, const std::vector<uint8_t> &src, int32_t width,
+                                       int32_t height)
+    {
+        return Convert(format, src, width, height, ConvertKernelsFor(SimdTier::kScalar));
+    }
+
+    // a |width| x |height| YUV image of one color
+    std::vector<uint8_t> SolidYuv(PixelFormat format, int32_t width, int32_t height, uint8_t y, uint8_t u,
+                                  uint8_t v)
+    {
+        int32_t stride = PackedStride(format, width);
+        std::vector<uint8_t> src(SourceBytes(format, stride, height), y);
+        size_t plane = static_cast<size_t>(stride) * height;
+        for (size_t i = plane; i < src.size(); i++)
+        {
+            if (format == PixelFormat::kNV12)
+                src[i] = (i - plane) % 2 == 0 ? u : v;
+            else
+                src[i] = i - plane < (src.size() - plane) / 2 ? u : v;
+        }
+        return src;
+    }
+
+    bool AllPixels(const std::vector<uint8_t> &rgba, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        for (size_t i = 0; i < rgba.size(); i += 4)
+        {
+            if (rgba[i] != r || rgba[i + 1] != g || rgba[i + 2] != b || rgba[i + 3] != a)
+                return false;
+        }
+        return true;
+    }
+
+    void ConvertsPackedFormats()
+    {
+        CHECK(ConvertScalar(PixelFormat::kBGRA, {10, 20, 30, 40, 50, 60, 70, 80}, 2, 1) ==
+              (std::vector<uint8_t>{30, 20, 10, 40, 70, 60, 50, 80}));
+        CHECK(ConvertScalar(PixelFormat::kRGB24, {10, 20, 30, 40, 50, 60}, 2, 1) ==
+              (std::vector<uint8_t>{10, 20, 30, 255, 40, 50, 60, 255}));
+        // little endian red, green, blue and white, channels are widened by
+        // repeating their high bits
+        CHECK(ConvertScalar(PixelFormat::kRGB565, {0x00, 0xF8, 0xE0, 0x07, 0x1F, 0x00, 0xFF, 0xFF}, 4, 1) ==
+              (std::vector<uint8_t>{255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 255}));
+        CHECK(ConvertScalar(PixelFormat::kRGB565, {0x10, 0x84}, 1, 1) ==
+              (std::vector<uint8_t>{132, 130, 132, 255}));
+    }
+
+    // BT.601 limited range: luma 16 is black and 235 white, without chroma.
+    void ConvertsLimitedRangeYuv()
+    {
+        for (PixelFormat format : {PixelFormat::kNV12, PixelFormat::kI420})
+        {
+            CHECK(AllPixels(ConvertScalar(format, SolidYuv(format, 6, 4, 16, 128, 128), 6, 4), 0, 0, 0, 255));
+            CHECK(AllPixels(ConvertScalar(format, SolidYuv(format, 6, 4, 235, 128, 128), 6, 4), 255, 255, 255,
+                            255));
+            // outside the nominal range clamps
+            CHECK(AllPixels(ConvertScalar(format, SolidYuv(format, 6, 4, 0, 128, 128), 6, 4), 0, 0, 0, 255));
+            CHECK(AllPixels(ConvertScalar(format, SolidYuv(format, 6, 4, 255, 128, 128), 6, 4), 255, 255, 255,
+                            255));
+            // strong red and blue
+            std::vector<uint8_t> red = ConvertScalar(format, SolidYuv(format, 2, 2, 81, 90, 240), 2, 2);
+            CHECK(red[0] >= 250 && red[1] <= 5 && red[2] <= 5);
+            std::vector<uint8_t> blue = ConvertScalar(format, SolidYuv(format, 2, 2, 41, 240, 110), 2, 2);
+            CHECK(blue[0] <= 5 && blue[1] <= 5 && blue[2] >= 250);
+        }
+    }
+
+    // Every SIMD tier the CPU has produces exactly the scalar output, at
+    // widths that leave every possible remainder for the scalar tail and
+    // odd heights for the chroma planes.
+    void SimdTiersMatchScalar()
+    {
+        std::mt19937 random(7);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (SimdTier tier : {SimdTier::kSse2, SimdTier::kAvx2})
+        {
+            if (DetectSimdTier() < tier)
+            {
+                std::printf("skipping SIMD tier %d, not supported by this CPU\n", static_cast<int>(tier));
+                continue;
+            }
+            for (PixelFormat format : kFormats)
+            {
+                for (int32_t width = 1; width <= 80; width++)
+                {
+                    int32_t height = 3;
+                    std::vector<uint8_t> src(SourceBytes(format, PackedStride(format, width), height));
+                    for (uint8_t &value : src)
+                        value = static_cast<uint8_t>(byte(random));
+                    bool same = Convert(format, src, width, height, ConvertKernelsFor(tier)) ==
+                                ConvertScalar(format, src, width, height);
+                    if (!same)
+                        std::fprintf(stderr, "tier %d, format %d, width %d\n", static_cast<int>(tier),
+                                     static_cast<int>(format), width);
+                    CHECK(same);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    ConvertsPackedFormats();
+    ConvertsLimitedRangeYuv();
+    SimdTiersMatchScalar();
+    return TestResult();
+}
@@ -0,0 +1,114 @@
+#include "texture_interface/pixel_scale.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "test_check.h"
+
+namespace
+{
+    std::vector<uint8_t> Scale(const std::vector<uint8_t> &src, int32_t width, int32_t height, int32_t dst_width,
+                               int32_t dst_height, const ScaleKernels &kernels = ActiveScaleKernels())
+    {
+        std::vector<uint8_t> dst(static_cast<size_t>(dst_width) * dst_height * 4);
+        ScaleRows(PixelFormat::kRGBA, src.data(), width * 4, width, height, dst.data(), dst_width, dst_height, 0,
+                  dst_height, ActiveConvertKernels(), kernels);
+        return dst;
+    }
+
+    void DownscaledSizeKeepsTheAspectRatio()
+    {
+        int32_t width = 0;
+        int32_t height = 0;
+        CHECK(DownscaledSize(1920, 1080, 960, 540, &width, &height) && width == 960 && height == 540);
+        // the axis that needs more pixels decides
+        CHECK(DownscaledSize(1920, 1080, 480, 540, &width, &height) && width == 960 && height == 540);
+        CHECK(!DownscaledSize(1920, 1080, 1920, 1080, &width, &height));
+        CHECK(!DownscaledSize(1920, 1080, 3840, 100, &width, &height));
+        CHECK(!DownscaledSize(1920, 1080, 0, 540, &width, &height));
+    }
+
+    void BoxesAverageWhatTheyCover()
+    {
+        // 4x2 to 2x1, every destination pixel covers a 2x2 box
+        std::vector<uint8_t> src = {
+            0, 10, 20, 255, 2, 12, 22, 255, 100, 0, 0, 0, 200, 0, 0, 0,
+            4, 14, 24, 255, 6, 16, 26, 255, 100, 0, 0, 0, 200, 0, 0, 4,
+        };
+        CHECK(Scale(src, 4, 2, 2, 1) == (std::vector<uint8_t>{3, 13, 23, 255, 150, 0, 0, 1}));
+    }
+
+    // Boxes of more rows than the 32 bit column sums take average every
+    // one of them, on every tier the CPU has.
+    void AveragesTallBoxes()
+    {
+        constexpr int32_t kWidth = 2;
+        constexpr int32_t kHeight = 200000;
+        std::vector<uint8_t> src(static_cast<size_t>(kWidth) * kHeight * 4);
+        for (int32_t y = 0; y < kHeight; y++)
+        {
+            // the first half black, the second white but for its alpha
+            uint8_t value = y < kHeight / 2 ? 0 : 255;
+            for (int32_t x = 0; x < kWidth; x++)
+            {
+                uint8_t *pixel = &src[(static_cast<size_t>(y) * kWidth + x) * 4];
+                pixel[0] = value;
+                pixel[1] = value;
+                pixel[2] = value;
+                pixel[3] = 255;
+            }
+        }
+        for (SimdTier tier : {SimdTier::kScalar, SimdTier::kSse2, SimdTier::kAvx2})
+        {
+            if (DetectSimdTier() < tier)
+            {
+                std::printf("skipping SIMD tier %d, not supported by this CPU\n", static_cast<int>(tier));
+                continue;
+            }
+            std::vector<uint8_t> dst = Scale(src, kWidth, kHeight, 1, 1, ScaleKernelsFor(tier));
+            bool averaged = dst == std::vector<uint8_t>{128, 128, 128, 255};
+            if (!averaged)
+                std::fprintf(stderr, "tier %d: %d %d %d %d\n", static_cast<int>(tier), dst[0], dst[1], dst[2],
+                             dst[3]);
+            CHECK(averaged);
+        }
+    }
+
+    // Every SIMD tier the CPU has scales exactly like the scalar kernels,
+    // with box and bilinear filtering.
+    void SimdTiersMatchScalar()
+    {
+        std::mt19937 random(13);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (SimdTier tier : {SimdTier::kSse2, SimdTier::kAvx2})
+        {
+            if (DetectSimdTier() < tier)
+                continue;
+            for (int32_t width = 2; width <= 70; width++)
+            {
+                int32_t height = 9;
+                std::vector<uint8_t> src(static_cast<size_t>(width) * height * 4);
+                for (uint8_t &value : src)
+                    value = static_cast<uint8_t>(byte(random));
+                for (int32_t dst_width : {width / 2, width - 1})
+                {
+                    bool same = Scale(src, width, height, dst_width, 4, ScaleKernelsFor(tier)) ==
+                                Scale(src, width, height, dst_width, 4, ScaleKernelsFor(SimdTier::kScalar));
+                    if (!same)
+                        std::fprintf(stderr, "tier %d, width %d to %d\n", static_cast<int>(tier), width, dst_width);
+                    CHECK(same);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    DownscaledSizeKeepsTheAspectRatio();
+    BoxesAverageWhatTheyCover();
+    AveragesTallBoxes();
+    SimdTiersMatchScalar();
+    return TestResult();
+}
@@ -0,0 +1,218 @@
+#include "texture_interface/shared_frame_ring.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/frame.h"
+#include "texture_interface/shared_memory.h"
+#include "test_check.h"
+
+namespace
+{
+    constexpr int32_t kWidth = 16;
+    constexpr int32_t kHeight = 8;
+
+    // heap memory standing in for a shared mapping, aligned for the header
+    struct RingMemory
+    {
+        explicit RingMemory(size_t size) : words((size + 7) / 8), size(size) {}
+
+        void *data() { return words.data(); }
+        SharedFrameRingHeader *header() { return static_cast<SharedFrameRingHeader *>(data()); }
+
+        std::vector<uint64_t> words;
+        size_t size;
+    };
+
+    uint32_t SlotIndex(RingMemory &memory, const uint8_t *slot)
+    {
+        const SharedFrameRingHeader *header = memory.header();
+        auto offset = static_cast<size_t>(slot - static_cast<const uint8_t *>(memory.data()));
+        return static_cast<uint32_t>((offset - header->data_offset) / header->slot_size);
+    }
+
+    // publishes a frame of |value| bytes, returns the slot it went to
+    uint32_t Publish(SharedFrameRing &ring, RingMemory &memory, uint8_t value)
+    {
+        uint8_t *slot = ring.BeginWrite();
+        std::memset(slot, value, static_cast<size_t>(kWidth) * kHeight * 4);
+        ring.EndWrite(kWidth, kHeight);
+        return SlotIndex(memory, slot);
+    }
+
+    void InitializeRejectsBadLayouts()
+    {
+        size_t size = SharedFrameRing::RequiredSize(3, kWidth, kHeight);
+        RingMemory memory(size);
+        CHECK(SharedFrameRing::Initialize(nullptr, size, 3, kWidth, kHeight) == nullptr);
+        // a free slot needs three of them
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, 2, kWidth, kHeight) == nullptr);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, SharedFrameRingHeader::kMaxSlots + 1, kWidth,
+                                          kHeight) == nullptr);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, 3, 0, kHeight) == nullptr);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, 3, kWidth, -1) == nullptr);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size - 1, 3, kWidth, kHeight) == nullptr);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, 3, kWidth, kHeight) != nullptr);
+    }
+
+    void AttachRejectsBadHeaders()
+    {
+        size_t size = SharedFrameRing::RequiredSize(4, kWidth, kHeight);
+        RingMemory memory(size);
+        CHECK(SharedFrameRing::Initialize(memory.data(), size, 4, kWidth, kHeight) != nullptr);
+        CHECK(SharedFrameRing::Attach(memory.data(), size) != nullptr);
+        CHECK(SharedFrameRing::Attach(nullptr, size) == nullptr);
+        CHECK(SharedFrameRing::Attach(memory.data(), sizeof(SharedFrameRingHeader) - 1) == nullptr);
+        // the slots have to fit the mapping
+        CHECK(SharedFrameRing::Attach(memory.data(), size - 1) == nullptr);
+
+        SharedFrameRingHeader *header = memory.header();
+        SharedFrameRingHeader valid;
+        std::memcpy(static_cast<void *>(&valid), header, sizeof(valid));
+        auto corrupted = [&](auto corrupt)
+        {
+            corrupt(*header);
+            bool rejected = SharedFrameRing::Attach(memory.data(), size) == nullptr;
+            std::memcpy(static_cast<void *>(header), &valid, sizeof(valid));
+            return rejected;
+        };
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.magic = 0; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.version = SharedFrameRingHeader::kVersion + 1; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.slot_count = 2; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.slot_count = SharedFrameRingHeader::kMaxSlots + 1; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.width = 0; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.slot_size = kWidth * kHeight * 4 - 1; }));
+        CHECK(corrupted([](SharedFrameRingHeader &h)
+                        { h.data_offset += 4096; }));
+        CHECK(SharedFrameRing::Attach(memory.data(), size) != nullptr);
+    }
+
+    // Whatever the consumer pins, the producer writes around it and around
+    // the newest frame.
+    void BeginWriteSkipsLatestAndPinnedSlots()
+    {
+        size_t size = SharedFrameRing::RequiredSize(3, kWidth, kHeight);
+        RingMemory memory(size);
+        std::unique_ptr<SharedFrameRing> producer =
+            SharedFrameRing::Initialize(memory.data(), size, 3, kWidth, kHeight);
+        std::unique_ptr<SharedFrameRing> consumer = SharedFrameRing::Attach(memory.data(), size);
+
+        uint32_t latest = Publish(*producer, memory, 0);
+        int32_t width, height;
+        for (int i = 1; i < 50; i++)
+        {
+            // pin every other frame, so the pin trails the newest one
+            if (i % 2 == 0)
+                consumer->AcquireLatest(&width, &height);
+            uint32_t pinned = memory.header()->reading.load();
+            uint8_t *slot = producer->BeginWrite();
+            CHECK(slot != nullptr);
+            uint32_t written = SlotIndex(memory, slot);
+            CHECK(written != latest);
+            CHECK(written != pinned);
+            producer->EndWrite(kWidth, kHeight);
+            latest = written;
+        }
+    }
+
+    void AcquireLatestPinsTheNewestFrame()
+    {
+        size_t size = SharedFrameRing::RequiredSize(3, kWidth, kHeight);
+        RingMemory memory(size);
+        std::unique_ptr<SharedFrameRing> producer =
+            SharedFrameRing::Initialize(memory.data(), size, 3, kWidth, kHeight);
+        std::unique_ptr<SharedFrameRing> consumer = SharedFrameRing::Attach(memory.data(), size);
+        int32_t width = 0;
+        int32_t height = 0;
+        CHECK(consumer->AcquireLatest(&width, &height) == nullptr);
+        CHECK(memory.header()->reading.load() == SharedFrameRingHeader::kNoSlot);
+
+        Publish(*producer, memory, 1);
+        uint32_t slot = Publish(*producer, memory, 2);
+        const uint8_t *pixels = consumer->AcquireLatest(&width, &height);
+        CHECK(pixels != nullptr && pixels[0] == 2);
+        CHECK(width == kWidth && height == kHeight);
+        CHECK(memory.header()->reading.load() == slot);
+        CHECK(consumer->latest_sequence() == 2);
+        consumer->Unpin();
+        CHECK(memory.header()->reading.load() == SharedFrameRingHeader::kNoSlot);
+
+        // a producer writing past its slot is not trusted
+        memory.header()->slots[slot].height = static_cast<int32_t>(memory.header()->slot_size / (kWidth * 4)) + 1;
+        CHECK(consumer->AcquireLatest(&width, &height) == nullptr);
+        CHECK(memory.header()->reading.load() == SharedFrameRingHeader::kNoSlot);
+    }
+
+    std::string UniqueName()
+    {
+#ifdef _WIN32
+        return "texture_interface_test_ring";
+#else
+        return "/texture_interface_test_ring_" + std::to_string(getpid());
+#endif
+    }
+
+    // Frames of a bound ring replace what the frame shows until it is
+    // unbound, then the last update is shown again.
+    void FrameShowsABoundRing()
+    {
+        std::string name = UniqueName();
+        size_t size = SharedFrameRing::RequiredSize(3, kWidth, kHeight);
+        std::unique_ptr<SharedMemory> memory = SharedMemory::Create(name, size);
+        CHECK(memory != nullptr);
+        if (memory == nullptr)
+            return;
+        std::unique_ptr<SharedFrameRing> producer =
+            SharedFrameRing::Initialize(memory->data(), size, 3, kWidth, kHeight);
+        uint8_t *slot = producer->BeginWrite();
+        std::memset(slot, 9, static_cast<size_t>(kWidth) * kHeight * 4);
+        producer->EndWrite(kWidth, kHeight);
+
+        FakeTextureBridge bridge;
+        Frame frame(&bridge);
+        std::vector<uint8_t> update(4 * 4 * 4, 3);
+        CHECK(frame.Update(update.data(), 4, 4, 0, PixelFormat::kRGBA, true, {[](void *, uint8_t *) {}, nullptr}));
+        CHECK(!frame.BindSharedRing(name + "_missing"));
+        CHECK(frame.shared_ring_width() == 0);
+
+        CHECK(frame.BindSharedRing(name));
+        CHECK(frame.shared_ring_width() == kWidth && frame.shared_ring_height() == kHeight);
+        const PixelBuffer *pixels = bridge.Fetch(frame.texture_id());
+        // through the frame's own mapping of the ring
+        CHECK(pixels != nullptr && pixels->buffer != slot && pixels->buffer[0] == 9 && pixels->width == kWidth &&
+              pixels->height == kHeight);
+
+        frame.UnbindSharedRing();
+        CHECK(frame.shared_ring_width() == 0);
+        pixels = bridge.Fetch(frame.texture_id());
+        CHECK(pixels != nullptr && pixels->buffer == update.data());
+        frame.Retire({});
+
+#ifndef _WIN32
+        shm_unlink(name.c_str());
+#endif
+    }
+}
+
+int main()
+{
+    InitializeRejectsBadLayouts();
+    AttachRejectsBadHeaders();
+    BeginWriteSkipsLatestAndPinnedSlots();
+    AcquireLatestPinsTheNewestFrame();
+    FrameShowsABoundRing();
+    return TestResult();
+}
@@ -0,0 +1,31 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// The core tests are plain executables run by ctest. A failed CHECK reports
+// where it failed and the test carries on, main returns TestResult().
+inline int &CheckFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                       \
+    do                                                                                         \
+    {                                                                                          \
+        if (!(condition))                                                                      \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            CheckFailures()++;                                                                 \
+        }                                                                                      \
+    } while (false)
+
+inline int TestResult()
+{
+    if (CheckFailures() != 0)
+        std::fprintf(stderr, "%d checks failed\n", CheckFailures());
+    return CheckFailures() != 0 ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "texture_interface/triple_buffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "fake_texture_bridge.h"
+#include "texture_interface/frame.h"
+#include "test_check.h"
+
+namespace
+{
+    constexpr auto kStressTime = std::chrono::milliseconds(500);
+
+    // large enough that a torn read would show up as differing words
+    struct Payload
+    {
+        std::array<uint64_t, 64> words;
+    };
+
+    int64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since)
+            .count();
+    }
+
+    void HandsOverTheNewestValue()
+    {
+        TripleBuffer<int> buffer;
+        CHECK(!buffer.HasPending());
+        CHECK(!buffer.Consume());
+
+        buffer.back() = 1;
+        CHECK(!buffer.Publish());
+        buffer.back() = 2;
+        // 1 was never consumed
+        CHECK(buffer.Publish());
+        CHECK(buffer.HasPending());
+        CHECK(buffer.Consume());
+        CHECK(buffer.front() == 2);
+        CHECK(!buffer.HasPending());
+        CHECK(!buffer.Consume());
+        CHECK(buffer.front() == 2);
+    }
+
+    // Producer and consumer threads hammering the buffer, the consumer must
+    // only ever see whole values and never go back to an older one.
+    void StressesProducerAndConsumer()
+    {
+        TripleBuffer<Payload> buffer;
+        std::atomic<bool> producing{true};
+        std::thread producer([&]
+                             {
+                                 for (uint64_t value = 1; producing.load(std::memory_order_relaxed); value++)
+                                 {
+                                     buffer.back().words.fill(value);
+                                     buffer.Publish();
+                                 }
+                             });
+
+        uint64_t last = 0;
+        uint64_t consumed = 0;
+        bool torn = false;
+        bool backwards = false;
+        auto started = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - started < kStressTime)
+        {
+            if (!buffer.Consume())
+                continue;
+            const Payload &payload = buffer.front();
+            torn |= std::any_of(payload.words.begin(), payload.words.end(),
+                                [&](uint64_t word)
+                                { return word != payload.words[0]; });
+            backwards |= payload.words[0] <= last;
+            last = payload.words[0];
+            consumed++;
+        }
+        producing.store(false);
+        producer.join();
+        CHECK(!torn);
+        CHECK(!backwards);
+        CHECK(consumed > 0);
+        std::printf("triple buffer: %llu values consumed, newest %llu\n",
+                    static_cast<unsigned long long>(consumed), static_cast<unsigned long long>(last));
+    }
+
+    // A producer updating a frame at full rate while the raster thread
+    // fetches it through the fake bridge. Reports the longest time either
+    // side spent in a call, neither waits for the other.
+    void StressesFrameHandoff()
+    {
+        constexpr int32_t kWidth = 640;
+        constexpr int32_t kHeight = 360;
+        FakeTextureBridge bridge;
+        WorkerPool workers;
+        Frame frame(&bridge, &workers);
+
+        std::vector<uint8_t> bgra(static_cast<size_t>(kWidth) * kHeight * 4);
+        std::atomic<bool> producing{true};
+        int64_t max_update = 0;
+        uint64_t updates = 0;
+        std::thread producer([&]
+                             {
+                                 for (uint8_t value = 0; producing.load(std::memory_order_relaxed); value++)
+                                 {
+                                     std::fill(bgra.begin(), bgra.end(), value);
+                                     auto started = std::chrono::steady_clock::now();
+                                     frame.Update(bgra.data(), kWidth, kHeight, 0, PixelFormat::kBGRA, true,
+                                                  {[](void *, uint8_t *) {}, nullptr});
+                                     max_update = std::max(max_update, ElapsedNanoseconds(started));
+                                     updates++;
+                                 }
+                             });
+
+        int64_t max_fetch = 0;
+        uint64_t fetches = 0;
+        bool torn = false;
+        auto started = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - started < kStressTime)
+        {
+            auto fetch_started = std::chrono::steady_clock::now();
+            const PixelBuffer *pixels = bridge.Fetch(frame.texture_id());
+            max_fetch = std::max(max_fetch, ElapsedNanoseconds(fetch_started));
+            fetches++;
+            if (pixels == nullptr)
+                continue;
+            size_t size = pixels->width * pixels->height * 4;
+            torn |= std::any_of(pixels->buffer, pixels->buffer + size,
+                                [&](uint8_t byte)
+                                { return byte != pixels->buffer[0]; });
+        }
+        producing.store(false);
+        producer.join();
+        frame.Retire({});
+        CHECK(!torn);
+        CHECK(updates > 0);
+        std::printf("frame handoff: %llu updates, %llu fetches, max update wait %lld us, max fetch wait %lld us\n",
+                    static_cast<unsigned long long>(updates), static_cast<unsigned long long>(fetches),
+                    static_cast<long long>(max_update / 1000), static_cast<long long>(max_fetch / 1000));
+    }
+}
+
+int main()
+{
+    HandsOverTheNewestValue();
+    StressesProducerAndConsumer();
+    StressesFrameHandoff();
+    return TestResult();
+}
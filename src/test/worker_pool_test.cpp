@@ -0,0 +1,80 @@
+#include "texture_interface/worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "test_check.h"
+
+namespace
+{
+    // runs a job over |rows| and checks every row ran exactly once
+    bool CoversEveryRowOnce(WorkerPool &pool, int32_t rows, size_t bytes)
+    {
+        std::vector<std::atomic<int>> runs(rows);
+        pool.ParallelFor(rows, bytes, [&](int32_t begin, int32_t end)
+                         {
+                             for (int32_t row = begin; row < end; row++)
+                                 runs[row]++;
+                         });
+        return std::all_of(runs.begin(), runs.end(), [](const std::atomic<int> &count)
+                           { return count.load() == 1; });
+    }
+
+    void SplitsJobsIntoDisjointBands()
+    {
+        for (size_t threads : {0, 1, 4})
+        {
+            WorkerPool pool(threads);
+            pool.Configure(threads, 0);
+            for (int32_t rows : {0, 1, 7, 1080, 2161})
+                CHECK(CoversEveryRowOnce(pool, rows, static_cast<size_t>(rows) * 4096));
+        }
+    }
+
+    void KeepsSmallJobsOnTheCallingThread()
+    {
+        WorkerPool pool(4);
+        pool.Configure(4, 1 << 20);
+        std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> inline_only{true};
+        pool.ParallelFor(1000, 1000, [&](int32_t, int32_t)
+                         {
+                             if (std::this_thread::get_id() != caller)
+                                 inline_only.store(false);
+                         });
+        CHECK(inline_only.load());
+    }
+
+    // frames of several producers share the pool
+    void RunsConcurrentCallers()
+    {
+        WorkerPool pool(4);
+        pool.Configure(4, 0);
+        std::atomic<int> failures{0};
+        std::vector<std::thread> callers;
+        for (int caller = 0; caller < 8; caller++)
+        {
+            callers.emplace_back([&]
+                                 {
+                                     for (int job = 0; job < 500; job++)
+                                     {
+                                         if (!CoversEveryRowOnce(pool, 300, 300 * 4096))
+                                             failures++;
+                                     }
+                                 });
+        }
+        for (std::thread &caller : callers)
+            caller.join();
+        CHECK(failures.load() == 0);
+    }
+}
+
+int main()
+{
+    SplitsJobsIntoDisjointBands();
+    KeepsSmallJobsOnTheCallingThread();
+    RunsConcurrentCallers();
+    return TestResult();
+}
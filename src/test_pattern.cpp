@@ -0,0 +1,145 @@
+#include "include/texture_interface/test_pattern.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr int32_t kTimestampBits = 64;
+
+    // 0xAARRGGBB to the bytes of an RGBA pixel
+    inline void StoreColor(uint8_t *pixel, uint32_t color)
+    {
+        pixel[0] = static_cast<uint8_t>(color >> 16);
+        pixel[1] = static_cast<uint8_t>(color >> 8);
+        pixel[2] = static_cast<uint8_t>(color);
+        pixel[3] = static_cast<uint8_t>(color >> 24);
+    }
+
+    // rows at the top of a kTimestamp frame holding the cells
+    inline int32_t TimestampBandRows(int32_t height)
+    {
+        return std::max(1, height / 8);
+    }
+
+    void FillRow(uint8_t *row, int32_t width, uint32_t color)
+    {
+        StoreColor(row, color);
+        for (int32_t x = 1; x < width; x++)
+            std::memcpy(row + static_cast<size_t>(x) * 4, row, 4);
+    }
+
+    void GradientRow(uint8_t *row, int32_t width, int32_t height, int32_t y, uint64_t index)
+    {
+        uint8_t green = static_cast<uint8_t>(height > 1 ? y * 255 / (height - 1) : 0);
+        for (int32_t x = 0; x < width; x++, row += 4)
+        {
+            int32_t ramp = width > 1 ? x * 255 / (width - 1) : 0;
+            row[0] = static_cast<uint8_t>(ramp + index);
+            row[1] = green;
+            row[2] = 128;
+            row[3] = 255;
+        }
+    }
+
+    void BarsRow(uint8_t *row, int32_t width, uint64_t index)
+    {
+        static const uint32_t kBars[8] = {0xFFFFFFFF, 0xFFFFFF00, 0xFF00FFFF, 0xFF00FF00,
+                                          0xFFFF00FF, 0xFFFF0000, 0xFF0000FF, 0xFF000000};
+        int32_t shift = static_cast<int32_t>((index * 4) % static_cast<uint64_t>(width));
+        for (int32_t x = 0; x < width; x++, row += 4)
+        {
+            int32_t position = x + shift;
+            if (position >= width)
+                position -= width;
+            StoreColor(row, kBars[static_cast<int64_t>(position) * 8 / width]);
+        }
+    }
+
+    void NoiseRow(uint8_t *row, int32_t width, int32_t y, uint64_t index)
+    {
+        // seeded per row so that bands render independently
+        uint64_t state = (index + 1) * 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(y) + 1) * 0xBF58476D1CE4E5B9ull;
+        for (int32_t x = 0; x < width; x++, row += 4)
+        {
+            // xorshift64
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            uint32_t bits = static_cast<uint32_t>(state);
+            row[0] = static_cast<uint8_t>(bits);
+            row[1] = static_cast<uint8_t>(bits >> 8);
+            row[2] = static_cast<uint8_t>(bits >> 16);
+            row[3] = 255;
+        }
+    }
+
+    void TimestampRow(uint8_t *row, int32_t width, int64_t timestamp)
+    {
+        // most significant bit first, white for ones
+        for (int32_t x = 0; x < width; x++, row += 4)
+        {
+            int32_t bit = static_cast<int32_t>(static_cast<int64_t>(x) * kTimestampBits / width);
+            uint8_t value = (static_cast<uint64_t>(timestamp) >> (kTimestampBits - 1 - bit)) & 1 ? 255 : 0;
+            row[0] = value;
+            row[1] = value;
+            row[2] = value;
+            row[3] = 255;
+        }
+    }
+} // namespace
+
+void RenderTestPatternRows(TestPattern pattern, uint32_t color, uint64_t index, int64_t timestamp,
+                           uint8_t *dst, int32_t width, int32_t height, int32_t row_begin, int32_t row_end)
+{
+    size_t row_bytes = static_cast<size_t>(width) * 4;
+    for (int32_t y = row_begin; y < row_end; y++)
+    {
+        uint8_t *row = dst + static_cast<size_t>(y) * row_bytes;
+        switch (pattern)
+        {
+        case TestPattern::kSolid:
+            // every row is the same, copy the first one of the range
+            if (y == row_begin)
+                FillRow(row, width, color);
+            else
+                std::memcpy(row, dst + static_cast<size_t>(row_begin) * row_bytes, row_bytes);
+            break;
+        case TestPattern::kGradient:
+            GradientRow(row, width, height, y, index);
+            break;
+        case TestPattern::kBars:
+            BarsRow(row, width, index);
+            break;
+        case TestPattern::kNoise:
+            NoiseRow(row, width, y, index);
+            break;
+        case TestPattern::kTimestamp:
+            if (width >= kTimestampBits && y < TimestampBandRows(height))
+                TimestampRow(row, width, timestamp);
+            else
+                GradientRow(row, width, height, y, index);
+            break;
+        }
+    }
+}
+
+bool ReadPatternTimestamp(const uint8_t *pixels, int32_t width, int32_t height, int32_t stride,
+                          int64_t *timestamp)
+{
+    if (pixels == nullptr || width < kTimestampBits || height <= 0)
+        return false;
+    if (stride == 0)
+        stride = width * 4;
+    // sample the center of every cell
+    const uint8_t *row = pixels + static_cast<size_t>(TimestampBandRows(height) / 2) * stride;
+    uint64_t value = 0;
+    for (int32_t bit = 0; bit < kTimestampBits; bit++)
+    {
+        int32_t x = static_cast<int32_t>((2 * static_cast<int64_t>(bit) + 1) * width / (2 * kTimestampBits));
+        const uint8_t *pixel = row + static_cast<size_t>(x) * 4;
+        value = value << 1 | (pixel[0] + pixel[1] + pixel[2] >= 3 * 128 ? 1 : 0);
+    }
+    *timestamp = static_cast<int64_t>(value);
+    return true;
+}
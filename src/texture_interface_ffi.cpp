@@ -0,0 +1,434 @@
+#include "include/texture_interface/texture_interface_ffi.h"
+
+#include "include/texture_interface/frame.h"
+#include "include/texture_interface/frame_delta.h"
+#include "include/texture_interface/frame_registry.h"
+#include "include/texture_interface/image_decoder.h"
+#include "include/texture_interface/release_queue.h"
+#include "include/texture_interface/test_pattern.h"
+
+#include <cstddef>
+#include <cstring>
+
+static_assert(TI_FORMAT_I420 == static_cast<int32_t>(PixelFormat::kI420),
+              "TI_FORMAT_* has to match PixelFormat");
+static_assert(TI_PACING_COALESCE == static_cast<int32_t>(PacingMode::kCoalesce),
+              "TI_PACING_* has to match PacingMode");
+static_assert(TI_DUPLICATES_SAMPLED == static_cast<int32_t>(DuplicateCheck::kSampled),
+              "TI_DUPLICATES_* has to match DuplicateCheck");
+static_assert(TI_PATTERN_TIMESTAMP == static_cast<int32_t>(TestPattern::kTimestamp),
+              "TI_PATTERN_* has to match TestPattern");
+static_assert(sizeof(ti_region) == sizeof(FrameRegion) &&
+                  offsetof(ti_region, src) == offsetof(FrameRegion, src) &&
+                  offsetof(ti_region, src_stride) == offsetof(FrameRegion, src_stride),
+              "ti_region has to match FrameRegion");
+static_assert(sizeof(ti_frame_stats) == sizeof(FrameStatsSnapshot) &&
+                  offsetof(ti_frame_stats, frames_skipped) ==
+                      offsetof(FrameStatsSnapshot, frames_skipped),
+              "ti_frame_stats has to match FrameStatsSnapshot");
+
+int32_t ti_update_frame(int64_t texture_handle, uint8_t *buffer, int32_t width,
+                        int32_t height, int32_t stride)
+{
+  return ti_update_frame_format(texture_handle, buffer, width, height, stride,
+                                TI_FORMAT_RGBA);
+}
+
+namespace
+{
+  int32_t ValidateUpdate(const uint8_t *buffer, int32_t width, int32_t height,
+                         int32_t stride, int32_t format)
+  {
+    if (buffer == nullptr || width <= 0 || height <= 0 ||
+        !IsValidPixelFormat(format))
+      return TI_ERROR_INVALID_ARGUMENT;
+    if (stride != 0 &&
+        stride < PackedStride(static_cast<PixelFormat>(format), width))
+      return TI_ERROR_INVALID_ARGUMENT;
+    return TI_OK;
+  }
+} // namespace
+
+int32_t ti_update_frame_format(int64_t texture_handle, uint8_t *buffer,
+                               int32_t width, int32_t height, int32_t stride,
+                               int32_t format)
+{
+  int32_t status = ValidateUpdate(buffer, width, height, stride, format);
+  if (status != TI_OK)
+    return status;
+
+  status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.Update(buffer, width, height, stride,
+                              static_cast<PixelFormat>(format))
+                     ? TI_OK
+                     : TI_ERROR_OUT_OF_MEMORY;
+      });
+  return status;
+}
+
+int32_t ti_update_frame_external(int64_t texture_handle, uint8_t *buffer,
+                                 int32_t width, int32_t height, int32_t stride,
+                                 int32_t format, ti_release_callback release,
+                                 void *context)
+{
+  if (release == nullptr)
+    return TI_ERROR_INVALID_ARGUMENT;
+  int32_t status = ValidateUpdate(buffer, width, height, stride, format);
+  if (status != TI_OK)
+    return status;
+
+  status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.Update(buffer, width, height, stride,
+                              static_cast<PixelFormat>(format), true,
+                              BufferRelease{release, context})
+                     ? TI_OK
+                     : TI_ERROR_OUT_OF_MEMORY;
+      });
+  return status;
+}
+
+int64_t ti_create_release_queue()
+{
+  return ReleaseQueue::Create();
+}
+
+void ti_destroy_release_queue(int64_t queue)
+{
+  ReleaseQueue::Destroy(queue);
+}
+
+int32_t ti_update_frame_queued(int64_t texture_handle, uint8_t *buffer,
+                               int32_t width, int32_t height, int32_t stride,
+                               int32_t format, int64_t queue)
+{
+  return ti_update_frame_external(texture_handle, buffer, width, height,
+                                  stride, format, &ReleaseQueue::OnRelease,
+                                  ReleaseQueue::Context(queue));
+}
+
+int32_t ti_poll_released(int64_t queue, uint8_t **buffers, int32_t capacity)
+{
+  if (buffers == nullptr || capacity < 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+  int32_t count = ReleaseQueue::Poll(queue, buffers, capacity);
+  return count >= 0 ? count : TI_ERROR_NOT_FOUND;
+}
+
+int32_t ti_update_frames(const ti_frame_update *updates, int32_t count,
+                         int32_t *statuses)
+{
+  if (updates == nullptr || count < 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t result = TI_OK;
+  FrameRegistry::Instance().WithAll(
+      [&](auto find)
+      {
+        for (int32_t i = 0; i < count; i++)
+        {
+          const ti_frame_update &update = updates[i];
+          int32_t status = ValidateUpdate(update.buffer, update.width,
+                                          update.height, update.stride,
+                                          update.format);
+          if (status == TI_OK)
+          {
+            Frame *frame = find(update.texture_handle);
+            if (frame == nullptr)
+              status = TI_ERROR_NOT_FOUND;
+            else if (!frame->Update(update.buffer, update.width,
+                                    update.height, update.stride,
+                                    static_cast<PixelFormat>(update.format),
+                                    false))
+              status = TI_ERROR_OUT_OF_MEMORY;
+          }
+          if (statuses != nullptr)
+            statuses[i] = status;
+          if (result == TI_OK)
+            result = status;
+        }
+        // textures that appear several times are only notified once
+        for (int32_t i = 0; i < count; i++)
+        {
+          if (Frame *frame = find(updates[i].texture_handle))
+            frame->FlushFrameAvailable();
+        }
+      });
+  return result;
+}
+
+int32_t ti_update_frame_encoded(int64_t texture_handle, const uint8_t *data,
+                                int64_t size, int32_t *width, int32_t *height)
+{
+  if (data == nullptr || size <= 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+  ImageInfo info;
+  if (!ReadImageInfo(data, static_cast<size_t>(size), &info))
+    return TI_ERROR_UNSUPPORTED;
+  if (width != nullptr)
+    *width = info.width;
+  if (height != nullptr)
+    *height = info.height;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.UpdateEncoded(data, static_cast<size_t>(size), info)
+                     ? TI_OK
+                     : TI_ERROR_CORRUPT;
+      });
+  return status;
+}
+
+uint8_t *ti_acquire_buffer(int64_t texture_handle, int32_t width,
+                           int32_t height)
+{
+  uint8_t *buffer = nullptr;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      { buffer = frame.AcquireBuffer(width, height); });
+  return buffer;
+}
+
+int32_t ti_submit_buffer(int64_t texture_handle, uint8_t *buffer,
+                         int32_t width, int32_t height)
+{
+  if (width <= 0 || height <= 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        size_t capacity = frame.pool().LentCapacity(buffer);
+        if (capacity == 0)
+          status = TI_ERROR_FOREIGN_BUFFER;
+        else if (capacity < static_cast<size_t>(width) * height * 4)
+          status = TI_ERROR_INVALID_ARGUMENT;
+        else
+          status = frame.SubmitBuffer(buffer, width, height)
+                       ? TI_OK
+                       : TI_ERROR_FOREIGN_BUFFER;
+      });
+  return status;
+}
+
+int32_t ti_release_buffer(int64_t texture_handle, uint8_t *buffer)
+{
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.ReleaseBuffer(buffer) ? TI_OK
+                                             : TI_ERROR_FOREIGN_BUFFER;
+      });
+  return status;
+}
+
+int32_t ti_update_region(int64_t texture_handle, int32_t x, int32_t y,
+                         int32_t width, int32_t height, const uint8_t *src,
+                         int32_t src_stride)
+{
+  ti_region region{x, y, width, height, src, src_stride};
+  return ti_update_regions(texture_handle, &region, 1);
+}
+
+int32_t ti_update_regions(int64_t texture_handle, const ti_region *regions,
+                          int32_t count)
+{
+  if (regions == nullptr || count < 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.UpdateRegions(
+                     reinterpret_cast<const FrameRegion *>(regions), count)
+                     ? TI_OK
+                     : TI_ERROR_NO_FRAME;
+      });
+  return status;
+}
+
+int64_t ti_max_frame_delta_size(int32_t width, int32_t height)
+{
+  if (width <= 0 || height <= 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+  return static_cast<int64_t>(MaxFrameDeltaSize(width, height));
+}
+
+int32_t ti_encode_frame_delta(const uint8_t *previous, const uint8_t *current,
+                              int32_t width, int32_t height, int32_t stride,
+                              uint8_t *out, int64_t capacity, int64_t *size)
+{
+  if (previous == nullptr || current == nullptr || out == nullptr ||
+      size == nullptr || width <= 0 || height <= 0 || stride < 0 ||
+      (stride != 0 && stride < width * 4))
+    return TI_ERROR_INVALID_ARGUMENT;
+  if (capacity < 0 ||
+      static_cast<uint64_t>(capacity) < MaxFrameDeltaSize(width, height))
+    return TI_ERROR_OUT_OF_MEMORY;
+  *size = static_cast<int64_t>(
+      EncodeFrameDelta(previous, current, width, height, stride, out));
+  return TI_OK;
+}
+
+int32_t ti_update_frame_delta(int64_t texture_handle, const uint8_t *data,
+                              int64_t size)
+{
+  if (data == nullptr || size <= 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+  FrameDeltaInfo info;
+  if (!ReadFrameDeltaInfo(data, static_cast<size_t>(size), &info))
+    return TI_ERROR_CORRUPT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        status = frame.UpdateDelta(data, static_cast<size_t>(size), info)
+                     ? TI_OK
+                     : TI_ERROR_NO_FRAME;
+      });
+  return status;
+}
+
+int32_t ti_set_pacing_mode(int64_t texture_handle, int32_t mode)
+{
+  if (mode != TI_PACING_IMMEDIATE && mode != TI_PACING_COALESCE)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        frame.set_pacing_mode(static_cast<PacingMode>(mode));
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_set_duplicate_check(int64_t texture_handle, int32_t check)
+{
+  if (check < TI_DUPLICATES_OFF || check > TI_DUPLICATES_SAMPLED)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        frame.set_duplicate_check(static_cast<DuplicateCheck>(check));
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_set_display_size(int64_t texture_handle, int32_t width,
+                            int32_t height)
+{
+  if (width < 0 || height < 0)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        frame.set_display_size(width, height);
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_ready_for_frame(int64_t texture_handle)
+{
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      { status = frame.ReadyForFrame() ? 1 : 0; });
+  return status;
+}
+
+int32_t ti_dropped_frames(int64_t texture_handle, uint64_t *dropped)
+{
+  if (dropped == nullptr)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        *dropped = frame.dropped_frames();
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_skipped_frames(int64_t texture_handle, uint64_t *skipped)
+{
+  if (skipped == nullptr)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        *skipped = frame.skipped_frames();
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_resident_bytes(int64_t texture_handle, uint64_t *bytes)
+{
+  if (bytes == nullptr)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        *bytes = frame.resident_bytes();
+        status = TI_OK;
+      });
+  return status;
+}
+
+int32_t ti_get_stats(int64_t texture_handle, ti_frame_stats *stats,
+                     int32_t reset)
+{
+  if (stats == nullptr)
+    return TI_ERROR_INVALID_ARGUMENT;
+
+  int32_t status = TI_ERROR_NOT_FOUND;
+  FrameRegistry::Instance().With(
+      texture_handle, [&](Frame &frame)
+      {
+        FrameStatsSnapshot snapshot = frame.Stats(reset != 0);
+        std::memcpy(stats, &snapshot, sizeof(snapshot));
+        status = TI_OK;
+      });
+  return status;
+}
+
+int64_t ti_clock_now()
+{
+  return FrameStats::Now();
+}
+
+int32_t ti_read_pattern_timestamp(const uint8_t *pixels, int32_t width,
+                                  int32_t height, int32_t stride,
+                                  int64_t *timestamp)
+{
+  if (timestamp == nullptr || stride < 0 || (stride != 0 && stride < width * 4))
+    return TI_ERROR_INVALID_ARGUMENT;
+  return ReadPatternTimestamp(pixels, width, height, stride, timestamp)
+             ? TI_OK
+             : TI_ERROR_INVALID_ARGUMENT;
+}
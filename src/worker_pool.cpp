@@ -0,0 +1,145 @@
+#include "include/texture_interface/worker_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // bands smaller than this cost more in synchronization than they save
+    constexpr int32_t kMinBandRows = 16;
+}
+
+WorkerPool::WorkerPool(size_t thread_count)
+{
+    Start(thread_count);
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+// static
+size_t WorkerPool::DefaultThreadCount()
+{
+    // leave room for the platform and raster threads
+    size_t cores = std::thread::hardware_concurrency();
+    return std::min<size_t>(cores > 2 ? cores - 2 : 0, 8);
+}
+
+void WorkerPool::Configure(size_t thread_count, size_t parallel_threshold)
+{
+    const std::unique_lock<std::shared_mutex> lock(configure_mutex_);
+    parallel_threshold_.store(parallel_threshold);
+    if (thread_count == threads_.size())
+        return;
+    Stop();
+    Start(thread_count);
+}
+
+size_t WorkerPool::thread_count() const
+{
+    const std::shared_lock<std::shared_mutex> lock(configure_mutex_);
+    return threads_.size();
+}
+
+void WorkerPool::Run(int32_t rows, size_t bytes, BandFunction function, void *context)
+{
+    const std::shared_lock<std::shared_mutex> configure_lock(configure_mutex_);
+
+    int32_t max_bands = static_cast<int32_t>(threads_.size()) + 1;
+    if (rows <= 0 || max_bands == 1 || bytes < parallel_threshold_.load() || rows < 2 * kMinBandRows)
+    {
+        if (rows > 0)
+            function(context, 0, rows);
+        return;
+    }
+
+    Job job;
+    job.function = function;
+    job.context = context;
+    job.rows = rows;
+    job.bands = std::min(max_bands, rows / kMinBandRows);
+    job.band_rows = (rows + job.bands - 1) / job.bands;
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        job.wanted_helpers = job.bands - 1;
+        job.next = queue_;
+        queue_ = &job;
+    }
+    work_available_.notify_all();
+
+    WorkOn(job);
+
+    // helpers that did not pick the job up yet never will, then wait for
+    // the ones that did before |job| goes out of scope
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (Job **link = &queue_; *link != nullptr; link = &(*link)->next)
+    {
+        if (*link == &job)
+        {
+            *link = job.next;
+            break;
+        }
+    }
+    helper_done_.wait(lock, [&job]
+                      { return job.active_helpers == 0; });
+}
+
+// static
+void WorkerPool::WorkOn(Job &job)
+{
+    for (;;)
+    {
+        int32_t band = job.next_band.fetch_add(1);
+        if (band >= job.bands)
+            return;
+        int32_t begin = band * job.band_rows;
+        int32_t end = std::min(begin + job.band_rows, job.rows);
+        if (begin < end)
+            job.function(job.context, begin, end);
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        work_available_.wait(lock, [this]
+                             { return stopping_ || queue_ != nullptr; });
+        if (stopping_)
+            return;
+
+        Job *job = queue_;
+        if (--job->wanted_helpers == 0)
+            queue_ = job->next;
+        job->active_helpers++;
+        lock.unlock();
+
+        WorkOn(*job);
+
+        lock.lock();
+        job->active_helpers--;
+        helper_done_.notify_all();
+    }
+}
+
+void WorkerPool::Start(size_t thread_count)
+{
+    stopping_ = false;
+    for (size_t i = 0; i < thread_count; i++)
+        threads_.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+void WorkerPool::Stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (std::thread &thread : threads_)
+        thread.join();
+    threads_.clear();
+}
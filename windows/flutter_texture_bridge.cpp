@@ -0,0 +1,71 @@
+#include "include/texture_interface/flutter_texture_bridge.h"
+
+#include <windows.h>
+
+#include <cstddef>
+
+static_assert(sizeof(PixelBuffer) == sizeof(FlutterDesktopPixelBuffer) &&
+                  offsetof(PixelBuffer, height) == offsetof(FlutterDesktopPixelBuffer, height) &&
+                  offsetof(PixelBuffer, release_context) == offsetof(FlutterDesktopPixelBuffer, release_context),
+              "PixelBuffer has to match FlutterDesktopPixelBuffer");
+
+FlutterTextureBridge::FlutterTextureBridge(flutter::TextureRegistrar *texture_registrar)
+    : texture_registrar_(texture_registrar) {}
+
+FlutterTextureBridge::~FlutterTextureBridge()
+{
+    const std::lock_guard<std::mutex> lock(lifetime_->mutex);
+    lifetime_->closed = true;
+}
+
+int64_t FlutterTextureBridge::RegisterTexture(FetchCallback fetch)
+{
+    auto texture = std::make_unique<flutter::TextureVariant>(
+        flutter::PixelBufferTexture(
+            [fetch = std::move(fetch)](size_t width, size_t height) -> const FlutterDesktopPixelBuffer *
+            {
+                return reinterpret_cast<const FlutterDesktopPixelBuffer *>(fetch(width, height));
+            }));
+
+    int64_t texture_id = texture_registrar_->RegisterTexture(texture.get());
+    const std::lock_guard<std::mutex> lock(mutex_);
+    textures_[texture_id] = std::move(texture);
+    return texture_id;
+}
+
+void FlutterTextureBridge::UnregisterTexture(int64_t texture_id, std::function<void()> unregistered)
+{
+    flutter::TextureVariant *texture = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(texture_id);
+        if (it == textures_.end())
+        {
+            if (unregistered)
+                unregistered();
+            return;
+        }
+        texture = it->second.release();
+        textures_.erase(it);
+    }
+    // the engine calls back once the raster thread dropped the texture,
+    // which may still be fetching until then, and possibly after the bridge
+    // is gone
+    texture_registrar_->UnregisterTexture(texture_id, [texture, lifetime = lifetime_,
+                                                       unregistered = std::move(unregistered)]()
+                                          {
+                                              delete texture;
+                                              const std::lock_guard<std::mutex> lock(lifetime->mutex);
+                                              if (!lifetime->closed && unregistered)
+                                                  unregistered(); });
+}
+
+void FlutterTextureBridge::MarkTextureFrameAvailable(int64_t texture_id)
+{
+    texture_registrar_->MarkTextureFrameAvailable(texture_id);
+}
+
+void FlutterTextureBridge::FreeBuffer(uint8_t *buffer)
+{
+    CoTaskMemFree(buffer);
+}
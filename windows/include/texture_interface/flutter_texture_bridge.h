@@ -0,0 +1,41 @@
+#ifndef FLUTTER_TEXTURE_BRIDGE_H
+#define FLUTTER_TEXTURE_BRIDGE_H
+
+#include <flutter/plugin_registrar_windows.h>
+#include <flutter/texture_registrar.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <texture_interface/texture_bridge.h>
+
+// TextureBridge over the Windows embedder's texture registrar. Buffers
+// handed over by Dart were allocated with CoTaskMemAlloc by package:ffi.
+class FlutterTextureBridge : public TextureBridge
+{
+public:
+    explicit FlutterTextureBridge(flutter::TextureRegistrar *texture_registrar);
+    ~FlutterTextureBridge();
+
+    int64_t RegisterTexture(FetchCallback fetch) override;
+    void UnregisterTexture(int64_t texture_id, std::function<void()> unregistered) override;
+    void MarkTextureFrameAvailable(int64_t texture_id) override;
+    void FreeBuffer(uint8_t *buffer) override;
+
+private:
+    // unregister callbacks can come after the bridge is gone, they are
+    // dropped then
+    struct Lifetime
+    {
+        std::mutex mutex;
+        bool closed = false;
+    };
+
+    flutter::TextureRegistrar *texture_registrar_;
+    std::mutex mutex_;
+    std::unordered_map<int64_t, std::unique_ptr<flutter::TextureVariant>> textures_;
+    std::shared_ptr<Lifetime> lifetime_ = std::make_shared<Lifetime>();
+};
+
+#endif
@@ -14,8 +14,12 @@
 #include <memory>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
-#include "include/texture_interface/frame.h"
+#include <texture_interface/frame_host.h>
+#include <texture_interface/page_allocator.h>
+
+#include "include/texture_interface/flutter_texture_bridge.h"
 
 namespace
 {
@@ -41,9 +45,10 @@ namespace
         const flutter::MethodCall<flutter::EncodableValue> &method_call,
         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
-    flutter::TextureRegistrar *texture_registrar_;
     std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
-    std::unordered_map<int, std::unique_ptr<Frame>> frames_;
+    FlutterTextureBridge bridge_;
+    // declared after bridge_, its frames unregister their textures
+    FrameHost host_;
   };
 
   // static
@@ -68,7 +73,7 @@ namespace
   Texture_interfacePlugin::Texture_interfacePlugin(
       std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel,
       flutter::TextureRegistrar *texture_registrar)
-      : channel_(std::move(channel)), texture_registrar_(texture_registrar) {}
+      : channel_(std::move(channel)), bridge_(texture_registrar), host_(&bridge_) {}
 
   Texture_interfacePlugin::~Texture_interfacePlugin() {}
 
@@ -76,6 +81,9 @@ namespace
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result)
   {
+    // frames retired by earlier calls are destroyed on the platform thread
+    host_.Collect();
+
 
     if (method_call.method_name().compare("getPlatformVersion") == 0)
     {
@@ -101,54 +109,229 @@ namespace
       flutter::EncodableMap arguments =
           std::get<flutter::EncodableMap>(*method_call.arguments());
       auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
-      auto [it, added] = frames_.try_emplace(id, nullptr);
+      Frame *frame = host_.Register(id);
+
+      // frames are updated through the native entry points in
+      // texture_interface_ffi.h, the handle addresses them there
+      return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("textureId"), flutter::EncodableValue(frame->texture_id())},
+          {flutter::EncodableValue("handle"), flutter::EncodableValue(host_.Handle(id))},
+      }));
+    }
+    else if (method_call.method_name().compare("BindSharedRing") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
+      auto name = std::get<std::string>(arguments[flutter::EncodableValue("name")]);
 
-      if (added)
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
       {
-        it->second = std::make_unique<Frame>(texture_registrar_);
-
-        /*
-        it->second->SetReleaseCallback(
-            [](void *user_data)
-            {
-              user_release_context *context = (user_release_context *)user_data;
-              int64_t ptra = reinterpret_cast<int64_t>(context->buffer);
-              context->channel->InvokeMethod("FreeBuffer", std::make_unique<flutter::EncodableValue>(ptra));
-              delete context;
-            });*/
+        return result->Error("-2", "Texture was not found.");
+      }
+      if (!frame->BindSharedRing(name))
+      {
+        return result->Error("-6", "Shared frame ring could not be opened.");
       }
-      return result->Success(flutter::EncodableValue(it->second->texture_id()));
+      return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("width"), flutter::EncodableValue(frame->shared_ring_width())},
+          {flutter::EncodableValue("height"), flutter::EncodableValue(frame->shared_ring_height())},
+      }));
     }
-    else if (method_call.method_name().compare("UpdateFrame") == 0)
+    else if (method_call.method_name().compare("UnbindSharedRing") == 0)
     {
       flutter::EncodableMap arguments =
           std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
 
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      frame->UnbindSharedRing();
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("GetStats") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
       auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
+      auto reset = std::get<bool>(arguments[flutter::EncodableValue("reset")]);
+
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      FrameStatsSnapshot stats = frame->Stats(reset);
+      return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("framesSubmitted"), flutter::EncodableValue(static_cast<int64_t>(stats.frames_submitted))},
+          {flutter::EncodableValue("framesDisplayed"), flutter::EncodableValue(static_cast<int64_t>(stats.frames_displayed))},
+          {flutter::EncodableValue("framesDropped"), flutter::EncodableValue(static_cast<int64_t>(stats.frames_dropped))},
+          {flutter::EncodableValue("framesSkipped"), flutter::EncodableValue(static_cast<int64_t>(stats.frames_skipped))},
+          {flutter::EncodableValue("bytesSubmitted"), flutter::EncodableValue(static_cast<int64_t>(stats.bytes_submitted))},
+          {flutter::EncodableValue("intervalSeconds"), flutter::EncodableValue(stats.interval_seconds)},
+          {flutter::EncodableValue("fps"), flutter::EncodableValue(stats.fps)},
+          {flutter::EncodableValue("bytesPerSecond"), flutter::EncodableValue(stats.bytes_per_second)},
+          {flutter::EncodableValue("takeP50Us"), flutter::EncodableValue(stats.take_p50_us)},
+          {flutter::EncodableValue("takeP99Us"), flutter::EncodableValue(stats.take_p99_us)},
+          {flutter::EncodableValue("queueP50Us"), flutter::EncodableValue(stats.queue_p50_us)},
+          {flutter::EncodableValue("queueP99Us"), flutter::EncodableValue(stats.queue_p99_us)},
+          {flutter::EncodableValue("uploadP50Us"), flutter::EncodableValue(stats.upload_p50_us)},
+          {flutter::EncodableValue("uploadP99Us"), flutter::EncodableValue(stats.upload_p99_us)},
+          {flutter::EncodableValue("totalP50Us"), flutter::EncodableValue(stats.total_p50_us)},
+          {flutter::EncodableValue("totalP99Us"), flutter::EncodableValue(stats.total_p99_us)},
+      }));
+    }
+    else if (method_call.method_name().compare("ConfigureWorkers") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto threads = arguments[flutter::EncodableValue("threads")].LongValue();
+      auto threshold = arguments[flutter::EncodableValue("parallelThreshold")].LongValue();
 
-      int32_t width = std::get<int32_t>(arguments[flutter::EncodableValue("width")]);
-      int32_t height = std::get<int32_t>(arguments[flutter::EncodableValue("height")]);
+      if (threads < 0 || threads > 64 || threshold < 0)
+      {
+        return result->Error("-1", "Invalid worker configuration.");
+      }
+      host_.workers().Configure(static_cast<size_t>(threads), static_cast<size_t>(threshold));
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("SetMemoryBudget") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto bytes = arguments[flutter::EncodableValue("bytes")].LongValue();
+      auto idle_ms = arguments[flutter::EncodableValue("idleMs")].LongValue();
 
-      int64_t bufferptra = std::get<int64_t>(arguments[flutter::EncodableValue("buffer")]);
-      // std::vector<uint8_t> buffer = std::get<std::vector<uint8_t>>(arguments[flutter::EncodableValue("buffer")]);
+      if (bytes < 0 || idle_ms < 0)
+      {
+        return result->Error("-1", "Invalid memory budget.");
+      }
+      host_.budget().Configure(static_cast<size_t>(bytes), idle_ms * 1000000);
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("ConfigureAllocator") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      PagePolicy policy;
+      policy.huge_pages = std::get<bool>(arguments[flutter::EncodableValue("hugePages")]);
+      policy.numa_local = std::get<bool>(arguments[flutter::EncodableValue("numaLocal")]);
+      // process wide, buffers allocated before keep their pages
+      SetPagePolicy(policy);
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("GetResidentBytes") == 0)
+    {
+      return result->Success(flutter::EncodableValue(static_cast<int64_t>(host_.budget().ResidentBytes())));
+    }
+    else if (method_call.method_name().compare("StartTestPattern") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
+      PatternConfig config = {
+          static_cast<TestPattern>(std::get<int>(arguments[flutter::EncodableValue("pattern")])),
+          std::get<int>(arguments[flutter::EncodableValue("width")]),
+          std::get<int>(arguments[flutter::EncodableValue("height")]),
+          std::get<double>(arguments[flutter::EncodableValue("fps")]),
+          static_cast<uint32_t>(arguments[flutter::EncodableValue("color")].LongValue()),
+      };
+
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      if (!host_.patterns().Start(frame, config))
+      {
+        return result->Error("-1", "Invalid test pattern.");
+      }
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("StopTestPattern") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
 
-      uint8_t *bufferptr = reinterpret_cast<uint8_t *>(bufferptra);
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      host_.patterns().Stop(frame);
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("StartRecording") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
+      auto path = std::get<std::string>(arguments[flutter::EncodableValue("path")]);
 
-      auto frame = frames_.find(id);
-      if (frame == frames_.end())
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
       {
         return result->Error("-2", "Texture was not found.");
       }
-      /*
-      user_release_context *urc = new user_release_context;
-      urc->channel = channel_.get();
-      urc->buffer = bufferptr;
+      if (!frame->StartRecording(path))
+      {
+        return result->Error("-1", "Capture file could not be created.");
+      }
+      return result->Success();
+    }
+    else if (method_call.method_name().compare("StopRecording") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
 
-      frame->second->SetReleaseContext(urc);*/
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      return result->Success(flutter::EncodableValue(static_cast<int64_t>(frame->StopRecording())));
+    }
+    else if (method_call.method_name().compare("StartReplay") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
+      auto path = std::get<std::string>(arguments[flutter::EncodableValue("path")]);
+      auto speed = std::get<double>(arguments[flutter::EncodableValue("speed")]);
+      auto loop = std::get<bool>(arguments[flutter::EncodableValue("loop")]);
 
-      
-      frame->second->Update(bufferptr, width, height);
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      if (!frame->StartReplay(path, speed, loop))
+      {
+        return result->Error("-1", "Capture file could not be read.");
+      }
+      return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("width"), flutter::EncodableValue(frame->replay_width())},
+          {flutter::EncodableValue("height"), flutter::EncodableValue(frame->replay_height())},
+      }));
+    }
+    else if (method_call.method_name().compare("StopReplay") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      auto id = std::get<int>(arguments[flutter::EncodableValue("id")]);
 
+      Frame *frame = host_.Find(id);
+      if (frame == nullptr)
+      {
+        return result->Error("-2", "Texture was not found.");
+      }
+      frame->StopReplay();
       return result->Success();
     }
     else if (method_call.method_name().compare("UnregisterTexture") == 0)
@@ -158,14 +341,33 @@ namespace
       auto id =
           std::get<int>(arguments[flutter::EncodableValue("id")]);
 
-      if (frames_.find(id) == frames_.end())
+      // auto player = g_players->Get(player_id);
+      // player->SetVideoFrameCallback(nullptr);
+      if (!host_.Unregister(id))
       {
         return result->Error("-2", "Texture was not found.");
       }
-      // auto player = g_players->Get(player_id);
-      // player->SetVideoFrameCallback(nullptr);
-      frames_.erase(id);
-      result->Success(flutter::EncodableValue(nullptr));
+      result->Success(flutter::EncodableValue(static_cast<int>(host_.retired_count())));
+    }
+    else if (method_call.method_name().compare("UnregisterAll") == 0)
+    {
+      flutter::EncodableMap arguments =
+          std::get<flutter::EncodableMap>(*method_call.arguments());
+      const auto &list =
+          std::get<flutter::EncodableList>(arguments[flutter::EncodableValue("ids")]);
+
+      std::vector<int> ids;
+      ids.reserve(list.size());
+      for (const auto &id : list)
+      {
+        ids.push_back(std::get<int>(id));
+      }
+      host_.UnregisterAll(ids);
+      return result->Success(flutter::EncodableValue(static_cast<int>(host_.retired_count())));
+    }
+    else if (method_call.method_name().compare("CollectRetired") == 0)
+    {
+      return result->Success(flutter::EncodableValue(static_cast<int>(host_.retired_count())));
     }
 
     else